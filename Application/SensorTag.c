@@ -88,6 +88,8 @@
 #include "SensorTag_Opt.h"
 #include "SensorTag_Keys.h"
 #include "SensorTag_IO.h"
+#include "SensorTag_Sched.h"
+#include "SensorTag_Cal.h"
 
 // Other devices
 #include "ext_flash.h"
@@ -500,6 +502,9 @@ static void SensorTag_init(void)
   GATTServApp_AddService(GATT_ALL_SERVICES);   // GATT attributes
   DevInfo_AddService();                        // Device Information Service
 
+  // Register for GATT local events (MTU updates)
+  GATT_RegisterForMsgs(selfEntity);
+
   // Add application specific device information
   SensorTag_setDeviceInfo();
 
@@ -524,13 +529,18 @@ static void SensorTag_init(void)
   }
 #endif
 
-  // Initialize sensors who don't have their own tasks
+  // Initialize sensors, all run in the application task
+  SensorTagSched_init();                          // Sensor scheduler
+  SensorTagTmp_init();                            // IR thermometer
+  SensorTagHum_init();                            // Humidity
+  SensorTagBar_init();                            // Barometer
   SensorTagMov_init();                            // Movement processor
   SensorTagOpt_init();                            // Light meter
 
   // Auxiliary services
   SensorTagKeys_init();                           // Simple Keys
   SensorTagIO_init();                             // IO (LED+buzzer+self test)
+  SensorTagCal_init();                            // Sensor calibration
 
 #ifdef FEATURE_REGISTER_SERVICE
   Register_addService();                          // Generic register access
@@ -627,6 +637,8 @@ static void SensorTag_taskFxn(UArg a0, UArg a1)
 
       // Process new data if available
       SensorTagKeys_processEvent();
+      SensorTagSched_processEvent();
+      SensorTagIO_processSamplingEvent();
       SensorTagOpt_processSensorEvent();
       SensorTagMov_processSensorEvent();
     }
@@ -968,6 +980,10 @@ static void SensorTag_processCharValueChangeEvt(uint8_t serviceID,
     SensorTagIO_processCharChangeEvt(paramID);
     break;
 
+  case SERVICE_ID_CAL:
+    SensorTagCal_processCharChangeEvt(paramID);
+    break;
+
 #ifdef FEATURE_OAD
   case SERVICE_ID_CC:
     SensorTagConnControl_processCharChangeEvt(paramID);
@@ -1017,6 +1033,12 @@ static void SensorTag_processStackMsg(ICall_Hdr *pMsg)
  */
 static void SensorTag_processGATTMsg(gattMsgEvent_t *pMsg)
 {
+  if (pMsg->method == ATT_MTU_UPDATED_EVENT)
+  {
+    // Batched movement notifications are limited by the MTU
+    SensorTagMov_setMtu(pMsg->msg.mtuEvt.MTU);
+  }
+
   GATT_bm_free(&pMsg->msg, pMsg->method);
 }
 
@@ -1221,10 +1243,11 @@ static int16_t uint8ToInt16(uint8_t LB, uint8_t  HB)
 
 void MysensorTag_updateAdvertisingData(void)
 {
- /* MOVEMENT SENSOR DATA FORMAT (18 BYTES)
+ /* MOVEMENT SENSOR DATA FORMAT (21 BYTES)
   * data[0:1]   : gyroX  data[2:3]   : gyroY  data[4:5]   : gyroZ
   * data[6:7]   : accX   data[8:9]   : accY   data[10:11] : accZ
   * data[12:13] : magX   data[14:15] : magY   data[16:17] : magZ
+  * data[18:19] : time stamp            data[20]    : accelerometer range
   */
  uint16_t RawTemperature, RawHumidity;
  int16_t RawAccX,RawAccY,RawAccZ; // accelerations in 16bit signed integer
@@ -1232,10 +1255,11 @@ void MysensorTag_updateAdvertisingData(void)
  uint8_t period, config, SensorON=1, MovPeriod;
  uint8_t MovConfig[2]; // read configuration
  static uint8_t HumRawData[4]; // humidity sensor raw data
- static uint8_t MovRawData[18] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}; // movement sensor raw data
+ static uint8_t MovRawData[MOVEMENT_DATA_LEN] = {0}; // movement sensor raw data
  static uint8_t counter = 0; // repetition counter
- float temperature,humidity; // temperature and humidity measurements in Celcius and %
- float accX,accY,accZ; // accelerationX, accelerationY, accelerationZ in G
+ int16_t temperature; // temperature measurement in 0.01 Celcius
+ uint16_t humidity; // humidity measurement in 0.01 %
+ int16_t accX,accY,accZ; // accelerationX, accelerationY, accelerationZ in 0.01 G
  static uint8_t adcRange; //adc range
  static uint8_t i;
 // set parameter
@@ -1262,7 +1286,7 @@ void MysensorTag_updateAdvertisingData(void)
 
  // convert raw acc value into in G at max. 4G configuration(1)
  adcRange = sensorMpu9250AccReadRange() * 4; // 0:2G, 1:4G, 2:8G, 3:16G
- accZ = (RawAccZ * 1.0) / 32768 * adcRange;
+ accZ = FIXED_DIV_POW2((int32_t)RawAccZ * adcRange * FIXED_SCALE, 15);
 
 i++;
  // update advertisement data
@@ -68,6 +68,7 @@ extern "C"
 #define SERVICE_ID_CC        0x09
 #define SERVICE_ID_DISPLAY   0x0A
 #define SERVICE_ID_LIGHT     0x0B
+#define SERVICE_ID_CAL       0x0C
 
  /*********************************************************************
  * MACROS
@@ -46,13 +46,13 @@
 
 #include "barometerservice.h"
 #include "SensorTag_Bar.h"
+#include "SensorTag_Sched.h"
 #include "sensor_bmp280.h"
 #include "sensor.h"
+#include "altimeter.h"
+#include "bsp_i2c.h"
 #include "Board.h"
 
-#include <ti/sysbios/knl/Semaphore.h>
-#include <ti/sysbios/knl/Task.h>
-
 #include "string.h"
 /*********************************************************************
  * MACROS
@@ -65,8 +65,17 @@
 // How often to perform sensor reads (milliseconds)
 #define SENSOR_DEFAULT_PERIOD   1000
 
-// Constants for two-stage reading
-#define SENSOR_FSM_PERIOD       80
+// Sensor configuration: forced mode converts once per read-out and sleeps
+// in between; normal mode converts continuously, which the IIR filter needs.
+// Ultra high resolution oversampling for the altimeter.
+#define BAR_MODE                BMP_MODE_FORCED
+#define BAR_OSRS_T              BMP_OSRS_X2
+#define BAR_OSRS_P              BMP_OSRS_X16
+#define BAR_FILTER              BMP_FILTER_OFF
+#define BAR_STANDBY             BMP_STANDBY_1000MS
+
+// Send the altitude when it has changed this much since the last report (cm)
+#define ALT_REPORT_STEP         25
 
 // Length of the data for this sensor
 #define SENSOR_DATA_LEN         BAROMETER_DATA_LEN
@@ -74,10 +83,6 @@
 // Event flag for this sensor
 #define SENSOR_EVT              ST_BAROMETER_SENSOR_EVT
 
-// Task configuration
-#define SENSOR_TASK_PRIORITY    1
-#define SENSOR_TASK_STACK_SIZE  600
-
  /*********************************************************************
  * TYPEDEFS
  */
@@ -97,24 +102,34 @@
 /*********************************************************************
  * LOCAL VARIABLES
  */
-// Entity ID globally used to check for source and/or destination of messages
-static ICall_EntityID sensorSelfEntity;
-
-// Semaphore globally used to post events to the application thread
-static ICall_Semaphore sensorSem;
-
-// Task setup
-static Task_Struct sensorTask;
-static Char sensorTaskStack[SENSOR_TASK_STACK_SIZE];
-
 // Parameters
 static uint8_t sensorConfig;
 static uint16_t sensorPeriod;
+static uint8_t sensorState;
+
+// Conversion time (ms) and normal mode running
+static uint16_t convTime;
+static bool sensorRunning;
+
+// Time of the previous sample and the last reported altitude
+static uint32_t altLastTick;
+static int32_t altReported;
+
+// Read-out queued as an I2C batch, so the task does not wait for the bus
+static bspI2cBatchOp_t readOp;
+static uint8_t readData[BMP_DATA_SIZE];
+static volatile bool readDone;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
-static void sensorTaskFxn(UArg a0, UArg a1);
+static void sensorSchedCB(void);
+static void sensorReadStart(void);
+static void sensorReadout(bool success);
+static void sensorReadCB(bspI2cBatchOp_t *ops, uint8_t nOps, uint8_t nFailed);
+static void altitudeProcess(int32_t temp, uint32_t press);
+static void altitudePublish(void);
+static void referencePublish(void);
 static void sensorConfigChangeCB( uint8_t paramID);
 static void initCharacteristicValue( uint8_t paramID, uint8_t value,
                                     uint8_t paramLen);
@@ -133,25 +148,35 @@ static sensorCBs_t sensorCallbacks =
  */
 
 /*********************************************************************
- * @fn      SensorTagBar_createTask
+ * @fn      SensorTagBar_init
  *
- * @brief   Task creation function for barometer sensor
+ * @brief   Initialization function for the SensorTag barometer
  *
  * @param   none
  *
  * @return  none
  */
-void SensorTagBar_createTask(void)
+void SensorTagBar_init(void)
 {
-  Task_Params taskParames;
+  // Add service
+  Barometer_addService();
 
-  // Create the task for the state machine
-  Task_Params_init(&taskParames);
-  taskParames.stack = sensorTaskStack;
-  taskParames.stackSize = SENSOR_TASK_STACK_SIZE;
-  taskParames.priority = SENSOR_TASK_PRIORITY;
+  // Register callbacks with profile
+  Barometer_registerAppCBs(&sensorCallbacks);
 
-  Task_construct(&sensorTask, sensorTaskFxn, &taskParames, NULL);
+  // Register with the sensor scheduler
+  SensorTagSched_register(SCHED_ID_BAR, sensorSchedCB);
+
+  // Initialize the module state variables
+  sensorConfig = ST_CFG_SENSOR_DISABLE;
+  sensorPeriod = SENSOR_DEFAULT_PERIOD;
+  sensorRunning = false;
+  sensorBmp280Configure(BAR_MODE, BAR_OSRS_T, BAR_OSRS_P, BAR_FILTER,
+                        BAR_STANDBY);
+  convTime = sensorBmp280ConversionTime();
+  SensorTagBar_reset();
+  initCharacteristicValue(SENSOR_PERI, SENSOR_DEFAULT_PERIOD
+                          / SENSOR_PERIOD_RESOLUTION, sizeof ( uint8_t ));
 }
 
 /*********************************************************************
@@ -163,6 +188,7 @@ void SensorTagBar_createTask(void)
 void SensorTagBar_processCharChangeEvt(uint8_t paramID)
 {
   uint8_t newValue;
+  uint8_t refValue[BAROMETER_REF_LEN];
 
   switch (paramID)
   {
@@ -180,15 +206,18 @@ void SensorTagBar_processCharChangeEvt(uint8_t paramID)
       {
         sensorConfig = ST_CFG_SENSOR_DISABLE;
         initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
+        initCharacteristicValue(BAROMETER_ALT, 0, BAROMETER_ALT_LEN);
 
-        // Deactivate task
-        Task_setPri(Task_handle(&sensorTask), -1);
+        // Stop the read-out
+        SensorTagSched_stop(SCHED_ID_BAR);
       }
       else if (newValue == ST_CFG_SENSOR_ENABLE)
       {
         sensorConfig = ST_CFG_SENSOR_ENABLE;
-        // Activate task
-        Task_setPri(Task_handle(&sensorTask), SENSOR_TASK_PRIORITY);
+        // The sample stream restarts, the reference is kept
+        Altimeter_restart();
+        // Start the read-out
+        SensorTagSched_startPeriod(SCHED_ID_BAR, sensorPeriod);
       }
     }
     else
@@ -199,6 +228,8 @@ void SensorTagBar_processCharChangeEvt(uint8_t paramID)
 
     // Make sure sensor is disabled
     sensorBmp280Enable(false);
+    sensorRunning = false;
+    sensorState = SCHED_STATE_IDLE;
 
     break;
 
@@ -207,6 +238,21 @@ void SensorTagBar_processCharChangeEvt(uint8_t paramID)
     sensorPeriod = newValue * SENSOR_PERIOD_RESOLUTION;
     break;
 
+  case BAROMETER_REF:
+    Barometer_getParameter(BAROMETER_REF, refValue);
+    Altimeter_setReference((uint32_t)refValue[0] |
+                           ((uint32_t)refValue[1] << 8) |
+                           ((uint32_t)refValue[2] << 16) |
+                           ((uint32_t)refValue[3] << 24));
+
+    // Show the reference in use and the altitude against it
+    referencePublish();
+    if (Altimeter_getPressure() != 0)
+    {
+      altitudePublish();
+    }
+    break;
+
   default:
     // Should not get here
     break;
@@ -227,7 +273,13 @@ void SensorTagBar_reset(void)
   sensorConfig = ST_CFG_SENSOR_DISABLE;
   initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
   initCharacteristicValue(SENSOR_CONF, ST_CFG_SENSOR_DISABLE, sizeof(uint8_t));
+  initCharacteristicValue(BAROMETER_ALT, 0, BAROMETER_ALT_LEN);
+  initCharacteristicValue(BAROMETER_REF, 0, BAROMETER_REF_LEN);
+  Altimeter_init();
   sensorBmp280Init();
+  sensorRunning = false;
+  sensorState = SCHED_STATE_IDLE;
+  SensorTagSched_stop(SCHED_ID_BAR);
 }
 
 /*********************************************************************
@@ -235,84 +287,239 @@ void SensorTagBar_reset(void)
 */
 
 /*********************************************************************
- * @fn      sensorTaskInit
+ * @fn      sensorSchedCB
  *
- * @brief   Initialization function for the SensorTag barometer
+ * @brief   Read-out state machine, one step per call from the sensor
+ *          scheduler
  *
+ * @return  none
  */
-static void sensorTaskInit(void)
+static void sensorSchedCB(void)
 {
-  // Register task with BLE stack
-  ICall_registerApp(&sensorSelfEntity, &sensorSem);
+  if ( sensorConfig != ST_CFG_SENSOR_ENABLE )
+  {
+    return;
+  }
 
-  // Add service
-  Barometer_addService();
+  switch (sensorState)
+  {
+  case SCHED_STATE_IDLE:
+    if (!sensorRunning)
+    {
+      // A forced conversion is started for each read-out
+      sensorBmp280Enable(true);
+      sensorRunning = (BAR_MODE == BMP_MODE_NORMAL);
+      sensorState = SCHED_STATE_CONVERTING;
+      SensorTagSched_start(SCHED_ID_BAR, convTime);
+    }
+    else
+    {
+      // In normal mode the latest result is read
+      sensorReadStart();
+    }
+    break;
 
-  // Register callbacks with profile
-  Barometer_registerAppCBs(&sensorCallbacks);
+  case SCHED_STATE_CONVERTING:
+    sensorReadStart();
+    break;
 
-  // Initialize the module state variables
-  sensorConfig = ST_CFG_SENSOR_DISABLE;
-  sensorPeriod = SENSOR_DEFAULT_PERIOD;
-  SensorTagBar_reset();
-  initCharacteristicValue(SENSOR_PERI, SENSOR_DEFAULT_PERIOD
-                          / SENSOR_PERIOD_RESOLUTION, sizeof ( uint8_t ));
+  case SCHED_STATE_READING:
+    if (readDone)
+    {
+      // Batched read-out completed
+      readDone = false;
+      sensorReadout(sensorBmp280ReadDone(&readOp, readData));
+    }
+    break;
+
+  default:
+    break;
+  }
 }
 
 /*********************************************************************
- * @fn      sensorTaskFxn
+ * @fn      sensorReadStart
  *
- * @brief   The task loop of the humidity readout task
+ * @brief   Queue the read-out of a result. It shares the bus with the
+ *          other sensors served in the same wake-up; the next step runs
+ *          when the batch is done.
  *
  * @return  none
  */
-static void sensorTaskFxn(UArg a0, UArg a1)
+static void sensorReadStart(void)
 {
-  // Initialize the task
-  sensorTaskInit();
+  bool success;
 
-  // Deactivate task (active only when measurement is enabled)
-  Task_setPri(Task_handle(&sensorTask), -1);
+  readDone = false;
+  sensorState = SCHED_STATE_READING;
 
-  // Task loop
-  while (true)
+  sensorBmp280ReadBatch(&readOp, readData);
+  if (bspI2cBatchSubmit(BSP_I2C_INTERFACE_0, &readOp, 1, sensorReadCB))
   {
-    if ( sensorConfig == ST_CFG_SENSOR_ENABLE )
-    {
-      uint8_t data[BMP_DATA_SIZE];
-      int32_t temp;
-      uint32_t press;
-      bool success;
+    return;
+  }
 
-      // Readout
-      sensorBmp280Enable(true);
-      delay_ms(SENSOR_FSM_PERIOD);
-      success = sensorBmp280Read(data);
-      sensorBmp280Enable(false);
+  // Bus not available for a batch, read synchronously
+  success = sensorBmp280Read(readData);
+  sensorReadout(success);
+}
 
-      // Processing
-      if (success)
-      {
-        sensorBmp280Convert(data,&temp,&press);
+/*********************************************************************
+ * @fn      sensorReadout
+ *
+ * @brief   Convert and publish a result, then wait for the next period
+ *
+ * @param   success - true if the data read is valid
+ *
+ * @return  none
+ */
+static void sensorReadout(bool success)
+{
+  uint8_t *data = readData;
+  int32_t temp;
+  uint32_t press;
 
-        data[2] = (temp >> 16) & 0xFF;
-        data[1] = (temp >> 8) & 0xFF;
-        data[0] = temp & 0xFF;
+  // Processing
+  if (success)
+  {
+    sensorBmp280Convert(data,&temp,&press);
+    altitudeProcess(temp, press);
 
-        data[5] = (press >> 16) & 0xFF;
-        data[4] = (press >> 8) & 0xFF;
-        data[3] = press & 0xFF;
-      }
+    data[2] = (temp >> 16) & 0xFF;
+    data[1] = (temp >> 8) & 0xFF;
+    data[0] = temp & 0xFF;
 
-      // Send data
-      Barometer_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, data);
-      delay_ms(sensorPeriod - SENSOR_FSM_PERIOD);
-    }
-    else
-    {
-      delay_ms(SENSOR_DEFAULT_PERIOD);
-    }
+    data[5] = (press >> 16) & 0xFF;
+    data[4] = (press >> 8) & 0xFF;
+    data[3] = press & 0xFF;
+  }
+
+  // Send data
+  Barometer_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, data);
+
+  sensorState = SCHED_STATE_IDLE;
+  SensorTagSched_startPeriod(SCHED_ID_BAR, sensorPeriod);
+}
+
+/*********************************************************************
+ * @fn      sensorReadCB
+ *
+ * @brief   Completion of the batched read-out (Hwi context)
+ *
+ * @param   ops - batch entries
+ * @param   nOps - number of entries
+ * @param   nFailed - number of failed entries
+ *
+ * @return  none
+ */
+static void sensorReadCB(bspI2cBatchOp_t *ops, uint8_t nOps, uint8_t nFailed)
+{
+  readDone = true;
+  SensorTagSched_trigger(SCHED_ID_BAR);
+}
+
+/*********************************************************************
+ * @fn      altitudeProcess
+ *
+ * @brief   Feed a result to the altimeter. The altitude is only sent
+ *          when it has moved by ALT_REPORT_STEP or the pressure trend
+ *          has been updated.
+ *
+ * @param   temp - temperature (0.01 degC)
+ * @param   press - pressure (Pa)
+ *
+ * @return  none
+ */
+static void altitudeProcess(int32_t temp, uint32_t press)
+{
+  uint32_t now;
+  uint32_t dtMs;
+  int32_t diff;
+  bool first;
+  bool trendUpdated;
+
+  now = Clock_getTicks();
+  dtMs = ((now - altLastTick) * Clock_tickPeriod) / 1000;
+  altLastTick = now;
+  if (dtMs > UINT16_MAX)
+  {
+    dtMs = UINT16_MAX;
   }
+
+  first = (Altimeter_getPressure() == 0);
+  trendUpdated = Altimeter_update(press, temp, (uint16_t)dtMs);
+
+  if (first)
+  {
+    // The reference may have been taken from this sample
+    referencePublish();
+  }
+
+  diff = Altimeter_getAltitude() - altReported;
+  if (first || trendUpdated || diff >= ALT_REPORT_STEP ||
+      diff <= -ALT_REPORT_STEP)
+  {
+    altitudePublish();
+  }
+}
+
+/*********************************************************************
+ * @fn      altitudePublish
+ *
+ * @brief   Send the altitude, filtered pressure and pressure trend
+ *
+ * @return  none
+ */
+static void altitudePublish(void)
+{
+  uint8_t data[BAROMETER_ALT_LEN];
+  uint32_t press;
+  int16_t trend1h;
+  int16_t trend3h;
+
+  altReported = Altimeter_getAltitude();
+  press = Altimeter_getPressure();
+  data[12] = Altimeter_getTrend(&trend1h, &trend3h);
+
+  data[3] = (altReported >> 24) & 0xFF;
+  data[2] = (altReported >> 16) & 0xFF;
+  data[1] = (altReported >> 8) & 0xFF;
+  data[0] = altReported & 0xFF;
+
+  data[7] = (press >> 24) & 0xFF;
+  data[6] = (press >> 16) & 0xFF;
+  data[5] = (press >> 8) & 0xFF;
+  data[4] = press & 0xFF;
+
+  data[9] = (trend1h >> 8) & 0xFF;
+  data[8] = trend1h & 0xFF;
+
+  data[11] = (trend3h >> 8) & 0xFF;
+  data[10] = trend3h & 0xFF;
+
+  Barometer_setParameter(BAROMETER_ALT, BAROMETER_ALT_LEN, data);
+}
+
+/*********************************************************************
+ * @fn      referencePublish
+ *
+ * @brief   Show the reference pressure in use
+ *
+ * @return  none
+ */
+static void referencePublish(void)
+{
+  uint8_t data[BAROMETER_REF_LEN];
+  uint32_t ref;
+
+  ref = Altimeter_getReference();
+
+  data[3] = (ref >> 24) & 0xFF;
+  data[2] = (ref >> 16) & 0xFF;
+  data[1] = (ref >> 8) & 0xFF;
+  data[0] = ref & 0xFF;
+
+  Barometer_setParameter(BAROMETER_REF, BAROMETER_REF_LEN, data);
 }
 
 /*********************************************************************
@@ -346,7 +553,7 @@ static void sensorConfigChangeCB(uint8_t paramID)
 static void initCharacteristicValue(uint8_t paramID, uint8_t value,
                                     uint8_t paramLen)
 {
-  uint8_t data[SENSOR_DATA_LEN];
+  uint8_t data[BAROMETER_ALT_LEN];
 
   memset(data, value, paramLen);
   Barometer_setParameter(paramID, paramLen, data);
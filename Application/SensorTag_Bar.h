@@ -63,9 +63,9 @@ extern "C"
  */
 
  /*
- * Create the Barometer sensor task
+ * Initialization for the SensorTag barometer
  */
-void SensorTagBar_createTask(void);
+extern void SensorTagBar_init(void);
 
 /*
  * Task Event Processor for characteristic changes
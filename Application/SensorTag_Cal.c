@@ -0,0 +1,238 @@
+/*******************************************************************************
+  Filename:       SensorTag_Cal.c
+
+  Description:    This file contains the Sensor Tag sample application,
+                  calibration table of the sensors, kept in non-volatile memory
+                  and written through the Calibration service.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+/*********************************************************************
+ * INCLUDES
+ */
+#include "gatt.h"
+#include "gattservapp.h"
+#include "osal_snv.h"
+
+#include "calservice.h"
+#include "SensorTag_Cal.h"
+#include "sensor.h"
+#include "string.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Non-volatile memory item of the calibration table
+#define CAL_NV_ID               BLE_NVID_CUST_START
+
+// Gyroscope full scale at the lowest range (deg/s)
+#define GYRO_FULL_SCALE         250
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+/*********************************************************************
+ * EXTERNAL VARIABLES
+ */
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static SensorTagCal_t calTable;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void calChangeCB(uint8_t paramID);
+
+/*********************************************************************
+ * PROFILE CALLBACKS
+ */
+static sensorCBs_t sensorTag_calCBs =
+{
+  calChangeCB,              // Characteristic value change callback
+};
+
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      SensorTagCal_init
+ *
+ * @brief   Initialization function for the SensorTag calibration. The
+ *          table is read from non-volatile memory; without a stored
+ *          table no correction is applied.
+ *
+ * @return  none
+ */
+void SensorTagCal_init(void)
+{
+  // Add service
+  Cal_addService();
+  Cal_registerAppCBs(&sensorTag_calCBs);
+
+  if (osal_snv_read(CAL_NV_ID, sizeof(calTable), &calTable) != SUCCESS)
+  {
+    memset(&calTable, 0, sizeof(calTable));
+  }
+
+  // The characteristic holds the table (little endian, as in memory)
+  Cal_setParameter(SENSOR_DATA, CAL_DATA_LEN, &calTable);
+}
+
+/*********************************************************************
+ * @fn      SensorTagCal_processCharChangeEvt
+ *
+ * @brief   Store a calibration table written by the client. It applies
+ *          from the next measurement on.
+ *
+ * @param   paramID - parameter identifier
+ *
+ * @return  none
+ */
+void SensorTagCal_processCharChangeEvt(uint8_t paramID)
+{
+  if (paramID == SENSOR_DATA)
+  {
+    Cal_getParameter(SENSOR_DATA, &calTable);
+    osal_snv_write(CAL_NV_ID, sizeof(calTable), &calTable);
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagCal_get
+ *
+ * @brief   Get the calibration table
+ *
+ * @return  pointer to the table
+ */
+const SensorTagCal_t *SensorTagCal_get(void)
+{
+  return &calTable;
+}
+
+/*********************************************************************
+ * @fn      SensorTagCal_gyroBias
+ *
+ * @brief   Get the gyroscope bias in raw units
+ *
+ * @param   bias - bias of the X, Y and Z axes (raw)
+ *
+ * @param   range - gyroscope range (GYR_RANGE_x)
+ *
+ * @return  none
+ */
+void SensorTagCal_gyroBias(int16_t *bias, uint8_t range)
+{
+  int32_t fullScale;
+  uint8_t i;
+
+  // 32768 LSB per full scale
+  fullScale = (int32_t)(GYRO_FULL_SCALE << range) * FIXED_SCALE;
+
+  for (i = 0; i < 3; i++)
+  {
+    int32_t v;
+
+    v = (int32_t)calTable.gyroBias[i] * 32768;
+    v += v < 0 ? -fullScale / 2 : fullScale / 2;
+    bias[i] = (int16_t)(v / fullScale);
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagCal_subtract
+ *
+ * @brief   Subtract an offset from a measurement, saturating at the
+ *          limits of the raw data
+ *
+ * @param   value - raw measurement
+ *
+ * @param   offset - offset (raw)
+ *
+ * @return  corrected measurement
+ */
+int16_t SensorTagCal_subtract(int16_t value, int32_t offset)
+{
+  int32_t v;
+
+  v = (int32_t)value - offset;
+  if (v > INT16_MAX)
+  {
+    v = INT16_MAX;
+  }
+  else if (v < INT16_MIN)
+  {
+    v = INT16_MIN;
+  }
+
+  return (int16_t)v;
+}
+
+
+/*********************************************************************
+* Private functions
+*/
+
+/*********************************************************************
+ * @fn      calChangeCB
+ *
+ * @brief   Callback from Calibration Service indicating a value change
+ *
+ * @param   paramID - parameter ID of the value that was changed.
+ *
+ * @return  none
+ */
+static void calChangeCB(uint8_t paramID)
+{
+  // Wake up the application thread
+  SensorTag_charValueChangeCB(SERVICE_ID_CAL, paramID);
+}
+
+
+/*********************************************************************
+*********************************************************************/
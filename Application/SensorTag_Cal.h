@@ -0,0 +1,102 @@
+/*******************************************************************************
+  Filename:       SensorTag_Cal.h
+
+  Description:    This file contains the Sensor Tag sample application,
+                  calibration table of the sensors, kept in non-volatile memory.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef SENSORTAGCAL_H
+#define SENSORTAGCAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "SensorTag.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Calibration table; the offsets are subtracted from the measurements
+typedef struct
+{
+  int16_t gyroBias[3];          // Gyroscope bias (0.01 deg/s)
+  int16_t magOffset[3];         // Magnetometer hard-iron offset (raw)
+  int16_t tempOffset;           // Ambient temperature offset (0.01 degC)
+} SensorTagCal_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Initialize the calibration table and service
+ */
+extern void SensorTagCal_init(void);
+
+/*
+ * Task Event Processor for characteristic changes
+ */
+extern void SensorTagCal_processCharChangeEvt(uint8_t paramID);
+
+/*
+ * Get the calibration table
+ */
+extern const SensorTagCal_t *SensorTagCal_get(void);
+
+/*
+ * Get the gyroscope bias in raw units for a gyroscope range
+ */
+extern void SensorTagCal_gyroBias(int16_t *bias, uint8_t range);
+
+/*
+ * Subtract an offset, saturating at the limits of the raw data
+ */
+extern int16_t SensorTagCal_subtract(int16_t value, int32_t offset);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORTAGCAL_H */
@@ -48,13 +48,12 @@
 
 #include "humidityservice.h"
 #include "SensorTag_Hum.h"
+#include "SensorTag_Sched.h"
+#include "SensorTag_Cal.h"
 #include "sensor_hdc1000.h"
 #include "sensortag.h"
 #include "sensor.h"
 
-#include <ti/sysbios/knl/Semaphore.h>
-#include <ti/sysbios/knl/Task.h>
-
 /*********************************************************************
  * MACROS
  */
@@ -66,16 +65,13 @@
 // How often to perform sensor reads (milliseconds)
 #define SENSOR_DEFAULT_PERIOD   1000
 
-// Time start measurement and data ready
-#define HUM_DELAY_PERIOD          15
+// Resolution: 11 bit halves the conversion time compared to 14 bit
+#define HUM_TEMP_RESOLUTION     HDC1000_RES_11BIT
+#define HUM_HUM_RESOLUTION      HDC1000_RES_11BIT
 
 // Length of the data for this sensor
 #define SENSOR_DATA_LEN         HUMIDITY_DATA_LEN
 
-// Task configuration
-#define SENSOR_TASK_PRIORITY    1
-#define SENSOR_TASK_STACK_SIZE  600
-
 /*********************************************************************
  * TYPEDEFS
  */
@@ -96,24 +92,19 @@
  * LOCAL VARIABLES
  */
 
-// Entity ID globally used to check for source and/or destination of messages
-static ICall_EntityID sensorSelfEntity;
-
-// Semaphore globally used to post events to the application thread
-static ICall_Semaphore sensorSem;
-
-// Task setup
-static Task_Struct sensorTask;
-static Char sensorTaskStack[SENSOR_TASK_STACK_SIZE];
-
 // Parameters
 static uint8_t sensorConfig;
 static uint16_t sensorPeriod;
+static uint8_t sensorState;
+
+// Time from start of measurement until data ready (ms)
+static uint16_t convTime;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
-static void sensorTaskFxn(UArg a0, UArg a1);
+static void sensorSchedCB(void);
+static void sensorCalApply(uint16_t *rawTemp);
 static void sensorConfigChangeCB( uint8_t paramID);
 static void initCharacteristicValue( uint8_t paramID, uint8_t value,
                                     uint8_t paramLen);
@@ -131,25 +122,34 @@ static sensorCBs_t sensorCallbacks =
  * PUBLIC FUNCTIONS
  */
 /*********************************************************************
- * @fn      SensorTagHum_createTask
+ * @fn      SensorTagHum_init
  *
- * @brief   Task creation function for the SensorTag
+ * @brief   Initialization function for the SensorTag humidity sensor
  *
  * @param   none
  *
  * @return  none
  */
-void SensorTagHum_createTask(void)
+void SensorTagHum_init(void)
 {
-  Task_Params taskParames;
+  // Add service
+  Humidity_addService();
 
-  // Create the task for the state machine
-  Task_Params_init(&taskParames);
-  taskParames.stack = sensorTaskStack;
-  taskParames.stackSize = SENSOR_TASK_STACK_SIZE;
-  taskParames.priority = SENSOR_TASK_PRIORITY;
+  // Register callbacks with profile
+  Humidity_registerAppCBs(&sensorCallbacks);
+
+  // Register with the sensor scheduler
+  SensorTagSched_register(SCHED_ID_HUM, sensorSchedCB);
+
+  // Initialize the module state variables
+  sensorPeriod = SENSOR_DEFAULT_PERIOD;
+  SensorTagHum_reset();
+  initCharacteristicValue(SENSOR_PERI, SENSOR_DEFAULT_PERIOD
+                          / SENSOR_PERIOD_RESOLUTION, sizeof ( uint8_t ));
 
-  Task_construct(&sensorTask, sensorTaskFxn, &taskParames, NULL);
+  // Initialize the driver
+  sensorHdc1000Configure(HUM_TEMP_RESOLUTION, HUM_HUM_RESOLUTION);
+  convTime = sensorHdc1000ConversionTime();
 }
 
 /*********************************************************************
@@ -179,13 +179,14 @@ void SensorTagHum_processCharChangeEvt(uint8_t paramID)
         // Reset characteristics
         initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
 
-        // Deactivate task
-        Task_setPri(Task_handle(&sensorTask), -1);
+        // Stop the read-out
+        SensorTagSched_stop(SCHED_ID_HUM);
       }
       else
       {
-        // Activate task
-        Task_setPri(Task_handle(&sensorTask), SENSOR_TASK_PRIORITY);
+        // Start the read-out
+        sensorState = SCHED_STATE_IDLE;
+        SensorTagSched_startPeriod(SCHED_ID_HUM, sensorPeriod);
       }
 
       sensorConfig = newValue;
@@ -220,6 +221,8 @@ void SensorTagHum_processCharChangeEvt(uint8_t paramID)
 void SensorTagHum_reset (void)
 {
   sensorConfig = ST_CFG_SENSOR_DISABLE;
+  sensorState = SCHED_STATE_IDLE;
+  SensorTagSched_stop(SCHED_ID_HUM);
   initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
   initCharacteristicValue(SENSOR_CONF, ST_CFG_SENSOR_DISABLE, sizeof(uint8_t));
 }
@@ -229,40 +232,14 @@ void SensorTagHum_reset (void)
 */
 
 /*********************************************************************
- * @fn      sensorTaskInit
- *
- * @brief   Initialization function for the SensorTag humidity sensor
- *
- */
-static void sensorTaskInit(void)
-{
-  // Register task with BLE stack
-  ICall_registerApp(&sensorSelfEntity, &sensorSem);
-
-  // Add service
-  Humidity_addService();
-
-  // Register callbacks with profile
-  Humidity_registerAppCBs(&sensorCallbacks);
-
-  // Initialize the module state variables
-  sensorPeriod = SENSOR_DEFAULT_PERIOD;
-  SensorTagHum_reset();
-  initCharacteristicValue(SENSOR_PERI, SENSOR_DEFAULT_PERIOD
-                          / SENSOR_PERIOD_RESOLUTION, sizeof ( uint8_t ));
-
-  // Initialize the driver
-  sensorHdc1000Init();
-}
-
-/*********************************************************************
- * @fn      sensorTaskFxn
+ * @fn      sensorSchedCB
  *
- * @brief   The task loop of the humidity readout task
+ * @brief   Read-out state machine, one step per call from the sensor
+ *          scheduler
  *
  * @return  none
  */
-static void sensorTaskFxn(UArg a0, UArg a1)
+static void sensorSchedCB(void)
 {
   typedef union {
     struct {
@@ -271,42 +248,73 @@ static void sensorTaskFxn(UArg a0, UArg a1)
     uint8_t a[2];
   } Data_t;
 
-  // Initialize the task
-  sensorTaskInit();
-
-
+  Data_t data;
 
-  // Deactivate task (active only when measurement is enabled)
-  Task_setPri(Task_handle(&sensorTask), -1);
+  if (sensorConfig != ST_CFG_SENSOR_ENABLE)
+  {
+    return;
+  }
 
-  // Task loop
-  while (true)
+  switch (sensorState)
   {
-	//  SensorTag_blinkLed(Board_LED1,100); // indicate whether this function is called
-    if (sensorConfig == ST_CFG_SENSOR_ENABLE)
+  case SCHED_STATE_IDLE:
+    // 1. Start temperature measurement
+    sensorHdc1000Start();
+    sensorState = SCHED_STATE_CONVERTING;
+    SensorTagSched_start(SCHED_ID_HUM, convTime);
+    break;
+
+  case SCHED_STATE_CONVERTING:
+    // 2. Read data
+    if (sensorHdc1000Read(&data.v.rawTemp, &data.v.rawHum))
     {
-      Data_t data;
+      sensorCalApply(&data.v.rawTemp);
+    }
 
-      // 1. Start temperature measurement
-      sensorHdc1000Start();
-      delay_ms(HUM_DELAY_PERIOD);
+    // 3. Send data
+    Humidity_setParameter( SENSOR_DATA, SENSOR_DATA_LEN, data.a);
 
-      // 2. Read data
-      sensorHdc1000Read(&data.v.rawTemp, &data.v.rawHum);
+    // 4. Wait until next cycle
+    sensorState = SCHED_STATE_IDLE;
+    SensorTagSched_startPeriod(SCHED_ID_HUM, sensorPeriod);
+    break;
 
-      // 3. Send data
-      Humidity_setParameter( SENSOR_DATA, SENSOR_DATA_LEN, data.a);
+  default:
+    break;
+  }
+}
 
-      // 4. Wait until next cycle
-      delay_ms(sensorPeriod - HUM_DELAY_PERIOD);
+/*********************************************************************
+ * @fn      sensorCalApply
+ *
+ * @brief   Correct the temperature with the calibration table. The LSB
+ *          of the raw temperature is 165/65536 degC.
+ *
+ * @param   rawTemp - raw temperature
+ *
+ * @return  none
+ */
+static void sensorCalApply(uint16_t *rawTemp)
+{
+  int32_t offset;
+  int32_t t;
 
+  // 0.01 degC to raw units, rounded
+  offset = (int32_t)SensorTagCal_get()->tempOffset * 65536;
+  offset += offset < 0 ? -(165 * FIXED_SCALE) / 2 : (165 * FIXED_SCALE) / 2;
+  offset /= 165 * FIXED_SCALE;
 
-    }
-    else
-    {
-      delay_ms(SENSOR_DEFAULT_PERIOD);
-    }
+  t = (int32_t)*rawTemp - offset;
+  if (t < 0)
+  {
+    t = 0;
+  }
+  else if (t > UINT16_MAX)
+  {
+    t = UINT16_MAX;
   }
+
+  *rawTemp = (uint16_t)t;
 }
 
 /*********************************************************************
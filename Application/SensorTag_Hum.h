@@ -64,9 +64,9 @@ extern "C"
  */
   
 /*
- * Create the Humidity sensor task
+ * Initialization for the SensorTag humidity sensor
  */  
-void SensorTagHum_createTask(void);
+extern void SensorTagHum_init(void);
 
 /*
  * Task Event Processor for characteristic changes
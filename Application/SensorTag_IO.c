@@ -44,10 +44,12 @@
 #include "gattservapp.h"
 #include "SensorTag_IO.h"
 #include "ioservice.h"
+#include "SensorTag_Sched.h"
 
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Queue.h> // Needed for util.h
+#include <ti/drivers/pin/PINCC26XX.h>
 
 #include "Board.h"
 #include "peripheral.h"
@@ -55,6 +57,8 @@
 #include "util.h"
 #include "sensor_mpu9250.h"
 #include "ext_flash.h"
+#include "bsp_i2c.h"
+#include "string.h"
 
 /*********************************************************************
  * MACROS
@@ -111,6 +115,10 @@ static Clock_Handle buzzClockHandle;
  */
 static void ioChangeCB(uint8_t newParamID);
 static void initBuzzTimer(void);
+static void i2cDiagUpdate(uint8_t entry);
+static void i2cDiagRead(uint8_t *pValue);
+static void i2cDiagPack(uint8_t entry, uint8_t *diag);
+static void pinDiagPack(uint8_t entry, uint8_t *diag);
 
 /*********************************************************************
  * PROFILE CALLBACKS
@@ -136,6 +144,7 @@ void SensorTagIO_init(void)
   // Add service
   Io_addService();
   Io_registerAppCBs(&sensorTag_ioCBs);
+  Io_registerDiagReadCB(i2cDiagRead);
 
   // Initialize the module state variables
   ioMode = IO_MODE_LOCAL;
@@ -158,6 +167,35 @@ void SensorTagIO_init(void)
  */
 void SensorTagIO_processCharChangeEvt(uint8_t paramID)
 { 
+  if (paramID == IO_SAMPLING)
+  {
+    uint8_t sampling[IO_SAMPLING_LEN];
+
+    // Sampling mode; not related to the LEDs and buzzer
+    Io_getParameter(IO_SAMPLING, sampling);
+    SensorTagSched_setMode(sampling[0] == IO_SAMPLING_ALIGNED ?
+                           SCHED_MODE_ALIGNED : SCHED_MODE_FREE);
+    return;
+  }
+
+  if (paramID == IO_I2C_DIAG)
+  {
+    uint8_t diag[IO_I2C_DIAG_LEN];
+    uint8_t entry;
+
+    // Bus metrics; not related to the LEDs and buzzer
+    Io_getParameter(IO_I2C_DIAG, diag);
+    entry = diag[0];
+    if (entry == IO_I2C_DIAG_RESET)
+    {
+      bspI2cResetMetrics();
+      PINCC26XX_resetIsrStats();
+      entry = 0;
+    }
+    i2cDiagUpdate(entry);
+    return;
+  }
+
   if( paramID == SENSOR_CONF )
   {
     
@@ -218,6 +256,30 @@ void SensorTagIO_processCharChangeEvt(uint8_t paramID)
   }
 }
 
+/*********************************************************************
+ * @fn      SensorTagIO_processSamplingEvent
+ *
+ * @brief   Update the sampling characteristic with the number of
+ *          wake-ups per second saved by aligned sampling
+ *
+ * @return  none
+ */
+void SensorTagIO_processSamplingEvent(void)
+{
+  uint16_t saved;
+
+  if (SensorTagSched_getWakesSaved(&saved))
+  {
+    uint8_t sampling[IO_SAMPLING_LEN];
+
+    sampling[0] = SensorTagSched_getMode() == SCHED_MODE_ALIGNED ?
+                  IO_SAMPLING_ALIGNED : IO_SAMPLING_FREE;
+    sampling[1] = LO_UINT16(saved);
+    sampling[2] = HI_UINT16(saved);
+    Io_setParameter(IO_SAMPLING, IO_SAMPLING_LEN, sampling);
+  }
+}
+
 /*********************************************************************
  * @fn      SensorTagIO_reset
  *
@@ -229,11 +291,20 @@ void SensorTagIO_processCharChangeEvt(uint8_t paramID)
  */
 void SensorTagIO_reset(void)
 {
+  uint8_t sampling[IO_SAMPLING_LEN] = { IO_SAMPLING_FREE, 0, 0 };
+
   ioValue = sensorTestResult();
   Io_setParameter( SENSOR_DATA, 1, &ioValue);
 
   ioMode = IO_MODE_LOCAL;
   Io_setParameter( SENSOR_CONF, 1, &ioMode);
+
+  // Free running sampling
+  SensorTagSched_setMode(SCHED_MODE_FREE);
+  Io_setParameter(IO_SAMPLING, IO_SAMPLING_LEN, sampling);
+
+  // Bus metrics of the first slave
+  i2cDiagUpdate(0);
   
   // Normal mode; make sure LEDs and buzzer are off
   PIN_setOutputValue(hGpioPin, Board_LED1, Board_LED_OFF);
@@ -291,6 +362,132 @@ static void timerIsr(UArg arg0)
   PIN_setOutputValue(hGpioPin, Board_BUZZER, !v);
 }
 
+/*********************************************************************
+ * @fn      i2cDiagUpdate
+ *
+ * @brief   Show the I2C bus metrics of one slave, the interface switch
+ *          cost or the interrupt statistics of a pin in the diagnostics
+ *          characteristic
+ *
+ * @param   entry - metrics entry, IO_I2C_DIAG_PIN + pin id or
+ *                  IO_I2C_DIAG_SWITCH
+ *
+ * @return  none
+ */
+static void i2cDiagUpdate(uint8_t entry)
+{
+  uint8_t diag[IO_I2C_DIAG_LEN];
+
+  i2cDiagPack(entry, diag);
+  Io_setParameter(IO_I2C_DIAG, IO_I2C_DIAG_LEN, diag);
+}
+
+/*********************************************************************
+ * @fn      i2cDiagRead
+ *
+ * @brief   Refresh the diagnostics characteristic before it is read
+ *          (BLE stack context).
+ *
+ * @param   pValue - characteristic value, entry in pValue[0]
+ *
+ * @return  none
+ */
+static void i2cDiagRead(uint8_t *pValue)
+{
+  i2cDiagPack(pValue[0], pValue);
+}
+
+/*********************************************************************
+ * @fn      i2cDiagPack
+ *
+ * @brief   Format the I2C bus metrics of one slave, or the interface
+ *          switch cost, as the diagnostics characteristic value
+ *
+ * @param   entry - metrics entry or IO_I2C_DIAG_SWITCH
+ * @param   diag - characteristic value (IO_I2C_DIAG_LEN bytes)
+ *
+ * @return  none
+ */
+static void i2cDiagPack(uint8_t entry, uint8_t *diag)
+{
+  bspI2cMetrics_t m;
+
+  if (entry >= IO_I2C_DIAG_PIN && entry < IO_I2C_DIAG_SWITCH)
+  {
+    pinDiagPack(entry, diag);
+    return;
+  }
+
+  if (entry == IO_I2C_DIAG_SWITCH)
+  {
+    uint32_t count;
+    uint32_t maxUs;
+
+    memset(&m, 0, sizeof(m));
+    bspI2cGetSwitchCost(&count, &m.totalUs, &maxUs);
+    m.transactions = count > 0xFFFF ? 0xFFFF : count;
+    m.maxUs = maxUs > 0xFFFF ? 0xFFFF : maxUs;
+  }
+  else if (!bspI2cGetMetrics(entry, &m))
+  {
+    memset(&m, 0, sizeof(m));
+  }
+
+  diag[0] = entry;
+  diag[1] = m.address;
+  diag[2] = LO_UINT16(m.transactions);
+  diag[3] = HI_UINT16(m.transactions);
+  diag[4] = BREAK_UINT32(m.bytes, 0);
+  diag[5] = BREAK_UINT32(m.bytes, 1);
+  diag[6] = BREAK_UINT32(m.bytes, 2);
+  diag[7] = BREAK_UINT32(m.bytes, 3);
+  diag[8] = BREAK_UINT32(m.totalUs, 0);
+  diag[9] = BREAK_UINT32(m.totalUs, 1);
+  diag[10] = BREAK_UINT32(m.totalUs, 2);
+  diag[11] = BREAK_UINT32(m.totalUs, 3);
+  diag[12] = LO_UINT16(m.maxUs);
+  diag[13] = HI_UINT16(m.maxUs);
+  diag[14] = m.nack;
+  diag[15] = m.arbLost;
+  diag[16] = m.timeout;
+  diag[17] = m.other;
+}
+
+/*********************************************************************
+ * @fn      pinDiagPack
+ *
+ * @brief   Format the I/O interrupt statistics of one pin as the
+ *          diagnostics characteristic value
+ *
+ * @param   entry - IO_I2C_DIAG_PIN + pin id
+ * @param   diag - characteristic value (IO_I2C_DIAG_LEN bytes)
+ *
+ * @return  none
+ */
+static void pinDiagPack(uint8_t entry, uint8_t *diag)
+{
+  PINCC26XX_IsrStats stats;
+  PIN_Id pinId;
+
+  pinId = entry - IO_I2C_DIAG_PIN;
+  if (PINCC26XX_getIsrStats(pinId, &stats) != PIN_SUCCESS)
+  {
+    memset(&stats, 0, sizeof(stats));
+  }
+
+  memset(diag, 0, IO_I2C_DIAG_LEN);
+  diag[0] = entry;
+  diag[1] = pinId;
+  diag[2] = BREAK_UINT32(stats.count, 0);
+  diag[3] = BREAK_UINT32(stats.count, 1);
+  diag[4] = BREAK_UINT32(stats.count, 2);
+  diag[5] = BREAK_UINT32(stats.count, 3);
+  diag[6] = BREAK_UINT32(stats.maxLatency, 0);
+  diag[7] = BREAK_UINT32(stats.maxLatency, 1);
+  diag[8] = BREAK_UINT32(stats.maxLatency, 2);
+  diag[9] = BREAK_UINT32(stats.maxLatency, 3);
+}
+
 /*********************************************************************
  * @fn      initBuzzTimer
  *
@@ -51,15 +51,23 @@
 #include "Board.h"
 #include "movementservice.h"
 #include "SensorTag_Mov.h"
+#include "SensorTag_Sched.h"
+#include "SensorTag_Cal.h"
 #include "sensor_mpu9250.h"
 #include "sensor.h"
+#include "fusion.h"
+#include "spectrum.h"
 #include "util.h"
 #include "string.h"
+#include <driverlib/aon_rtc.h>
 
 /*********************************************************************
  * MACROS
  */
-#define MOVEMENT_INACT_CYCLES   ( MOVEMENT_INACT_TIMEOUT * (1000/sensorPeriod) )
+#define MOVEMENT_INACT_CYCLES   ( (inactTimeout * 1000UL) / readoutPeriod )
+
+// Time stamp (AON RTC, 16.16 seconds) difference to milliseconds
+#define TS_TO_MS(t)             ( (uint32_t)(((uint64_t)(t) * 1000) >> 16) )
 
 /*********************************************************************
  * CONSTANTS and MACROS
@@ -80,15 +88,32 @@
 #define APP_STATE_ACTIVE          2
 
 // Movement task configuration
-#define MOVEMENT_INACT_TIMEOUT    10     // 10 seconds
-#define GYR_SHAKE_THR             10.0
-#define WOM_THR                   10
+#define MOVEMENT_INACT_TIMEOUT    10     // 10 seconds (initial)
+#define GYR_SHAKE_THR             10     // deg/s
+#define WOM_THR                   10     // 40 mg (initial)
+
+// Adaptive duty cycling limits
+#define INACT_TIMEOUT_MIN         2      // s
+#define INACT_TIMEOUT_MAX         60     // s
+#define WOM_THR_MIN               3      // 12 mg
+#define WOM_THR_MAX               64     // 256 mg
+#define WOM_NOISE_MARGIN          4      // threshold / noise floor
+
+// Accelerometer auto range: one range up when a sample reaches 95% of full
+// scale, one range down after ACC_LOW_TIME below 40% (80% of the lower range)
+#define ACC_SAT_LEVEL             31130
+#define ACC_LOW_LEVEL             13107
+#define ACC_LOW_TIME              2000   // ms
 
 // Configuration bit-masks (bits 0-6 defined in sensor_mpu9250.h)
 #define MOV_WOM_ENABLE            0x0080
+#define MOV_MASK_ACC_RANGE        0x0300
 #define MOV_MASK_WOM_THRESHOLD    0x3C00 // TBD
 #define MOV_MASK_INACT_TIMEOUT    0xC000 // TBD
 
+// FIFO read-out buffer (frames)
+#define MOV_FIFO_BUF_FRAMES       (MOVEMENT_FIFO_MAX_WATERMARK * 2)
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -110,9 +135,45 @@
  */
 static Clock_Struct periodicClock;
 static uint16_t sensorPeriod;
+static uint16_t readoutPeriod;
 static volatile bool sensorReadScheduled;
 static uint8_t sensorData[SENSOR_DATA_LEN];
 
+// FIFO read-out (rate in Hz, 0 = FIFO off)
+static uint8_t fifoRate;
+static uint8_t fifoWatermark;
+static bool fifoActive;
+static uint8_t fifoFrames;
+static uint16_t fifoData[MOV_FIFO_BUF_FRAMES * MPU_FIFO_FRAME_SIZE / 2];
+static uint32_t fifoTime[MOV_FIFO_BUF_FRAMES];
+
+// Batched notifications (batch size 0 = one notification per sample)
+static uint8_t batchSize;
+static uint8_t batchRequest;
+static uint8_t batchCount;
+static uint8_t batchLen;
+static uint32_t batchTime;
+static uint8_t batchRange;
+static uint8_t batchData[MOVEMENT_BATCH_MAX_LEN];
+static uint16_t attMtu;
+
+// Register read-out paced by the MPU data ready interrupt
+static bool drdyActive;
+
+// Read-out interval statistics (us) for data ready pacing
+static bool jitterStarted;
+static uint32_t jitterLastTick;
+static uint32_t jitterMin;
+static uint32_t jitterMax;
+static uint32_t jitterSumDev;
+static uint16_t jitterCount;
+
+// Orientation output (period in ms, 0 = off)
+static uint16_t quatPeriod;
+static bool quatStarted;
+static uint32_t quatTime;
+static uint32_t quatSentTime;
+
 // Application state variables
 
 // MPU config:
@@ -128,9 +189,29 @@ static volatile bool mpuDataRdy;
 static uint32_t nActivity;
 static uint8_t movThreshold;
 static uint8_t mpuIntStatus;
-static bool shakeDetected;
 static uint8_t nMotions;
 
+// Adaptive duty cycling: learned inactivity timeout (s), accelerometer
+// noise floor (mg, Q4) and pause between motions (ms)
+static uint8_t inactTimeout;
+static uint32_t accNoise;
+static uint32_t motionGap;
+static uint32_t motionTime;
+static bool motionSeen;
+static bool womWake;
+static int16_t accPrev[3];
+static bool accPrevValid;
+
+// Time spent in each application state (ms): off, idle, active, error
+static uint64_t stateTime[4];
+static uint64_t stateSince;
+
+// Accelerometer auto range: range for the next read-out and start of the
+// current low amplitude period
+static bool accAutoRange;
+static uint8_t accRangeNext;
+static uint32_t accLowTime;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -139,6 +220,27 @@ static void initCharacteristicValue( uint8_t paramID, uint8_t value,
                                     uint8_t paramLen);
 static void SensorTagMov_clockHandler(UArg arg);
 static void appStateSet(uint8_t newState);
+static void readoutStart(void);
+static void fifoPublish(void);
+static void sampleSend(uint32_t timestamp);
+static void batchFlush(void);
+static void batchLimit(void);
+static void quatUpdate(uint32_t timestamp);
+static uint32_t timestampGet(void);
+static uint32_t sampleTimeGet(void);
+static void confExtApply(void);
+static void motionUpdate(uint32_t timestamp);
+static void motionAdapt(void);
+static void stateUpdate(uint8_t newState);
+static void dutyPublish(void);
+static void jitterReset(void);
+static void jitterPublish(void);
+static void spectrumStart(void);
+static void spectrumUpdate(void);
+static void accRangeSet(uint8_t range);
+static void accRangeUpdate(uint32_t timestamp);
+static void accRangeApply(void);
+static void calApply(uint8_t axes);
 
 /*********************************************************************
  * PROFILE CALLBACKS
@@ -170,25 +272,55 @@ void SensorTagMov_init( void )
   // Initialize the module state variables
   mpuConfig = ST_CFG_SENSOR_DISABLE;
   sensorPeriod = SENSOR_DEFAULT_PERIOD;
+  readoutPeriod = sensorPeriod;
   sensorReadScheduled = false;
 
+  fifoRate = 0;
+  fifoWatermark = 0;
+  fifoActive = false;
+  fifoFrames = 0;
+  drdyActive = false;
+  batchSize = 0;
+  batchRequest = 0;
+  batchCount = 0;
+  attMtu = ATT_MTU_SIZE;
+  quatPeriod = 0;
+  quatStarted = false;
+
   appState = APP_STATE_OFF;
   nMotions = 0;
+  stateSince = AONRTCCurrent64BitValueGet();
+  movThreshold = WOM_THR;
+  inactTimeout = MOVEMENT_INACT_TIMEOUT;
+  motionGap = MOVEMENT_INACT_TIMEOUT * 1000UL / 2;
+  accNoise = 0;
+  accAutoRange = false;
 
   if (sensorMpu9250Init())
   {
     SensorTagMov_reset();
     sensorMpu9250RegisterCallback(SensorTagMov_processInterrupt);
+
+    // Compass data is read together with gyro and accelerometer
+    sensorMpu9250MagAuxMode(true);
   }
 
   // Initialize characteristics
   initCharacteristicValue(SENSOR_PERI,
                           SENSOR_DEFAULT_PERIOD / SENSOR_PERIOD_RESOLUTION,
                           sizeof ( uint8_t ));
+  initCharacteristicValue(MOVEMENT_FIFO, 0, MOVEMENT_FIFO_LEN);
+  initCharacteristicValue(MOVEMENT_CONF_EXT, 0, MOVEMENT_CONF_EXT_LEN);
+  initCharacteristicValue(MOVEMENT_SPECTRUM_CONF, 0,
+                          MOVEMENT_SPECTRUM_CONF_LEN);
+  initCharacteristicValue(MOVEMENT_SPECTRUM, 0, MOVEMENT_SPECTRUM_LEN);
+  jitterReset();
+  spectrumStart();
 
   // Create continuous clock for internal periodic events.
   Util_constructClock(&periodicClock, SensorTagMov_clockHandler,
                       1000, sensorPeriod, false, 0);
+  SensorTagSched_registerClock(SCHED_CLOCK_MOV, &periodicClock, sensorPeriod);
 }
 /*********************************************************************
  * @fn      SensorTagMov_processSensorEvent
@@ -242,6 +374,48 @@ void MySensorTagMov_processSensorEvent(void)
  */
 void SensorTagMov_processInterrupt(void)
 {
+  if (drdyActive)
+  {
+    uint32_t now;
+
+    // Interval between read-out triggers
+    now = Clock_getTicks();
+    if (jitterStarted)
+    {
+      uint32_t interval;
+      uint32_t period;
+
+      interval = (now - jitterLastTick) * Clock_tickPeriod;
+      period = (uint32_t)readoutPeriod * 1000;
+
+      if (interval < jitterMin)
+      {
+        jitterMin = interval;
+      }
+      if (interval > jitterMax)
+      {
+        jitterMax = interval;
+      }
+      jitterSumDev += interval > period ? interval - period : period - interval;
+      jitterCount++;
+
+      if (jitterCount == 0xFFFF)
+      {
+        // Keep the mean meaningful; start a new series
+        jitterStarted = false;
+      }
+    }
+    else
+    {
+      jitterMin = 0xFFFFFFFF;
+      jitterMax = 0;
+      jitterSumDev = 0;
+      jitterCount = 0;
+      jitterStarted = true;
+    }
+    jitterLastTick = now;
+  }
+
   // Wake up the application thread
   mpuDataRdy = true;
   sensorReadScheduled = true;
@@ -261,9 +435,11 @@ void SensorTagMov_processSensorEvent(void)
   if (sensorReadScheduled)
   {
     uint8_t axes;
+    bool magRead;
     static uint8_t counter=0;
 
     axes = mpuConfig & MPU_AX_ALL;
+    magRead = false;
     if ((axes != ST_CFG_SENSOR_DISABLE) && (axes != ST_CFG_ERROR))
     {
       // Get interrupt status (clears interrupt)
@@ -281,20 +457,25 @@ void SensorTagMov_processSensorEvent(void)
             nActivity = MOVEMENT_INACT_CYCLES;
           }
         }
-        else if (mpuIntStatus & MPU_DATA_READY)
+        else if (fifoActive)
         {
-          // Read gyro data
-          sensorMpu9250GyroRead((uint16_t*)sensorData);
-
-          // Read accelerometer data
-          sensorMpu9250AccRead((uint16_t*)&sensorData[6]);
-
+          // Burst read of the samples collected since the last read-out
+          uint8_t status;
 
-          if (shakeDetected)
+          status = sensorMpu9250FifoRead(fifoData, MOV_FIFO_BUF_FRAMES,
+                                         &fifoFrames);
+          if (status == MPU_FIFO_READ_ERR)
           {
-            // Motion detected by gyro
-            nActivity = MOVEMENT_INACT_CYCLES;
-            shakeDetected = false;
+            fifoFrames = 0;
+          }
+        }
+        else if (mpuIntStatus & MPU_DATA_READY)
+        {
+          // Gyro, accelerometer and compass in one burst
+          if (sensorMpu9250MovRead((uint16_t*)sensorData))
+          {
+            magRead = !!(mpuConfig & MPU_AX_MAG);
+            calApply(MPU_AX_GYR);
           }
         }
 
@@ -304,19 +485,30 @@ void SensorTagMov_processSensorEvent(void)
         {
           uint8_t status;
 
-          status = sensorMpu9250MagRead((int16_t*)&sensorData[12]);
+          if (magRead)
+          {
+            status = sensorMpu9250MagStatus();
+          }
+          else
+          {
+            status = sensorMpu9250MagRead((int16_t*)&sensorData[12]);
+          }
 
           // Always measure magnetometer (not interrupt driven)
           if (status == MAG_BYPASS_FAIL)
           {
             // Idle on error
             nActivity = 0;
-            appState = APP_STATE_ERROR;
+            stateUpdate(APP_STATE_ERROR);
           }
           else if (status != MAG_STATUS_OK)
           {
             sensorMpu9250MagReset();
           }
+          else
+          {
+            calApply(MPU_AX_MAG);
+          }
         }
       }
 
@@ -325,11 +517,17 @@ void SensorTagMov_processSensorEvent(void)
         if (appState != APP_STATE_ACTIVE)
         {
           // Transition to active state
-          appState = APP_STATE_ACTIVE;
+          womWake = (appState == APP_STATE_IDLE);
+          motionSeen = false;
+          motionTime = timestampGet();
+          stateUpdate(APP_STATE_ACTIVE);
           nMotions = 0;
           if (sensorMpu9250Reset())
           {
             sensorMpu9250Enable(axes);
+            accRangeSet((mpuConfig & MOV_MASK_ACC_RANGE) >> 8);
+            fifoActive = false;
+            readoutStart();
           }
         }
         if (mpuConfig & MOV_WOM_ENABLE)
@@ -338,7 +536,30 @@ void SensorTagMov_processSensorEvent(void)
         }
 
         // Send data
-        Movement_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, sensorData);
+        if (fifoActive)
+        {
+          fifoPublish();
+        }
+        else
+        {
+          uint32_t now;
+
+          now = sampleTimeGet();
+          motionUpdate(now);
+          accRangeUpdate(now);
+          spectrumUpdate();
+          quatUpdate(now);
+          sampleSend(now);
+
+          if (drdyActive)
+          {
+            jitterPublish();
+          }
+        }
+
+        // Range changes apply from the next read-out on
+        accRangeApply();
+        stateUpdate(appState);
         SensorTag_blinkLed(Board_LED1,1);
       }
       else
@@ -347,7 +568,10 @@ void SensorTagMov_processSensorEvent(void)
         {
           // Transition from active to idle state
           nMotions = 0;
-          appState = APP_STATE_IDLE;
+          motionAdapt();
+          stateUpdate(APP_STATE_IDLE);
+          fifoActive = false;
+          drdyActive = false;
           if (sensorMpu9250Reset())
           {
             sensorMpu9250WomEnable(movThreshold);
@@ -400,11 +624,16 @@ void SensorTagMov_processCharChangeEvt(uint8_t paramID)
         if (sensorMpu9250PowerIsOn())
         {
           delay_ms(5);
-          mpuConfig = newCfg | (sensorMpu9250AccReadRange() << 8);
+          mpuConfig = (newCfg & ~MOV_MASK_ACC_RANGE) |
+                      (sensorMpu9250AccReadRange() << 8);
         }
       }
 
       Movement_setParameter(SENSOR_CONF, sizeof(mpuConfig), (uint8_t*)&mpuConfig);
+
+      // Axes may have changed; send what is pending and start a new batch
+      batchFlush();
+      batchLimit();
     }
     else
     {
@@ -419,7 +648,65 @@ void SensorTagMov_processCharChangeEvt(uint8_t paramID)
   case SENSOR_PERI:
     Movement_getParameter(SENSOR_PERI, &newValue8);
     sensorPeriod = newValue8 * SENSOR_PERIOD_RESOLUTION;
-    Util_rescheduleClock(&periodicClock,sensorPeriod);
+    SensorTagSched_setClockPeriod(SCHED_CLOCK_MOV, sensorPeriod);
+    if (!fifoActive)
+    {
+      readoutPeriod = sensorPeriod;
+
+      if (drdyActive)
+      {
+        // Reprogram the MPU sample rate
+        readoutStart();
+      }
+    }
+    break;
+
+  case MOVEMENT_FIFO:
+    {
+      uint8_t fifoCfg[MOVEMENT_FIFO_LEN];
+
+      Movement_getParameter(MOVEMENT_FIFO, fifoCfg);
+      fifoRate = fifoCfg[0];
+      fifoWatermark = fifoCfg[1];
+
+      if (appState == APP_STATE_ACTIVE)
+      {
+        // Switch between FIFO and periodic read-out
+        readoutStart();
+        nActivity = MOVEMENT_INACT_CYCLES;
+      }
+    }
+    break;
+
+  case MOVEMENT_BATCH_SIZE:
+    batchFlush();
+    Movement_getParameter(MOVEMENT_BATCH_SIZE, &batchRequest);
+    batchLimit();
+    break;
+
+  case MOVEMENT_QUAT_PERI:
+    Movement_getParameter(MOVEMENT_QUAT_PERI, &newValue8);
+    quatPeriod = newValue8 * SENSOR_PERIOD_RESOLUTION;
+    quatStarted = false;
+    break;
+
+  case MOVEMENT_JITTER:
+    jitterReset();
+    break;
+
+  case MOVEMENT_SPECTRUM_CONF:
+    spectrumStart();
+    break;
+
+  case MOVEMENT_CONF_EXT:
+    confExtApply();
+
+    if (appState == APP_STATE_ACTIVE)
+    {
+      // New sample rate and filters
+      readoutStart();
+      nActivity = MOVEMENT_INACT_CYCLES;
+    }
     break;
 
   default:
@@ -445,6 +732,26 @@ void SensorTagMov_reset (void)
 
   // Remove power from the MPU
   appStateSet(APP_STATE_OFF);
+
+  // The next connection starts with the default MTU
+  attMtu = ATT_MTU_SIZE;
+  batchLimit();
+}
+
+/*********************************************************************
+ * @fn      SensorTagMov_setMtu
+ *
+ * @brief   Set the ATT MTU of the connection, which limits the size of
+ *          a batch notification
+ *
+ * @param   mtu - ATT MTU
+ *
+ * @return  none
+ */
+void SensorTagMov_setMtu(uint16_t mtu)
+{
+  attMtu = mtu;
+  batchLimit();
 }
 
 
@@ -465,6 +772,7 @@ static void SensorTagMov_clockHandler(UArg arg)
 {
   // Schedule readout periodically
   sensorReadScheduled = true;
+  SensorTagSched_countEvent();
   Semaphore_post(sem);
 
 }
@@ -516,7 +824,9 @@ static void appStateSet(uint8_t newState)
 {
   if (newState == APP_STATE_OFF)
   {
-    appState = APP_STATE_OFF;
+    stateUpdate(APP_STATE_OFF);
+    fifoActive = false;
+    drdyActive = false;
 
     sensorMpu9250Enable(0);
     sensorMpu9250PowerOff();
@@ -527,26 +837,831 @@ static void appStateSet(uint8_t newState)
 
   if (newState == APP_STATE_ACTIVE || newState == APP_STATE_IDLE)
   {
-    appState = APP_STATE_ACTIVE;
-    nActivity = MOVEMENT_INACT_CYCLES;
-    movThreshold = WOM_THR;
+    stateUpdate(APP_STATE_ACTIVE);
     mpuIntStatus = 0;
-    shakeDetected = false;
+    motionSeen = false;
+    womWake = false;
+    accPrevValid = false;
+    motionTime = timestampGet();
     mpuDataRdy = false;
+    fifoActive = false;
+    drdyActive = false;
 
     sensorMpu9250PowerOn();
     sensorMpu9250Enable(mpuConfig & 0xFF);
+    accRangeSet((mpuConfig & MOV_MASK_ACC_RANGE) >> 8);
 
     if (newState == APP_STATE_ACTIVE)
     {
       // Start scheduled data measurements
-      Util_startClock(&periodicClock);
+      readoutStart();
     }
     else
     {
       // Stop scheduled data measurements
       Util_stopClock(&periodicClock);
     }
+    nActivity = MOVEMENT_INACT_CYCLES;
+  }
+}
+
+/*******************************************************************************
+ * @fn      readoutStart
+ *
+ * @brief   Start FIFO read-out if configured, otherwise register read-out
+ *          paced by the MPU data ready interrupt. In FIFO mode the MPU wakes
+ *          the application once per watermark. The periodic clock is only
+ *          used if the MPU can not be configured.
+ *
+ */
+static void readoutStart(void)
+{
+  bool fifoOn;
+  bool drdyOn;
+
+  fifoOn = false;
+  drdyOn = false;
+  if (fifoRate > 0)
+  {
+    fifoOn = sensorMpu9250FifoEnable(fifoRate, fifoWatermark);
+  }
+
+  if (fifoOn)
+  {
+    readoutPeriod = (fifoWatermark * 1000) / fifoRate;
+    Util_stopClock(&periodicClock);
+  }
+  else
+  {
+    // Hardware timed sampling; no drift between clock and conversions
+    readoutPeriod = sensorPeriod;
+    drdyOn = sensorMpu9250DataRdyEnable(sensorPeriod);
+
+    if (drdyOn)
+    {
+      Util_stopClock(&periodicClock);
+    }
+    else
+    {
+      sensorMpu9250DataRdyDisable();
+      SensorTagSched_startClock(SCHED_CLOCK_MOV);
+    }
+  }
+
+  fifoActive = fifoOn;
+  fifoFrames = 0;
+  drdyActive = drdyOn;
+  jitterReset();
+  accPrevValid = false;
+
+  // Restart orientation tracking and the spectrum window after a gap in the
+  // samples or a change of rate
+  quatStarted = false;
+  spectrumStart();
+}
+
+/*******************************************************************************
+ * @fn      fifoPublish
+ *
+ * @brief   Send the frames read from the FIFO, each with the most recent
+ *          magnetometer sample. Each frame gets the time stamp latched for
+ *          it by the data ready interrupt.
+ *
+ */
+static void fifoPublish(void)
+{
+  uint8_t nTime;
+  uint8_t i;
+
+  nTime = sensorMpu9250TimestampRead(fifoTime, fifoFrames);
+
+  if (nTime < fifoFrames)
+  {
+    uint32_t now;
+    uint32_t period;
+
+    // Time stamps lost (FIFO was flushed); the last frame was sampled most
+    // recently and frames are one period apart
+    sensorMpu9250TimestampFlush();
+    now = timestampGet();
+    period = 65536UL / fifoRate;
+
+    for (i = 0; i < fifoFrames; i++)
+    {
+      fifoTime[i] = now - (uint32_t)(fifoFrames - 1 - i) * period;
+    }
+  }
+
+  for (i = 0; i < fifoFrames; i++)
+  {
+    memcpy(sensorData, &fifoData[i * MPU_FIFO_FRAME_SIZE / 2],
+           MPU_FIFO_FRAME_SIZE);
+    calApply(MPU_AX_GYR);
+    motionUpdate(fifoTime[i]);
+    accRangeUpdate(fifoTime[i]);
+    spectrumUpdate();
+    quatUpdate(fifoTime[i]);
+    sampleSend(fifoTime[i]);
+  }
+
+  fifoFrames = 0;
+}
+
+/*******************************************************************************
+ * @fn      sampleSend
+ *
+ * @brief   Send the current sample, either as a notification of its own or
+ *          packed into a batch with the other samples of the batch. Only
+ *          the enabled axes are packed. The accelerometer range goes with
+ *          the sample or the batch; a range change starts a new batch.
+ *
+ * @param   timestamp - sample time (AON RTC)
+ *
+ */
+static void sampleSend(uint32_t timestamp)
+{
+  uint32_t delta;
+  uint8_t range;
+  uint8_t *p;
+
+  range = (mpuConfig & MOV_MASK_ACC_RANGE) >> 8;
+
+  if (batchSize == 0)
+  {
+    // Axes followed by the short time stamp and the range
+    delta = (timestamp >> MOVEMENT_TS_SHIFT) & MOVEMENT_TS_MASK;
+    sensorData[MOVEMENT_AXES_LEN] = LO_UINT16(delta);
+    sensorData[MOVEMENT_AXES_LEN + 1] = HI_UINT16(delta);
+    sensorData[MOVEMENT_AXES_LEN + 2] = range;
+
+    Movement_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, sensorData);
+    return;
+  }
+
+  if (batchCount > 0 && range != batchRange)
+  {
+    batchFlush();
+  }
+
+  if (batchCount == 0)
+  {
+    // Range and base time stamp
+    batchRange = range;
+    batchData[2] = range;
+    batchData[3] = BREAK_UINT32(timestamp, 0);
+    batchData[4] = BREAK_UINT32(timestamp, 1);
+    batchData[5] = BREAK_UINT32(timestamp, 2);
+    batchData[6] = BREAK_UINT32(timestamp, 3);
+    batchLen = MOVEMENT_BATCH_HDR_LEN;
+    delta = 0;
+  }
+  else
+  {
+    // Difference of the short time stamps, so that deltas add up exactly
+    delta = (timestamp >> MOVEMENT_TS_SHIFT) - (batchTime >> MOVEMENT_TS_SHIFT);
+    if (delta > MOVEMENT_TS_MASK)
+    {
+      delta = MOVEMENT_TS_MASK;
+    }
+  }
+  batchTime = timestamp;
+
+  p = &batchData[batchLen];
+  *p++ = LO_UINT16(delta);
+  *p++ = HI_UINT16(delta);
+
+  if (mpuConfig & MPU_AX_GYR)
+  {
+    memcpy(p, &sensorData[0], 6);
+    p += 6;
+  }
+  if (mpuConfig & MPU_AX_ACC)
+  {
+    memcpy(p, &sensorData[6], 6);
+    p += 6;
+  }
+  if (mpuConfig & MPU_AX_MAG)
+  {
+    memcpy(p, &sensorData[12], 6);
+    p += 6;
+  }
+
+  batchData[1] = (p - &batchData[batchLen]);
+  batchLen = p - batchData;
+  batchCount++;
+
+  if (batchCount >= batchSize)
+  {
+    batchFlush();
+  }
+}
+
+/*******************************************************************************
+ * @fn      batchFlush
+ *
+ * @brief   Send the samples of the current batch, if any
+ *
+ */
+static void batchFlush(void)
+{
+  if (batchCount > 0)
+  {
+    batchData[0] = batchCount;
+    Movement_setParameter(MOVEMENT_BATCH, batchLen, batchData);
+    batchCount = 0;
+  }
+}
+
+/*******************************************************************************
+ * @fn      batchLimit
+ *
+ * @brief   Limit the requested batch size to what fits in one notification
+ *          with the current ATT MTU and axes, so that samples are never cut
+ *          off. Batching is turned off if not even one sample fits; the
+ *          samples are then sent one by one on the data characteristic.
+ *          The characteristic shows the batch size in effect.
+ *
+ */
+static void batchLimit(void)
+{
+  uint16_t maxLen;
+  uint8_t sampleLen;
+  uint8_t maxSamples;
+  uint8_t newSize;
+
+  // Notification payload is ATT_MTU - 3
+  maxLen = attMtu - 3;
+  if (maxLen > MOVEMENT_BATCH_MAX_LEN)
+  {
+    maxLen = MOVEMENT_BATCH_MAX_LEN;
+  }
+
+  sampleLen = MOVEMENT_BATCH_DELTA_LEN;
+  if (mpuConfig & MPU_AX_GYR)
+  {
+    sampleLen += 6;
+  }
+  if (mpuConfig & MPU_AX_ACC)
+  {
+    sampleLen += 6;
+  }
+  if (mpuConfig & MPU_AX_MAG)
+  {
+    sampleLen += 6;
+  }
+
+  maxSamples = maxLen > MOVEMENT_BATCH_HDR_LEN ?
+    (maxLen - MOVEMENT_BATCH_HDR_LEN) / sampleLen : 0;
+
+  newSize = batchRequest > maxSamples ? maxSamples : batchRequest;
+  if (newSize != batchSize)
+  {
+    batchFlush();
+    batchSize = newSize;
+  }
+
+  Movement_setParameter(MOVEMENT_BATCH_SIZE, MOVEMENT_BATCH_SIZE_LEN,
+                        &batchSize);
+}
+
+/*******************************************************************************
+ * @fn      quatUpdate
+ *
+ * @brief   Feed the current sample to the orientation filter and send the
+ *          quaternion when the output period has elapsed. Requires all
+ *          gyro and accelerometer axes; the magnetometer is optional.
+ *
+ * @param   timestamp - sample time (AON RTC)
+ *
+ */
+static void quatUpdate(uint32_t timestamp)
+{
+  int16_t quat[4];
+  int16_t mag[3];
+  int16_t *pMag;
+  uint32_t dt;
+
+  if (quatPeriod == 0 || (mpuConfig & MPU_AX_GYR) != MPU_AX_GYR ||
+      (mpuConfig & MPU_AX_ACC) != MPU_AX_ACC)
+  {
+    return;
+  }
+
+  if (!quatStarted)
+  {
+    Fusion_init();
+    quatTime = timestamp;
+    quatSentTime = timestamp;
+    quatStarted = true;
+    return;
+  }
+
+  pMag = NULL;
+  if (mpuConfig & MPU_AX_MAG)
+  {
+    int16_t *pRaw = (int16_t*)&sensorData[12];
+
+    // Compass axes are X/Y swapped and Z inverted relative to the MPU
+    mag[0] = pRaw[1];
+    mag[1] = pRaw[0];
+    mag[2] = -pRaw[2];
+    pMag = mag;
+  }
+
+  dt = TS_TO_MS(timestamp - quatTime);
+  Fusion_update((int16_t*)&sensorData[0], (int16_t*)&sensorData[6], pMag,
+                dt > 0xFFFF ? 0xFFFF : (uint16_t)dt);
+  quatTime = timestamp;
+
+  if (TS_TO_MS(timestamp - quatSentTime) >= quatPeriod)
+  {
+    quatSentTime = timestamp;
+    Fusion_getQuaternion(quat);
+    Movement_setParameter(MOVEMENT_QUAT, MOVEMENT_QUAT_LEN, quat);
+  }
+}
+
+/*******************************************************************************
+ * @fn      timestampGet
+ *
+ * @brief   Current time (AON RTC, 16.16 seconds)
+ *
+ */
+static uint32_t timestampGet(void)
+{
+  return AONRTCCurrentCompareValueGet();
+}
+
+/*******************************************************************************
+ * @fn      sampleTimeGet
+ *
+ * @brief   Time of the most recent sample as latched by the data ready
+ *          interrupt; the current time if none is pending (clock paced
+ *          read-out)
+ *
+ */
+static uint32_t sampleTimeGet(void)
+{
+  uint32_t ts;
+  uint32_t latest;
+
+  latest = 0;
+  while (sensorMpu9250TimestampRead(&ts, 1) > 0)
+  {
+    latest = ts;
+  }
+
+  return latest != 0 ? latest : timestampGet();
+}
+
+/*******************************************************************************
+ * @fn      confExtApply
+ *
+ * @brief   Pass the extended configuration (gyro range, filter, bandwidth
+ *          limits, compass rate) to the MPU driver. Filters take effect at
+ *          the next start of the read-out.
+ *
+ */
+static void confExtApply(void)
+{
+  uint8_t cfg[MOVEMENT_CONF_EXT_LEN];
+
+  Movement_getParameter(MOVEMENT_CONF_EXT, cfg);
+
+  sensorMpu9250GyroSetRange(cfg[0]);
+  Fusion_setGyroScale(FUSION_GYRO_250DPS << cfg[0]);
+
+  sensorMpu9250SetBandwidth(BUILD_UINT16(cfg[2], cfg[3]),
+                            BUILD_UINT16(cfg[4], cfg[5]), cfg[1]);
+  sensorMpu9250MagSetOdr(cfg[6]);
+
+  accAutoRange = cfg[7] != 0;
+  accRangeNext = (mpuConfig & MOV_MASK_ACC_RANGE) >> 8;
+}
+
+/*******************************************************************************
+ * @fn      motionUpdate
+ *
+ * @brief   Classify the current sample as motion or rest. Motion is a gyro
+ *          rate above GYR_SHAKE_THR or an accelerometer change above the
+ *          wake-on-motion threshold; it restarts the inactivity count and
+ *          records the pause since the previous motion. At rest the
+ *          accelerometer change updates the noise floor estimate.
+ *
+ * @param   timestamp - sample time (AON RTC)
+ *
+ */
+static void motionUpdate(uint32_t timestamp)
+{
+  int16_t *pGyro = (int16_t*)&sensorData[0];
+  int16_t *pAcc = (int16_t*)&sensorData[6];
+  uint32_t gyroMax;
+  uint32_t accDelta;
+  bool motion;
+  uint8_t i;
+
+  motion = false;
+  accDelta = 0;
+
+  if ((mpuConfig & MPU_AX_GYR) == MPU_AX_GYR)
+  {
+    // Largest rate in deg/s
+    gyroMax = 0;
+    for (i = 0; i < 3; i++)
+    {
+      uint32_t v = pGyro[i] < 0 ? -pGyro[i] : pGyro[i];
+
+      if (v > gyroMax)
+      {
+        gyroMax = v;
+      }
+    }
+    gyroMax = (gyroMax * (250UL << sensorMpu9250GyroReadRange())) >> 15;
+    motion = gyroMax > GYR_SHAKE_THR;
+  }
+
+  if ((mpuConfig & MPU_AX_ACC) == MPU_AX_ACC)
+  {
+    if (accPrevValid)
+    {
+      // Largest change since the previous sample in mg
+      for (i = 0; i < 3; i++)
+      {
+        int32_t d = (int32_t)pAcc[i] - accPrev[i];
+        uint32_t v = d < 0 ? -d : d;
+
+        if (v > accDelta)
+        {
+          accDelta = v;
+        }
+      }
+      accDelta = (accDelta * (2000UL << ((mpuConfig >> 8) & 0x03))) >> 15;
+      motion = motion || accDelta > (uint32_t)movThreshold * 4;
+    }
+    memcpy(accPrev, pAcc, sizeof(accPrev));
+    accPrevValid = true;
+  }
+
+  if (motion)
+  {
+    uint32_t gap;
+
+    // Pauses within an activity set the inactivity timeout
+    gap = TS_TO_MS(timestamp - motionTime);
+    if (gap > 2UL * readoutPeriod)
+    {
+      motionGap = motionGap - (motionGap >> 2) + (gap >> 2);
+    }
+    motionTime = timestamp;
+    motionSeen = true;
+    nActivity = MOVEMENT_INACT_CYCLES;
+  }
+  else if (accPrevValid)
+  {
+    // Noise floor, exponential average (Q4)
+    accNoise = accNoise - (accNoise >> 3) + ((accDelta << 4) >> 3);
+  }
+}
+
+/*******************************************************************************
+ * @fn      motionAdapt
+ *
+ * @brief   Tune the wake-on-motion threshold and inactivity timeout at the
+ *          end of an active period. A wake-up without real motion raises
+ *          the threshold; otherwise it follows the noise floor. The
+ *          timeout is twice the typical pause between motions.
+ *
+ */
+static void motionAdapt(void)
+{
+  uint32_t thr;
+  uint32_t timeout;
+
+  if (womWake && !motionSeen)
+  {
+    // False wake-up
+    thr = movThreshold + (movThreshold >> 2) + 1;
+  }
+  else
+  {
+    // Noise floor with margin (mg to 4 mg units), move half way
+    thr = (accNoise * WOM_NOISE_MARGIN) >> 6;
+    thr = (movThreshold + thr + 1) / 2;
+  }
+
+  if (thr < WOM_THR_MIN)
+  {
+    thr = WOM_THR_MIN;
+  }
+  if (thr > WOM_THR_MAX)
+  {
+    thr = WOM_THR_MAX;
+  }
+  movThreshold = thr;
+
+  timeout = (2 * motionGap + 999) / 1000;
+  if (timeout < INACT_TIMEOUT_MIN)
+  {
+    timeout = INACT_TIMEOUT_MIN;
+  }
+  if (timeout > INACT_TIMEOUT_MAX)
+  {
+    timeout = INACT_TIMEOUT_MAX;
+  }
+  inactTimeout = timeout;
+}
+
+/*******************************************************************************
+ * @fn      stateUpdate
+ *
+ * @brief   Account the time spent in the current state and change to the
+ *          new state (which may be the same)
+ *
+ */
+static void stateUpdate(uint8_t newState)
+{
+  uint64_t now;
+  uint8_t i;
+
+  now = AONRTCCurrent64BitValueGet();
+
+  i = appState == APP_STATE_ERROR ? 3 : appState;
+  stateTime[i] += (((now - stateSince) >> 16) * 1000) >> 16;
+  stateSince = now;
+
+  appState = newState;
+  dutyPublish();
+}
+
+/*******************************************************************************
+ * @fn      dutyPublish
+ *
+ * @brief   Update the duty cycle characteristic: seconds spent in the off,
+ *          idle, active and error states, followed by the current
+ *          wake-on-motion threshold and inactivity timeout
+ *
+ */
+static void dutyPublish(void)
+{
+  uint8_t buf[MOVEMENT_DUTY_LEN];
+  uint8_t i;
+
+  for (i = 0; i < 4; i++)
+  {
+    uint32_t sec = (uint32_t)(stateTime[i] / 1000);
+
+    buf[i * 4] = BREAK_UINT32(sec, 0);
+    buf[i * 4 + 1] = BREAK_UINT32(sec, 1);
+    buf[i * 4 + 2] = BREAK_UINT32(sec, 2);
+    buf[i * 4 + 3] = BREAK_UINT32(sec, 3);
+  }
+  buf[16] = movThreshold;
+  buf[17] = inactTimeout;
+
+  Movement_setParameter(MOVEMENT_DUTY, MOVEMENT_DUTY_LEN, buf);
+}
+
+/*******************************************************************************
+ * @fn      jitterReset
+ *
+ * @brief   Restart the read-out interval statistics
+ *
+ */
+static void jitterReset(void)
+{
+  jitterStarted = false;
+  jitterCount = 0;
+  jitterPublish();
+}
+
+/*******************************************************************************
+ * @fn      jitterPublish
+ *
+ * @brief   Update the jitter characteristic: min and max interval, mean
+ *          absolute deviation from the read-out period (all us) and the
+ *          number of intervals.
+ *
+ */
+static void jitterPublish(void)
+{
+  uint8_t buf[MOVEMENT_JITTER_LEN];
+  uint32_t mean;
+  uint16_t count;
+
+  memset(buf, 0, MOVEMENT_JITTER_LEN);
+
+  count = jitterCount;
+  if (count > 0)
+  {
+    mean = jitterSumDev / count;
+    if (mean > 0xFFFF)
+    {
+      mean = 0xFFFF;
+    }
+
+    buf[0] = BREAK_UINT32(jitterMin, 0);
+    buf[1] = BREAK_UINT32(jitterMin, 1);
+    buf[2] = BREAK_UINT32(jitterMin, 2);
+    buf[3] = BREAK_UINT32(jitterMin, 3);
+    buf[4] = BREAK_UINT32(jitterMax, 0);
+    buf[5] = BREAK_UINT32(jitterMax, 1);
+    buf[6] = BREAK_UINT32(jitterMax, 2);
+    buf[7] = BREAK_UINT32(jitterMax, 3);
+    buf[8] = LO_UINT16(mean);
+    buf[9] = HI_UINT16(mean);
+    buf[10] = LO_UINT16(count);
+    buf[11] = HI_UINT16(count);
+  }
+
+  Movement_setParameter(MOVEMENT_JITTER, MOVEMENT_JITTER_LEN, buf);
+}
+
+/*******************************************************************************
+ * @fn      spectrumStart
+ *
+ * @brief   Start a new spectrum window with the configured size and input
+ *
+ */
+static void spectrumStart(void)
+{
+  uint8_t cfg[MOVEMENT_SPECTRUM_CONF_LEN];
+
+  Movement_getParameter(MOVEMENT_SPECTRUM_CONF, cfg);
+  Spectrum_init(cfg[0], cfg[1]);
+}
+
+/*******************************************************************************
+ * @fn      spectrumUpdate
+ *
+ * @brief   Add the current accelerometer sample to the spectrum window and
+ *          send the peaks and band levels when the window is complete.
+ *          Bins are spaced by the sample rate (FIFO rate or 1 / period)
+ *          divided by the window size.
+ *
+ */
+static void spectrumUpdate(void)
+{
+  SpectrumResult_t result;
+  uint8_t buf[MOVEMENT_SPECTRUM_LEN];
+  uint8_t *p;
+  uint8_t i;
+
+  if ((mpuConfig & MPU_AX_ACC) != MPU_AX_ACC ||
+      !Spectrum_addSample((int16_t*)&sensorData[6]))
+  {
+    return;
+  }
+
+  Spectrum_compute(&result);
+
+  p = buf;
+  for (i = 0; i < SPECTRUM_PEAKS; i++)
+  {
+    *p++ = (uint8_t)result.peakBin[i];
+    *p++ = LO_UINT16(result.peakMag[i]);
+    *p++ = HI_UINT16(result.peakMag[i]);
+  }
+  for (i = 0; i < SPECTRUM_BANDS; i++)
+  {
+    *p++ = LO_UINT16(result.bandRms[i]);
+    *p++ = HI_UINT16(result.bandRms[i]);
+  }
+
+  Movement_setParameter(MOVEMENT_SPECTRUM, MOVEMENT_SPECTRUM_LEN, buf);
+}
+
+/*******************************************************************************
+ * @fn      accRangeSet
+ *
+ * @brief   Select the accelerometer range and show it in the configuration
+ *          characteristic. Samples taken before and after the change are
+ *          not compared.
+ *
+ * @param   range - ACC_RANGE_2G .. ACC_RANGE_16G
+ *
+ */
+static void accRangeSet(uint8_t range)
+{
+  if (sensorMpu9250AccSetRange(range) &&
+      range != ((mpuConfig & MOV_MASK_ACC_RANGE) >> 8))
+  {
+    mpuConfig = (mpuConfig & ~MOV_MASK_ACC_RANGE) | (range << 8);
+    Movement_setParameter(SENSOR_CONF, sizeof(mpuConfig), (uint8_t*)&mpuConfig);
+
+    accPrevValid = false;
+    spectrumStart();
+  }
+
+  accRangeNext = (mpuConfig & MOV_MASK_ACC_RANGE) >> 8;
+  accLowTime = timestampGet();
+}
+
+/*******************************************************************************
+ * @fn      accRangeUpdate
+ *
+ * @brief   Select the accelerometer range for the next read-out when auto
+ *          ranging: a wider range as soon as a sample nears full scale, a
+ *          narrower one when the amplitude has stayed low for ACC_LOW_TIME.
+ *
+ * @param   timestamp - sample time (AON RTC)
+ *
+ */
+static void accRangeUpdate(uint32_t timestamp)
+{
+  int16_t *pAcc = (int16_t*)&sensorData[6];
+  uint8_t range;
+  uint16_t peak;
+  uint8_t i;
+
+  if (!accAutoRange || (mpuConfig & MPU_AX_ACC) != MPU_AX_ACC)
+  {
+    return;
+  }
+
+  peak = 0;
+  for (i = 0; i < 3; i++)
+  {
+    uint16_t v = pAcc[i] < 0 ? -pAcc[i] : pAcc[i];
+
+    if (v > peak)
+    {
+      peak = v;
+    }
+  }
+
+  range = (mpuConfig & MOV_MASK_ACC_RANGE) >> 8;
+
+  if (peak >= ACC_SAT_LEVEL)
+  {
+    if (range < ACC_RANGE_16G)
+    {
+      accRangeNext = range + 1;
+    }
+    accLowTime = timestamp;
+  }
+  else if (peak >= ACC_LOW_LEVEL)
+  {
+    accLowTime = timestamp;
+  }
+  else if (range > ACC_RANGE_2G && accRangeNext == range &&
+           TS_TO_MS(timestamp - accLowTime) >= ACC_LOW_TIME)
+  {
+    accRangeNext = range - 1;
+  }
+}
+
+/*******************************************************************************
+ * @fn      accRangeApply
+ *
+ * @brief   Switch to the range selected during the last read-out. Samples
+ *          are tagged with the range in use when they are read, so the
+ *          range only changes between read-outs.
+ *
+ */
+static void accRangeApply(void)
+{
+  if (accAutoRange && accRangeNext != ((mpuConfig & MOV_MASK_ACC_RANGE) >> 8))
+  {
+    accRangeSet(accRangeNext);
+  }
+}
+
+/*******************************************************************************
+ * @fn      calApply
+ *
+ * @brief   Correct a new sample with the calibration table: gyroscope bias
+ *          and magnetometer hard-iron offset. Applied once per read-out,
+ *          before the sample is used or sent.
+ *
+ * @param   axes - MPU_AX_GYR and/or MPU_AX_MAG
+ *
+ */
+static void calApply(uint8_t axes)
+{
+  const SensorTagCal_t *pCal;
+  int16_t *pData;
+  uint8_t i;
+
+  pCal = SensorTagCal_get();
+  pData = (int16_t*)sensorData;
+
+  if (axes & MPU_AX_GYR)
+  {
+    int16_t bias[3];
+
+    SensorTagCal_gyroBias(bias, sensorMpu9250GyroReadRange());
+    for (i = 0; i < 3; i++)
+    {
+      pData[i] = SensorTagCal_subtract(pData[i], bias[i]);
+    }
+  }
+
+  if (axes & MPU_AX_MAG)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      pData[6 + i] = SensorTagCal_subtract(pData[6 + i], pCal->magOffset[i]);
+    }
   }
 }
 
@@ -89,6 +89,11 @@ extern void SensorTagMov_reset(void);
  */
 extern void SensorTagMov_processInterrupt(void);
 
+/*
+ * Set the ATT MTU of the connection (limits the batch size)
+ */
+extern void SensorTagMov_setMtu(uint16_t mtu);
+
 /*********************************************************************
 *********************************************************************/
 
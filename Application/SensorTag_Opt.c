@@ -49,8 +49,10 @@
 
 #include "opticservice.h"
 #include "SensorTag_Opt.h"
+#include "SensorTag_Sched.h"
 #include "sensor_opt3001.h"
 #include "sensor.h"
+#include "bsp_i2c.h"
 #include "Board.h"
 #include "util.h"
 #include "string.h"
@@ -98,6 +100,20 @@ static uint8_t sensorConfig;
 static uint16_t sensorPeriod;
 static bool sensorReadScheduled;
 
+// End-of-conversion interrupt: available / period elapsed, publish next result
+static bool sensorIntMode;
+static bool sensorPublishDue;
+
+// Send-on-change: window width (percent, 0 = off) / window programmed
+static uint8_t sensorWindow;
+static bool sensorWindowArmed;
+
+// Read-out queued as an I2C batch, so the task does not wait for the bus
+static bspI2cBatchOp_t readOps[OPT3001_BATCH_OPS];
+static uint16_t readRegs[OPT3001_BATCH_OPS];
+static bool readPending;
+static volatile bool readDone;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -105,6 +121,10 @@ static void sensorConfigChangeCB(uint8_t paramID);
 static void initCharacteristicValue(uint8_t paramID, uint8_t value, 
                                     uint8_t paramLen);
 static void SensorTagOpt_clockHandler(UArg arg);
+static void sensorWindowArm(uint16_t rawData);
+static void sensorWindowDisarm(void);
+static void sensorPublish(uint16_t data, bool success);
+static void sensorReadCB(bspI2cBatchOp_t *ops, uint8_t nOps, uint8_t nFailed);
 
 /*********************************************************************
  * PROFILE CALLBACKS
@@ -140,6 +160,8 @@ void SensorTagOpt_init(void)
   // Initialize the module state variables
   sensorPeriod = SENSOR_DEFAULT_PERIOD;
   sensorReadScheduled = false;
+  readPending = false;
+  readDone = false;
   SensorTagOpt_reset();
   initCharacteristicValue(SENSOR_PERI, 
                           SENSOR_DEFAULT_PERIOD / SENSOR_PERIOD_RESOLUTION, 
@@ -147,11 +169,18 @@ void SensorTagOpt_init(void)
   
   // Initialize the driver
   sensorOpt3001Init();
+  sensorIntMode =
+    sensorOpt3001RegisterCallback(SensorTagOpt_processInterrupt);
+  if (sensorIntMode)
+  {
+    sensorOpt3001SetConversionTime(sensorPeriod);
+  }
   sensorOpt3001Enable(false); 
   
   // Create one-shot clocks for internal periodic events.
   Util_constructClock(&periodicClock, SensorTagOpt_clockHandler,
                       100, sensorPeriod, false, 0);
+  SensorTagSched_registerClock(SCHED_CLOCK_OPT, &periodicClock, sensorPeriod);
 }
 
 /*********************************************************************
@@ -184,6 +213,7 @@ void SensorTagOpt_processCharChangeEvt(uint8_t paramID)
         if (sensorConfig != ST_CFG_SENSOR_DISABLE)
         {
           Util_stopClock(&periodicClock);
+          sensorWindowDisarm();
           sensorOpt3001Enable(false); // Disable the sensor
           initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
         }
@@ -192,8 +222,9 @@ void SensorTagOpt_processCharChangeEvt(uint8_t paramID)
       {
         if (sensorConfig == ST_CFG_SENSOR_DISABLE)
         {
+          sensorPublishDue = true;
           sensorOpt3001Enable(true);
-          Util_startClock(&periodicClock);
+          SensorTagSched_startClock(SCHED_CLOCK_OPT);
         }
       }
       
@@ -209,7 +240,34 @@ void SensorTagOpt_processCharChangeEvt(uint8_t paramID)
   case SENSOR_PERI:
     Optic_getParameter(SENSOR_PERI, &newValue);
     sensorPeriod = newValue * SENSOR_PERIOD_RESOLUTION;
-    Util_rescheduleClock(&periodicClock,sensorPeriod);
+    SensorTagSched_setClockPeriod(SCHED_CLOCK_OPT, sensorPeriod);
+    if (sensorIntMode)
+    {
+      // Fewer conversions (and interrupts) for long periods
+      sensorOpt3001SetConversionTime(sensorPeriod);
+    }
+    break;
+    
+  case OPTIC_WINDOW:
+    Optic_getParameter(OPTIC_WINDOW, &newValue);
+    sensorWindow = newValue;
+    if (sensorWindowArmed)
+    {
+      if (sensorWindow > 0)
+      {
+        uint16_t data;
+        
+        // Re-center the new window on the last reported value
+        Optic_getParameter(SENSOR_DATA, &data);
+        sensorWindowArm(data);
+      }
+      else
+      {
+        // Back to periodic reporting
+        sensorWindowDisarm();
+        SensorTagSched_startClock(SCHED_CLOCK_OPT);
+      }
+    }
     break;
     
   default:
@@ -232,12 +290,16 @@ void SensorTagOpt_reset (void)
 {
   sensorConfig = ST_CFG_SENSOR_DISABLE;
   sensorPeriod = SENSOR_DEFAULT_PERIOD;
+  sensorWindow = 0;
+  sensorWindowArmed = false;
   initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
+  initCharacteristicValue(OPTIC_WINDOW, 0, OPTIC_WINDOW_LEN);
   initCharacteristicValue(SENSOR_CONF, ST_CFG_SENSOR_DISABLE, 
                           sizeof ( uint8_t ));
 
   if ( (sensorTestResult() & ST_LIGHT) > 0)
   {
+    sensorOpt3001SetWindow(0, 0);
     sensorOpt3001Enable(false); // Disable the sensor
   }
 }
@@ -256,13 +318,118 @@ void SensorTagOpt_reset (void)
  */
 void SensorTagOpt_processSensorEvent(void)
 {
+  uint16_t data;
+  bool success;
+
+  if (readDone)
+  {
+    // Batched read-out completed
+    readDone = false;
+    readPending = false;
+
+    success = sensorOpt3001ReadDone(readOps, readRegs, &data);
+    if (sensorConfig == ST_CFG_SENSOR_ENABLE)
+    {
+      sensorPublish(data, success);
+    }
+  }
+
   if (sensorReadScheduled)
   {
-    uint16_t data;
+    sensorReadScheduled = false;
     
-    sensorOpt3001Read(&data);
+    if (sensorWindowArmed)
+    {
+      // Only a light level outside the window is reported
+      if (sensorOpt3001ReadWindow(&data))
+      {
+        Optic_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, &data);
+        sensorWindowArm(data);
+      }
+      return;
+    }
+    
+    if (readPending)
+    {
+      // The previous read-out is still on the bus
+      return;
+    }
+
+    // Queue the read-out; the result is processed when the batch is done
+    sensorOpt3001ReadBatch(readOps, readRegs);
+    if (bspI2cBatchSubmit(BSP_I2C_INTERFACE_0, readOps, OPT3001_BATCH_OPS,
+                          sensorReadCB))
+    {
+      readPending = true;
+      return;
+    }
+
+    // Bus not available for a batch, read synchronously
+    success = sensorOpt3001Read(&data);
+    sensorPublish(data, success);
+  }
+}
+
+
+/*********************************************************************
+ * @fn      sensorPublish
+ *
+ * @brief   Publish a light reading
+ *
+ * @param   data - raw sensor data
+ * @param   success - true if the data is valid
+ *
+ * @return  none
+ */
+static void sensorPublish(uint16_t data, bool success)
+{
+  // With the end-of-conversion interrupt every conversion is read (this
+  // releases INT), but the result is published only once per period.
+  if (!sensorIntMode || (success && sensorPublishDue))
+  {
     Optic_setParameter(SENSOR_DATA, SENSOR_DATA_LEN, &data);
-    sensorReadScheduled = false;
+    sensorPublishDue = false;
+
+    if (success && sensorWindow > 0)
+    {
+      // Report from now on only when the light level changes
+      sensorWindowArm(data);
+    }
+  }
+}
+
+
+/*********************************************************************
+ * @fn      sensorReadCB
+ *
+ * @brief   Completion of the batched read-out (Hwi context)
+ *
+ * @param   ops - batch entries
+ * @param   nOps - number of entries
+ * @param   nFailed - number of failed entries
+ *
+ * @return  none
+ */
+static void sensorReadCB(bspI2cBatchOp_t *ops, uint8_t nOps, uint8_t nFailed)
+{
+  readDone = true;
+  Semaphore_post(sem);
+}
+
+
+/*********************************************************************
+ * @fn      SensorTagOpt_processInterrupt
+ *
+ * @brief   Interrupt handler for OPT3001 end-of-conversion
+ *
+ */
+void SensorTagOpt_processInterrupt(void)
+{
+  if (sensorConfig == ST_CFG_SENSOR_ENABLE)
+  {
+    // Wake up the application, the result is ready.
+    sensorReadScheduled = true;
+    Semaphore_post(sem);
   }
 }
 
@@ -280,13 +447,64 @@ static void SensorTagOpt_clockHandler(UArg arg)
 { 
   if (sensorConfig == ST_CFG_SENSOR_ENABLE)
   {
-    // Wake up the application.
-    sensorReadScheduled = true;
-    Semaphore_post(sem);
+    if (sensorIntMode)
+    {
+      // Publish the next conversion, no need to wake the application
+      sensorPublishDue = true;
+    }
+    else
+    {
+      // Wake up the application.
+      sensorReadScheduled = true;
+      SensorTagSched_countEvent();
+      Semaphore_post(sem);
+    }
+  }
+}
+
+
+/*********************************************************************
+ * @fn      sensorWindowArm
+ *
+ * @brief   Program the send-on-change window around a reported value.
+ *          With the end-of-conversion interrupt the periodic clock is
+ *          stopped; the sensor wakes the application when the light
+ *          level leaves the window.
+ *
+ * @param   rawData - last reported value
+ *
+ * @return  none
+ */
+static void sensorWindowArm(uint16_t rawData)
+{
+  sensorOpt3001SetWindow(rawData, sensorWindow);
+  sensorWindowArmed = true;
+  
+  if (sensorIntMode)
+  {
+    Util_stopClock(&periodicClock);
   }
 }
 
 
+/*********************************************************************
+ * @fn      sensorWindowDisarm
+ *
+ * @brief   Return to end-of-conversion reporting, the next result is
+ *          published
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void sensorWindowDisarm(void)
+{
+  sensorOpt3001SetWindow(0, 0);
+  sensorWindowArmed = false;
+  sensorPublishDue = true;
+}
+
+
 /*********************************************************************
  * @fn      sensorConfigChangeCB
  *
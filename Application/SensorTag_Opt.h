@@ -77,6 +77,11 @@ extern void SensorTagOpt_processCharChangeEvt(uint8_t paramID);
  */
 extern void SensorTagOpt_processSensorEvent( void);
 
+/*
+ * Handler for OPT3001 end-of-conversion interrupt
+ */
+extern void SensorTagOpt_processInterrupt( void);
+
 /*
  * Task Event Processor for the BLE Application
  */
@@ -0,0 +1,758 @@
+/*******************************************************************************
+  Filename:       SensorTag_Sched.c
+
+  Description:    This file contains the Sensor Tag sample application,
+                  cooperative scheduler for the sensors that are read out in
+                  several steps (start conversion, wait, read, publish),
+                  and alignment of the sensor sampling to a common time base.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+/*********************************************************************
+ * INCLUDES
+ */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Swi.h>
+
+#include "bcomdef.h"
+#include "SensorTag.h"
+#include "SensorTag_Sched.h"
+#include "util.h"
+#include "string.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Convert milliseconds to clock ticks
+#define MS_TO_TICKS(ms)         ((ms) * (1000 / Clock_tickPeriod))
+
+// Grid interval (clock ticks)
+#define GRID_TICKS              MS_TO_TICKS(SCHED_GRID)
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Statistics interval (ms)
+#define STATS_INTERVAL          1000
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  SchedCB_t pfn;                // Step function
+  uint32_t due;                 // Time of the next step (clock ticks)
+  uint32_t start;               // Start of the current period (clock ticks)
+  bool active;                  // Step pending
+  bool periodic;                // Pending step starts a new period
+  bool running;                 // Start of the current period is valid
+  volatile bool triggered;      // Step requested from interrupt
+} SchedClient_t;
+
+typedef struct
+{
+  Clock_Struct *pClock;         // Periodic clock of the sensor
+  uint32_t period;              // Requested period (ms)
+} SchedClock_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// One clock serves all clients, it expires at the earliest pending step
+static Clock_Struct schedClock;
+static volatile bool schedExpired;
+
+static SchedClient_t clients[SCHED_NUM_CLIENTS];
+
+// Sensors with their own periodic clock
+static SchedClock_t clocks[SCHED_NUM_CLOCKS];
+
+// Steps are running, the clock is updated when they are done
+static bool schedRunning;
+
+// Sampling mode
+static uint8_t schedMode;
+
+// A grid boundary at or before the current time. The tick count wraps at
+// 2^32, which is not a multiple of the grid, so the grid is counted from
+// here and not from zero.
+static uint32_t gridOrigin;
+
+// Wake-up statistics: clock expiries since the last wake-up, and the
+// wake-ups saved in the current interval
+static volatile uint16_t statPending;
+static uint32_t statSavedSum;
+static uint32_t statStart;
+static uint16_t statSaved;
+static bool statUpdated;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void SensorTagSched_clockHandler(UArg arg);
+static void schedUpdateClock(void);
+static void schedApplyClock(uint8_t id);
+static void schedUpdateGrid(void);
+static uint32_t schedGridCeil(uint32_t t);
+static void schedUpdateStats(uint16_t events);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      SensorTagSched_init
+ *
+ * @brief   Initialize the sensor scheduler
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void SensorTagSched_init(void)
+{
+  memset(clients, 0, sizeof(clients));
+  memset(clocks, 0, sizeof(clocks));
+  schedExpired = false;
+  schedRunning = false;
+  schedMode = SCHED_MODE_FREE;
+  gridOrigin = Clock_getTicks();
+
+  statPending = 0;
+  statSavedSum = 0;
+  statStart = Clock_getTicks();
+  statSaved = 0;
+  statUpdated = false;
+
+  // One-shot clock, the time-out is set for each step
+  Util_constructClock(&schedClock, SensorTagSched_clockHandler,
+                      1, 0, false, 0);
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_register
+ *
+ * @brief   Register the step function of a client
+ *
+ * @param   id - client identifier (SCHED_ID_x)
+ *
+ * @param   pfn - step function
+ *
+ * @return  none
+ */
+void SensorTagSched_register(uint8_t id, SchedCB_t pfn)
+{
+  if (id < SCHED_NUM_CLIENTS)
+  {
+    clients[id].pfn = pfn;
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_start
+ *
+ * @brief   Run the step function of a client once, after a delay.
+ *          A pending step is replaced.
+ *
+ * @param   id - client identifier (SCHED_ID_x)
+ *
+ * @param   delay - time until the step (ms)
+ *
+ * @return  none
+ */
+void SensorTagSched_start(uint8_t id, uint32_t delay)
+{
+  if (id < SCHED_NUM_CLIENTS)
+  {
+    clients[id].due = Clock_getTicks() + MS_TO_TICKS(delay);
+    clients[id].active = true;
+    clients[id].periodic = false;
+
+    if (!schedRunning)
+    {
+      schedUpdateClock();
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_startPeriod
+ *
+ * @brief   Run the step function of a client at the start of the next
+ *          period, counted from the start of the current one. The first
+ *          period starts at once. In aligned mode the period is rounded
+ *          up to the grid and periods start on a grid boundary.
+ *
+ * @param   id - client identifier (SCHED_ID_x)
+ *
+ * @param   period - sampling period (ms)
+ *
+ * @return  none
+ */
+void SensorTagSched_startPeriod(uint8_t id, uint32_t period)
+{
+  if (id < SCHED_NUM_CLIENTS)
+  {
+    SchedClient_t *pClient = &clients[id];
+    uint32_t now;
+    uint32_t due;
+
+    now = Clock_getTicks();
+    due = now;
+
+    if (pClient->running)
+    {
+      due = pClient->start + MS_TO_TICKS(SensorTagSched_alignPeriod(period));
+
+      // Period already over (e.g. shortened)
+      if ((int32_t)(due - now) < 0)
+      {
+        due = now;
+      }
+    }
+
+    if (schedMode == SCHED_MODE_ALIGNED)
+    {
+      due = schedGridCeil(due);
+    }
+
+    pClient->due = due;
+    pClient->active = true;
+    pClient->periodic = true;
+
+    if (!schedRunning)
+    {
+      schedUpdateClock();
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_stop
+ *
+ * @brief   Cancel a pending step of a client
+ *
+ * @param   id - client identifier (SCHED_ID_x)
+ *
+ * @return  none
+ */
+void SensorTagSched_stop(uint8_t id)
+{
+  if (id < SCHED_NUM_CLIENTS)
+  {
+    clients[id].active = false;
+    clients[id].running = false;
+    clients[id].triggered = false;
+
+    if (!schedRunning)
+    {
+      schedUpdateClock();
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_trigger
+ *
+ * @brief   Run the step function of a client as soon as possible,
+ *          replacing a pending step. May be called from interrupts.
+ *
+ * @param   id - client identifier (SCHED_ID_x)
+ *
+ * @return  none
+ */
+void SensorTagSched_trigger(uint8_t id)
+{
+  if (id < SCHED_NUM_CLIENTS)
+  {
+    clients[id].triggered = true;
+
+    // Wake up the application thread
+    Semaphore_post(sem);
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_registerClock
+ *
+ * @brief   Register the periodic clock of a sensor that is not a client,
+ *          so that it follows the sampling mode
+ *
+ * @param   id - clock identifier (SCHED_CLOCK_x)
+ *
+ * @param   pClock - periodic clock
+ *
+ * @param   period - sampling period (ms)
+ *
+ * @return  none
+ */
+void SensorTagSched_registerClock(uint8_t id, Clock_Struct *pClock,
+                                  uint32_t period)
+{
+  if (id < SCHED_NUM_CLOCKS)
+  {
+    clocks[id].pClock = pClock;
+    clocks[id].period = period;
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_setClockPeriod
+ *
+ * @brief   Change the period of a registered clock. A running clock is
+ *          restarted (on a grid boundary in aligned mode).
+ *
+ * @param   id - clock identifier (SCHED_CLOCK_x)
+ *
+ * @param   period - sampling period (ms)
+ *
+ * @return  none
+ */
+void SensorTagSched_setClockPeriod(uint8_t id, uint32_t period)
+{
+  if (id < SCHED_NUM_CLOCKS && clocks[id].pClock != NULL)
+  {
+    clocks[id].period = period;
+    schedApplyClock(id);
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_startClock
+ *
+ * @brief   Start a registered clock (on a grid boundary in aligned mode)
+ *
+ * @param   id - clock identifier (SCHED_CLOCK_x)
+ *
+ * @return  none
+ */
+void SensorTagSched_startClock(uint8_t id)
+{
+  if (id < SCHED_NUM_CLOCKS && clocks[id].pClock != NULL)
+  {
+    Clock_Handle handle;
+
+    handle = Clock_handle(clocks[id].pClock);
+    if (schedMode == SCHED_MODE_ALIGNED)
+    {
+      Clock_stop(handle);
+      schedApplyClock(id);
+    }
+    Clock_start(handle);
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_countEvent
+ *
+ * @brief   Count a timed sensor event for the wake-up statistics.
+ *          Called from the clock handlers of the registered clocks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void SensorTagSched_countEvent(void)
+{
+  statPending++;
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_setMode
+ *
+ * @brief   Select free running or aligned sampling. Registered clocks
+ *          are restarted, clients follow from their next period.
+ *
+ * @param   mode - SCHED_MODE_FREE or SCHED_MODE_ALIGNED
+ *
+ * @return  none
+ */
+void SensorTagSched_setMode(uint8_t mode)
+{
+  uint8_t id;
+
+  if (mode >= SCHED_NUM_MODES || mode == schedMode)
+  {
+    return;
+  }
+
+  schedMode = mode;
+
+  for (id = 0; id < SCHED_NUM_CLOCKS; id++)
+  {
+    if (clocks[id].pClock != NULL)
+    {
+      schedApplyClock(id);
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_getMode
+ *
+ * @brief   Get the sampling mode
+ *
+ * @param   none
+ *
+ * @return  SCHED_MODE_FREE or SCHED_MODE_ALIGNED
+ */
+uint8_t SensorTagSched_getMode(void)
+{
+  return schedMode;
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_alignPeriod
+ *
+ * @brief   Get the period that is used for a requested period; in
+ *          aligned mode it is rounded up to a multiple of the grid.
+ *
+ * @param   period - requested period (ms)
+ *
+ * @return  period in use (ms)
+ */
+uint32_t SensorTagSched_alignPeriod(uint32_t period)
+{
+  if (schedMode == SCHED_MODE_ALIGNED)
+  {
+    period = ((period + SCHED_GRID - 1) / SCHED_GRID) * SCHED_GRID;
+  }
+
+  return period;
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_getWakesSaved
+ *
+ * @brief   Get the number of wake-ups per second that were saved by
+ *          serving several sensor events in one wake-up
+ *
+ * @param   pSaved - wake-ups saved per second
+ *
+ * @return  true if updated since the last call
+ */
+bool SensorTagSched_getWakesSaved(uint16_t *pSaved)
+{
+  bool updated;
+
+  updated = statUpdated;
+  statUpdated = false;
+  *pSaved = statSaved;
+
+  return updated;
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_processEvent
+ *
+ * @brief   Run the steps that are due, then set the clock to the
+ *          earliest pending step
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void SensorTagSched_processEvent(void)
+{
+  uint32_t now;
+  uint16_t events;
+  uint8_t id;
+  bool expired;
+  UInt key;
+
+  expired = schedExpired;
+  schedExpired = false;
+
+  now = Clock_getTicks();
+  schedRunning = true;
+  schedUpdateGrid();
+
+  // Clock expiries of the registered clocks since the last wake-up
+  key = Swi_disable();
+  events = statPending;
+  statPending = 0;
+  Swi_restore(key);
+
+  for (id = 0; id < SCHED_NUM_CLIENTS; id++)
+  {
+    SchedClient_t *pClient = &clients[id];
+    bool run;
+    bool due;
+
+    due = expired && pClient->active && (int32_t)(pClient->due - now) <= 0;
+    run = pClient->triggered || due;
+
+    if (run && pClient->pfn != NULL)
+    {
+      if (due)
+      {
+        events++;
+      }
+
+      if (pClient->periodic)
+      {
+        // Count the next period from the scheduled start, not from now
+        pClient->start = pClient->due;
+        pClient->running = true;
+        pClient->periodic = false;
+      }
+
+      pClient->triggered = false;
+      pClient->active = false;
+
+      // The step may schedule the next one
+      pClient->pfn();
+    }
+  }
+
+  schedRunning = false;
+  schedUpdateClock();
+  schedUpdateStats(events);
+}
+
+/*********************************************************************
+* Private functions
+*/
+
+/*********************************************************************
+ * @fn      schedUpdateClock
+ *
+ * @brief   Set the clock to expire at the earliest pending step. In
+ *          aligned mode the steps that are due within the slack of the
+ *          earliest step are served in the same wake-up.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void schedUpdateClock(void)
+{
+  Clock_Handle handle;
+  uint32_t now;
+  int32_t timeout;
+  bool pending;
+  uint8_t id;
+
+  handle = Clock_handle(&schedClock);
+  Clock_stop(handle);
+
+  now = Clock_getTicks();
+  timeout = INT32_MAX;
+  pending = false;
+
+  for (id = 0; id < SCHED_NUM_CLIENTS; id++)
+  {
+    if (clients[id].active)
+    {
+      int32_t remaining;
+
+      remaining = (int32_t)(clients[id].due - now);
+      if (remaining < timeout)
+      {
+        timeout = remaining;
+      }
+      pending = true;
+    }
+  }
+
+  if (pending && schedMode == SCHED_MODE_ALIGNED)
+  {
+    int32_t latest;
+
+    latest = timeout;
+    for (id = 0; id < SCHED_NUM_CLIENTS; id++)
+    {
+      if (clients[id].active)
+      {
+        int32_t remaining;
+
+        remaining = (int32_t)(clients[id].due - now);
+        if (remaining > latest && remaining - timeout <= MS_TO_TICKS(SCHED_SLACK))
+        {
+          latest = remaining;
+        }
+      }
+    }
+    timeout = latest;
+  }
+
+  if (pending)
+  {
+    // Steps already due run on the next tick
+    Clock_setTimeout(handle, timeout > 0 ? timeout : 1);
+    Clock_start(handle);
+  }
+}
+
+/*********************************************************************
+ * @fn      schedApplyClock
+ *
+ * @brief   Set the period of a registered clock for the sampling mode.
+ *          A running clock is restarted, in aligned mode on the next
+ *          grid boundary so that all clocks expire together.
+ *
+ * @param   id - clock identifier (SCHED_CLOCK_x)
+ *
+ * @return  none
+ */
+static void schedApplyClock(uint8_t id)
+{
+  Clock_Handle handle;
+  uint32_t period;
+  uint32_t timeout;
+  bool running;
+
+  handle = Clock_handle(clocks[id].pClock);
+  running = Clock_isActive(handle);
+
+  if (running)
+  {
+    Clock_stop(handle);
+  }
+
+  period = MS_TO_TICKS(SensorTagSched_alignPeriod(clocks[id].period));
+  timeout = period;
+
+  if (schedMode == SCHED_MODE_ALIGNED)
+  {
+    uint32_t now;
+
+    now = Clock_getTicks() + 1;
+    timeout = schedGridCeil(now) - now + 1;
+  }
+
+  Clock_setTimeout(handle, timeout);
+  Clock_setPeriod(handle, period);
+
+  if (running)
+  {
+    Clock_start(handle);
+  }
+}
+
+/*********************************************************************
+ * @fn      schedUpdateGrid
+ *
+ * @brief   Move the grid origin to the last grid boundary, so that the
+ *          time since the origin never wraps.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void schedUpdateGrid(void)
+{
+  uint32_t elapsed;
+
+  elapsed = Clock_getTicks() - gridOrigin;
+  gridOrigin += elapsed - elapsed % GRID_TICKS;
+}
+
+/*********************************************************************
+ * @fn      schedGridCeil
+ *
+ * @brief   Round a time up to the next grid boundary
+ *
+ * @param   t - time, not before the current time (clock ticks)
+ *
+ * @return  time of the grid boundary (clock ticks)
+ */
+static uint32_t schedGridCeil(uint32_t t)
+{
+  uint32_t offset;
+
+  schedUpdateGrid();
+
+  offset = (t - gridOrigin) % GRID_TICKS;
+
+  return offset > 0 ? t + GRID_TICKS - offset : t;
+}
+
+/*********************************************************************
+ * @fn      schedUpdateStats
+ *
+ * @brief   Count the wake-ups saved by serving several timed sensor events
+ *          in one wake-up; once per interval convert to a rate.
+ *
+ * @param   events - timed sensor events served by this wake-up
+ *
+ * @return  none
+ */
+static void schedUpdateStats(uint16_t events)
+{
+  uint32_t now;
+  uint32_t elapsed;
+
+  if (events > 1)
+  {
+    statSavedSum += events - 1;
+  }
+
+  now = Clock_getTicks();
+  elapsed = (now - statStart) / MS_TO_TICKS(1);
+
+  if (elapsed >= STATS_INTERVAL)
+  {
+    uint32_t saved;
+
+    saved = (statSavedSum * 1000) / elapsed;
+    statSaved = saved > 0xFFFF ? 0xFFFF : (uint16_t)saved;
+    statUpdated = true;
+
+    statSavedSum = 0;
+    statStart = now;
+  }
+}
+
+/*********************************************************************
+ * @fn      SensorTagSched_clockHandler
+ *
+ * @brief   Handler function for clock time-outs.
+ *
+ * @param   arg - not used
+ *
+ * @return  none
+ */
+static void SensorTagSched_clockHandler(UArg arg)
+{
+  schedExpired = true;
+
+  // Wake up the application thread
+  Semaphore_post(sem);
+}
+
+
+/*********************************************************************
+*********************************************************************/
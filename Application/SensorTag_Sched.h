@@ -0,0 +1,180 @@
+/*******************************************************************************
+  Filename:       SensorTag_Sched.h
+
+  Description:    This file contains the Sensor Tag sample application,
+                  cooperative scheduler for the sensors that are read out in
+                  several steps (start conversion, wait, read, publish),
+                  and alignment of the sensor sampling to a common time base.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef SENSORTAGSCHED_H
+#define SENSORTAGSCHED_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stdint.h"
+#include "stdbool.h"
+#include <ti/sysbios/knl/Clock.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Scheduler clients (sensors without their own clock)
+#define SCHED_ID_TMP            0
+#define SCHED_ID_HUM            1
+#define SCHED_ID_BAR            2
+#define SCHED_NUM_CLIENTS       3
+
+// Client states: waiting for the next period, for a conversion, or for a
+// batched read-out
+#define SCHED_STATE_IDLE        0
+#define SCHED_STATE_CONVERTING  1
+#define SCHED_STATE_READING     2
+
+// Sensors with their own periodic clock
+#define SCHED_CLOCK_MOV         0
+#define SCHED_CLOCK_OPT         1
+#define SCHED_NUM_CLOCKS        2
+
+// Sampling modes: each sensor on its own phase, or all periods on a
+// common grid so that the reads are done in one wake-up
+#define SCHED_MODE_FREE         0
+#define SCHED_MODE_ALIGNED      1
+#define SCHED_NUM_MODES         2
+
+// Aligned mode: grid (ms), and the time (ms) a step may be postponed to
+// share the wake-up of a later step
+#define SCHED_GRID              100
+#define SCHED_SLACK             20
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Client step function, runs in the application task
+typedef void (*SchedCB_t)(void);
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Initialize the sensor scheduler
+ */
+extern void SensorTagSched_init(void);
+
+/*
+ * Register the step function of a client
+ */
+extern void SensorTagSched_register(uint8_t id, SchedCB_t pfn);
+
+/*
+ * Run the step function of a client once, after a delay (ms)
+ */
+extern void SensorTagSched_start(uint8_t id, uint32_t delay);
+
+/*
+ * Run the step function of a client at the start of the next period (ms)
+ */
+extern void SensorTagSched_startPeriod(uint8_t id, uint32_t period);
+
+/*
+ * Cancel a pending step of a client
+ */
+extern void SensorTagSched_stop(uint8_t id);
+
+/*
+ * Run the step function of a client as soon as possible (interrupt safe)
+ */
+extern void SensorTagSched_trigger(uint8_t id);
+
+/*
+ * Register the periodic clock of a sensor that is not a client
+ */
+extern void SensorTagSched_registerClock(uint8_t id, Clock_Struct *pClock,
+                                         uint32_t period);
+
+/*
+ * Change the period (ms) of a registered clock
+ */
+extern void SensorTagSched_setClockPeriod(uint8_t id, uint32_t period);
+
+/*
+ * Start a registered clock
+ */
+extern void SensorTagSched_startClock(uint8_t id);
+
+/*
+ * Count a timed sensor event (called from clock handlers)
+ */
+extern void SensorTagSched_countEvent(void);
+
+/*
+ * Select free running or aligned sampling
+ */
+extern void SensorTagSched_setMode(uint8_t mode);
+
+/*
+ * Get the sampling mode
+ */
+extern uint8_t SensorTagSched_getMode(void);
+
+/*
+ * Get the period (ms) in use for a requested period
+ */
+extern uint32_t SensorTagSched_alignPeriod(uint32_t period);
+
+/*
+ * Get the wake-ups saved per second, true if updated since the last call
+ */
+extern bool SensorTagSched_getWakesSaved(uint16_t *pSaved);
+
+/*
+ * Task Event Processor for the sensor scheduler
+ */
+extern void SensorTagSched_processEvent(void);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORTAGSCHED_H */
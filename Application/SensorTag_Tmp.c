@@ -46,13 +46,13 @@
 
 #include "irtempservice.h"
 #include "SensorTag_Tmp.h"
+#include "SensorTag_Sched.h"
+#include "SensorTag_Cal.h"
 #include "sensor_tmp007.h"
 #include "sensor.h"
 #include "Board.h"
 
 #include "string.h"
-#include <ti/sysbios/knl/Semaphore.h>
-#include <ti/sysbios/knl/Task.h>
 
 /*********************************************************************
  * MACROS
@@ -65,9 +65,8 @@
 // How often to perform sensor reads (milliseconds)
 #define SENSOR_DEFAULT_PERIOD   1000
 
-// Delay from sensor enable to reading measurement
-// (allow for 250 ms conversion time)
-#define TEMP_MEAS_DELAY         275
+// Number of conversions averaged per result
+#define TEMP_AVERAGING          TMP007_AVG_1
 
 // Length of the data for this sensor
 #define SENSOR_DATA_LEN         IRTEMPERATURE_DATA_LEN
@@ -75,10 +74,6 @@
 // Event flag for this sensor
 #define SENSOR_EVT              ST_IRTEMPERATURE_SENSOR_EVT
 
-// Task configuration
-#define SENSOR_TASK_PRIORITY    1
-#define SENSOR_TASK_STACK_SIZE  600
-
 /*********************************************************************
  * TYPEDEFS
  */
@@ -98,24 +93,26 @@
 /*********************************************************************
  * LOCAL VARIABLES
  */
-// Entity ID used to check for source and/or destination of messages
-static ICall_EntityID sensorSelfEntity;
-
-// Semaphore used to post events to the application thread
-static ICall_Semaphore sensorSem;
-
-// Task setup
-static Task_Struct sensorTask;
-static Char sensorTaskStack[SENSOR_TASK_STACK_SIZE];
-
 // Parameters
 static uint8_t sensorConfig;
 static uint16_t sensorPeriod;
+static uint8_t sensorState;
+
+// Operating mode selected from the period, sensor converting continuously
+static uint8_t sensorMode;
+static bool sensorRunning;
+
+// Time from enable to result (ms), conversion ready on the ALERT pin
+static uint16_t convTime;
+static bool sensorIntMode;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
-static void sensorTaskFxn(UArg a0, UArg a1);
+static void sensorSchedCB(void);
+static void sensorCalApply(uint16_t *rawLocal);
+static void sensorWaitReady(void);
+static void sensorAlertCB(void);
 static void sensorConfigChangeCB(uint8_t paramID);
 static void initCharacteristicValue(uint8_t paramID, uint8_t value,
                                     uint8_t paramLen);
@@ -134,25 +131,37 @@ static sensorCBs_t sensorCallbacks =
  */
 
 /*********************************************************************
- * @fn      SensorTagTmp_createTask
+ * @fn      SensorTagTmp_init
  *
- * @brief   Task creation function for the SensorTag
+ * @brief   Initialization function for the SensorTag IR temperature sensor
  *
  * @param   none
  *
  * @return  none
  */
-void SensorTagTmp_createTask(void)
+void SensorTagTmp_init(void)
 {
-  Task_Params taskParames;
+  // Add service
+  IRTemp_addService();
+
+  // Register callbacks with profile
+  IRTemp_registerAppCBs(&sensorCallbacks);
 
-  // Create the task for the state machine
-  Task_Params_init(&taskParames);
-  taskParames.stack = sensorTaskStack;
-  taskParames.stackSize = SENSOR_TASK_STACK_SIZE;
-  taskParames.priority = SENSOR_TASK_PRIORITY;
+  // Register with the sensor scheduler
+  SensorTagSched_register(SCHED_ID_TMP, sensorSchedCB);
 
-  Task_construct(&sensorTask, sensorTaskFxn, &taskParames, NULL);
+  // Initialize the module state variables
+  sensorPeriod = SENSOR_DEFAULT_PERIOD;
+
+  // Initialize characteristics and sensor driver
+  SensorTagTmp_reset();
+  sensorIntMode = sensorTmp007RegisterCallback(sensorAlertCB);
+  sensorTmp007SetAveraging(TEMP_AVERAGING);
+  convTime = sensorTmp007ConversionTime();
+  sensorMode = sensorTmp007SelectMode(sensorPeriod);
+  initCharacteristicValue(SENSOR_PERI,
+                          SENSOR_DEFAULT_PERIOD / SENSOR_PERIOD_RESOLUTION,
+                          sizeof ( uint8_t ));
 }
 
 /*********************************************************************
@@ -182,12 +191,13 @@ void SensorTagTmp_processCharChangeEvt(uint8_t paramID)
         // Reset characteristics
         initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
 
-        // Deactivate task
-        Task_setPri(Task_handle(&sensorTask), -1);
+        // Stop the read-out
+        SensorTagSched_stop(SCHED_ID_TMP);
       }
       else
       {
-        Task_setPri(Task_handle(&sensorTask), SENSOR_TASK_PRIORITY);
+        // Start the read-out
+        SensorTagSched_startPeriod(SCHED_ID_TMP, sensorPeriod);
       }
 
       sensorConfig = newValue;
@@ -201,11 +211,14 @@ void SensorTagTmp_processCharChangeEvt(uint8_t paramID)
 
     // Make sure sensor is disabled
     sensorTmp007Enable(false);
+    sensorRunning = false;
+    sensorState = SCHED_STATE_IDLE;
     break;
 
   case SENSOR_PERI:
     IRTemp_getParameter(SENSOR_PERI, &newValue);
     sensorPeriod = newValue * SENSOR_PERIOD_RESOLUTION;
+    sensorMode = sensorTmp007SelectMode(sensorPeriod);
     break;
 
   default:
@@ -226,6 +239,9 @@ void SensorTagTmp_processCharChangeEvt(uint8_t paramID)
 void SensorTagTmp_reset(void)
 {
   sensorConfig = ST_CFG_SENSOR_DISABLE;
+  sensorRunning = false;
+  sensorState = SCHED_STATE_IDLE;
+  SensorTagSched_stop(SCHED_ID_TMP);
   initCharacteristicValue(SENSOR_DATA, 0, SENSOR_DATA_LEN);
   initCharacteristicValue(SENSOR_CONF, sensorConfig, sizeof(uint8_t));
 
@@ -239,37 +255,14 @@ void SensorTagTmp_reset(void)
 */
 
 /*********************************************************************
- * @fn      sensorTaskInit
- *
- * @brief   Initialization function for the SensorTag IR temperature sensor
- *
- */
-static void sensorTaskInit(void)
-{
-  // Add service
-  IRTemp_addService();
-
-  // Register callbacks with profile
-  IRTemp_registerAppCBs(&sensorCallbacks);
-
-  // Initialize the module state variables
-  sensorPeriod = SENSOR_DEFAULT_PERIOD;
-
-  // Initialize characteristics and sensor driver
-  SensorTagTmp_reset();
-  initCharacteristicValue(SENSOR_PERI,
-                          SENSOR_DEFAULT_PERIOD / SENSOR_PERIOD_RESOLUTION,
-                          sizeof ( uint8_t ));
-}
-
-/*********************************************************************
- * @fn      sensorTaskFxn
+ * @fn      sensorSchedCB
  *
- * @brief   The task loop of the temperature readout task
+ * @brief   Read-out state machine, one step per call from the sensor
+ *          scheduler
  *
  * @return  none
  */
-static void sensorTaskFxn(UArg a0, UArg a1)
+static void sensorSchedCB(void)
 {
   typedef union
   {
@@ -280,38 +273,118 @@ static void sensorTaskFxn(UArg a0, UArg a1)
     uint16_t a[2];
   } Data_t;
 
-  // Register task with BLE stack
-  ICall_registerApp(&sensorSelfEntity, &sensorSem);
-
-  // Initialize the task
-  sensorTaskInit();
-
-  // Deactivate task (active only when measurement is enabled)
-  Task_setPri(Task_handle(&sensorTask), -1);
+  Data_t data;
 
-  // Task loop
-  while (true)
+  if (sensorConfig != ST_CFG_SENSOR_ENABLE)
   {
-    if (sensorConfig == ST_CFG_SENSOR_ENABLE)
-    {
-      Data_t data;
+    return;
+  }
 
-      // Read data
-      sensorTmp007Enable(true);
-      delay_ms(TEMP_MEAS_DELAY);
-      sensorTmp007Read(&data.v.tempLocal, &data.v.tempTarget);
-      sensorTmp007Enable(false);
+  switch (sensorState)
+  {
+  case SCHED_STATE_IDLE:
+    // Start conversion
+    sensorTmp007Enable(true);
+    sensorRunning = true;
+    sensorState = SCHED_STATE_CONVERTING;
+    sensorWaitReady();
+    break;
 
-      // Update GATT
-      IRTemp_setParameter( SENSOR_DATA, SENSOR_DATA_LEN, data.a);
+  case SCHED_STATE_CONVERTING:
+    if (sensorMode == TMP007_MODE_CONTINUOUS)
+    {
+      // Period shorter than (or close to) the conversion time: keep
+      // converting and publish every result
+      if (sensorTmp007Read(&data.v.tempLocal, &data.v.tempTarget))
+      {
+        sensorCalApply(&data.v.tempLocal);
 
-      // Next cycle
-      delay_ms(sensorPeriod - TEMP_MEAS_DELAY);
+        // Update GATT
+        IRTemp_setParameter( SENSOR_DATA, SENSOR_DATA_LEN, data.a);
+      }
+      sensorWaitReady();
     }
     else
     {
-      delay_ms(SENSOR_DEFAULT_PERIOD);
+      // Read data
+      if (sensorTmp007Read(&data.v.tempLocal, &data.v.tempTarget))
+      {
+        sensorCalApply(&data.v.tempLocal);
+
+        // Update GATT
+        IRTemp_setParameter( SENSOR_DATA, SENSOR_DATA_LEN, data.a);
+      }
+      sensorTmp007Enable(false);
+      sensorRunning = false;
+      sensorState = SCHED_STATE_IDLE;
+
+      // Next cycle (duty cycling is only selected if period > convTime)
+      SensorTagSched_startPeriod(SCHED_ID_TMP, sensorPeriod);
     }
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+/*********************************************************************
+ * @fn      sensorCalApply
+ *
+ * @brief   Correct the die (ambient) temperature with the calibration
+ *          table. The register LSB is 1/128 degC; bits 1:0 are flags.
+ *
+ * @param   rawLocal - raw die temperature
+ *
+ * @return  none
+ */
+static void sensorCalApply(uint16_t *rawLocal)
+{
+  int32_t offset;
+
+  // 0.01 degC to 0.03125 degC (8/25), rounded, in register units (x4)
+  offset = SensorTagCal_get()->tempOffset * 8;
+  offset = (offset + (offset < 0 ? -12 : 12)) / 25;
+
+  *rawLocal = (uint16_t)SensorTagCal_subtract((int16_t)*rawLocal, offset * 4);
+}
+
+
+/*********************************************************************
+ * @fn      sensorWaitReady
+ *
+ * @brief   Schedule the read-out: triggered by the ALERT pin if available,
+ *          otherwise after the conversion time
+ *
+ * @return  none
+ */
+static void sensorWaitReady(void)
+{
+  if (sensorIntMode)
+  {
+    // Time-out in case the interrupt is missed
+    SensorTagSched_start(SCHED_ID_TMP, convTime * 2);
+  }
+  else
+  {
+    SensorTagSched_start(SCHED_ID_TMP, convTime);
+  }
+}
+
+
+/*********************************************************************
+ * @fn      sensorAlertCB
+ *
+ * @brief   Interrupt handler for TMP007 conversion ready
+ *
+ * @return  none
+ */
+static void sensorAlertCB(void)
+{
+  if (sensorState == SCHED_STATE_CONVERTING)
+  {
+    SensorTagSched_trigger(SCHED_ID_TMP);
   }
 }
 
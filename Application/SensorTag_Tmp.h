@@ -64,9 +64,9 @@ extern "C"
  */
   
 /*
- * Create the IR temperature sensor task
+ * Initialization for the SensorTag IR temperature sensor
  */
-void SensorTagTmp_createTask(void);
+extern void SensorTagTmp_init(void);
 
 /*
  * Task Event Processor for characteristic changes
@@ -0,0 +1,336 @@
+/*******************************************************************************
+  Filename:       altimeter.c
+
+  Description:    Fixed point barometric altimeter. Low-pass filters the pressure
+                  from the barometer and derives the altitude relative to a
+                  reference pressure and the 1 hour and 3 hour pressure trend.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stddef.h"
+#include "altimeter.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Internal pressure format: Pa in Q8
+#define PQ                        8
+
+// Internal format of the log pressure ratio
+#define AQ                        30
+
+// Low-pass filter time constant (ms)
+#define ALTIMETER_TAU             4000
+
+// Scale height of the air column per kelvin (mm), R / (M * g)
+#define ALTIMETER_SCALE_HEIGHT    29271
+
+// History: the latest slot followed by the 3 hours before it
+#define HIST_SIZE                 (ALTIMETER_TREND_SLOTS + 1)
+#define SLOT_MS                   (ALTIMETER_TREND_SLOT * 1000UL)
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Q8 to integer, rounding halves away from zero
+#define Q8_ROUND(x)               (((x) + ((x) < 0 ? -128 : 128)) / 256)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Filtered and reference pressure, Pa Q8 (0 = not known)
+static uint32_t pressFilt;
+static uint32_t pressRef;
+
+// Scale height (cm) at the last measured temperature
+static uint32_t scaleHeight;
+
+// Altitude relative to the reference (cm)
+static int32_t altitude;
+
+// Trend history, Pa Q8, and time into the current slot (ms)
+static uint32_t hist[HIST_SIZE];
+static uint8_t histHead;
+static uint8_t histCount;
+static uint32_t slotTime;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void storeSlot(void);
+static void updateAltitude(void);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Altimeter_init
+ *
+ * @brief   Reset the filter, the trend history and the reference
+ *
+ * @return  none
+ */
+void Altimeter_init(void)
+{
+  pressRef = 0;
+  Altimeter_restart();
+}
+
+/*********************************************************************
+ * @fn      Altimeter_restart
+ *
+ * @brief   Reset the filter and the trend history, keep the reference.
+ *          Used when the sample stream has been interrupted.
+ *
+ * @return  none
+ */
+void Altimeter_restart(void)
+{
+  pressFilt = 0;
+  altitude = 0;
+  histHead = 0;
+  histCount = 0;
+  slotTime = 0;
+}
+
+/*********************************************************************
+ * @fn      Altimeter_update
+ *
+ * @brief   Low-pass filter a pressure sample, recompute the altitude and
+ *          store the filtered pressure in the trend history every
+ *          ALTIMETER_TREND_SLOT seconds.
+ *
+ * @param   press - pressure (Pa)
+ * @param   temp - temperature (0.01 degC)
+ * @param   dtMs - time since the previous sample (ms)
+ *
+ * @return  true if the pressure trend has been updated
+ */
+bool Altimeter_update(uint32_t press, int32_t temp, uint16_t dtMs)
+{
+  bool trendUpdated;
+  int32_t diff;
+
+  trendUpdated = false;
+  scaleHeight = (uint32_t)(temp + 27315) * ALTIMETER_SCALE_HEIGHT / 1000;
+
+  if (pressFilt == 0)
+  {
+    // First sample after a restart
+    pressFilt = press << PQ;
+    storeSlot();
+  }
+  else
+  {
+    // First order IIR, alpha = dt / (tau + dt)
+    diff = (int32_t)((press << PQ) - pressFilt);
+    pressFilt += (int32_t)(((int64_t)diff * dtMs) / (ALTIMETER_TAU + dtMs));
+
+    slotTime += dtMs;
+    if (slotTime >= SLOT_MS)
+    {
+      slotTime -= SLOT_MS;
+      storeSlot();
+      trendUpdated = histCount > ALTIMETER_TREND_1H;
+    }
+  }
+
+  if (pressRef == 0)
+  {
+    pressRef = pressFilt;
+  }
+  updateAltitude();
+
+  return trendUpdated;
+}
+
+/*********************************************************************
+ * @fn      Altimeter_setReference
+ *
+ * @brief   Set the reference pressure
+ *
+ * @param   ref - reference pressure (0.01 Pa), 0 takes the current
+ *                filtered pressure (or the first sample)
+ *
+ * @return  none
+ */
+void Altimeter_setReference(uint32_t ref)
+{
+  if (ref == 0)
+  {
+    pressRef = pressFilt;
+  }
+  else
+  {
+    pressRef = (uint32_t)((((uint64_t)ref << PQ) + 50) / 100);
+  }
+
+  if (pressFilt != 0)
+  {
+    updateAltitude();
+  }
+}
+
+/*********************************************************************
+ * @fn      Altimeter_getReference
+ *
+ * @brief   Get the reference pressure
+ *
+ * @return  reference pressure (0.01 Pa), 0 if not yet known
+ */
+uint32_t Altimeter_getReference(void)
+{
+  return (uint32_t)(((uint64_t)pressRef * 100 + (1 << (PQ - 1))) >> PQ);
+}
+
+/*********************************************************************
+ * @fn      Altimeter_getPressure
+ *
+ * @brief   Get the filtered pressure
+ *
+ * @return  pressure (0.01 Pa), 0 before the first sample
+ */
+uint32_t Altimeter_getPressure(void)
+{
+  return (uint32_t)(((uint64_t)pressFilt * 100 + (1 << (PQ - 1))) >> PQ);
+}
+
+/*********************************************************************
+ * @fn      Altimeter_getAltitude
+ *
+ * @brief   Get the altitude relative to the reference pressure
+ *
+ * @return  altitude (cm)
+ */
+int32_t Altimeter_getAltitude(void)
+{
+  return altitude;
+}
+
+/*********************************************************************
+ * @fn      Altimeter_getTrend
+ *
+ * @brief   Get the pressure change over the last 1 and 3 hours, taken
+ *          between history slots. A trend is 0 until enough history
+ *          has been collected.
+ *
+ * @param   trend1h - 1 hour pressure change (Pa)
+ * @param   trend3h - 3 hour pressure change (Pa)
+ *
+ * @return  ALTIMETER_FLAG_1H and ALTIMETER_FLAG_3H when valid
+ */
+uint8_t Altimeter_getTrend(int16_t *trend1h, int16_t *trend3h)
+{
+  uint8_t flags;
+  int32_t diff;
+
+  flags = 0;
+  *trend1h = 0;
+  *trend3h = 0;
+
+  if (histCount > ALTIMETER_TREND_1H)
+  {
+    diff = (int32_t)(hist[histHead] -
+           hist[(histHead + HIST_SIZE - ALTIMETER_TREND_1H) % HIST_SIZE]);
+    *trend1h = (int16_t)Q8_ROUND(diff);
+    flags |= ALTIMETER_FLAG_1H;
+  }
+
+  if (histCount > ALTIMETER_TREND_SLOTS)
+  {
+    diff = (int32_t)(hist[histHead] -
+           hist[(histHead + HIST_SIZE - ALTIMETER_TREND_SLOTS) % HIST_SIZE]);
+    *trend3h = (int16_t)Q8_ROUND(diff);
+    flags |= ALTIMETER_FLAG_3H;
+  }
+
+  return flags;
+}
+
+/*********************************************************************
+* Private functions
+*/
+
+/*********************************************************************
+ * @fn      storeSlot
+ *
+ * @brief   Add the filtered pressure to the trend history
+ *
+ * @return  none
+ */
+static void storeSlot(void)
+{
+  if (histCount > 0)
+  {
+    histHead = (histHead + 1) % HIST_SIZE;
+  }
+  hist[histHead] = pressFilt;
+
+  if (histCount < HIST_SIZE)
+  {
+    histCount++;
+  }
+}
+
+/*********************************************************************
+ * @fn      updateAltitude
+ *
+ * @brief   Hypsometric altitude, h = H * ln(p0 / p) with the scale
+ *          height H = R * T / (M * g). The logarithm is evaluated as
+ *          2 * (u + u^3 / 3 + u^5 / 5), u = (p0 - p) / (p0 + p), which
+ *          is within 3 cm up to 3000 m from the reference.
+ *
+ * @return  none
+ */
+static void updateAltitude(void)
+{
+  int64_t u;
+  int64_t u2;
+  int64_t u3;
+
+  u = ((int64_t)(int32_t)(pressRef - pressFilt) << AQ) /
+      (int64_t)(pressRef + pressFilt);
+  u2 = (u * u) >> AQ;
+  u3 = (u2 * u) >> AQ;
+  u += u3 / 3 + ((u3 * u2) >> AQ) / 5;
+
+  altitude = (int32_t)((2 * (int64_t)scaleHeight * u) >> AQ);
+}
+
+/*********************************************************************
+*********************************************************************/
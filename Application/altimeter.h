@@ -0,0 +1,117 @@
+/*******************************************************************************
+  Filename:       altimeter.h
+
+  Description:    Fixed point barometric altimeter. Low-pass filters the pressure
+                  from the barometer and derives the altitude relative to a
+                  reference pressure and the 1 hour and 3 hour pressure trend.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef ALTIMETER_H
+#define ALTIMETER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stdint.h"
+#include "stdbool.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Pressure trend: history slot (s) and number of slots kept (3 hours)
+#define ALTIMETER_TREND_SLOT      600
+#define ALTIMETER_TREND_SLOTS     18
+#define ALTIMETER_TREND_1H        6
+
+// Trend flags
+#define ALTIMETER_FLAG_1H         0x01  // 1 hour trend valid
+#define ALTIMETER_FLAG_3H         0x02  // 3 hour trend valid
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Reset the filter, the trend history and the reference
+ */
+extern void Altimeter_init(void);
+
+/*
+ * Reset the filter and the trend history, keep the reference
+ */
+extern void Altimeter_restart(void);
+
+/*
+ * Update with one pressure sample (Pa) and temperature (0.01 degC).
+ * Returns true when the pressure trend has been updated.
+ */
+extern bool Altimeter_update(uint32_t press, int32_t temp, uint16_t dtMs);
+
+/*
+ * Set the reference pressure (0.01 Pa), 0 takes the current pressure
+ */
+extern void Altimeter_setReference(uint32_t ref);
+
+/*
+ * Get the reference pressure (0.01 Pa), 0 if not yet known
+ */
+extern uint32_t Altimeter_getReference(void);
+
+/*
+ * Get the filtered pressure (0.01 Pa), 0 before the first sample
+ */
+extern uint32_t Altimeter_getPressure(void);
+
+/*
+ * Get the altitude relative to the reference pressure (cm)
+ */
+extern int32_t Altimeter_getAltitude(void);
+
+/*
+ * Get the 1 hour and 3 hour pressure change (Pa); returns the trend flags
+ */
+extern uint8_t Altimeter_getTrend(int16_t *trend1h, int16_t *trend3h);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ALTIMETER_H */
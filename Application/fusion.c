@@ -0,0 +1,352 @@
+/*******************************************************************************
+  Filename:       fusion.c
+
+  Description:    Fixed point orientation filter (Mahony) for the movement
+                  sensor. Produces a unit quaternion from gyroscope,
+                  accelerometer and (optionally) magnetometer samples.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stddef.h"
+#include "fusion.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Internal fixed point format for unit vectors and the quaternion
+#define FQ                        28
+#define F_ONE                     (1L << FQ)
+#define F_HALF                    (1L << (FQ - 1))
+
+// Rate vectors are rad/s in Q24
+#define GQ                        24
+
+// Filter gains (Q16): proportional and integral feedback, both x2
+#define FUSION_TWO_KP             65536  // 2 * 0.5
+#define FUSION_TWO_KI             0      // 2 * 0.0
+
+// Longest time step accepted (ms); longer gaps are clipped. At 2000 deg/s
+// plus feedback (36 rad/s) the half angle step on each axis stays below
+// 3.6 rad, which keeps the quaternion update (|q| + sqrt(3) * step) within
+// the Q28 range.
+#define FUSION_MAX_DT             200
+
+/*********************************************************************
+ * MACROS
+ */
+#define FMUL(a,b)                 ((int32_t)(((int64_t)(a) * (b)) >> FQ))
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Orientation estimate, Q28 (w, x, y, z)
+static int32_t q0, q1, q2, q3;
+
+// Integral feedback terms, rad/s Q24
+static int32_t iFbX, iFbY, iFbZ;
+
+// Gyroscope scale
+static uint16_t gyroScale = FUSION_GYRO_250DPS;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint32_t isqrt64(uint64_t v);
+static bool normalize(const int16_t *in, int32_t *out);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Fusion_init
+ *
+ * @brief   Reset the orientation estimate to the identity quaternion
+ *
+ * @return  none
+ */
+void Fusion_init(void)
+{
+  q0 = F_ONE;
+  q1 = 0;
+  q2 = 0;
+  q3 = 0;
+  iFbX = 0;
+  iFbY = 0;
+  iFbZ = 0;
+}
+
+/*********************************************************************
+ * @fn      Fusion_setGyroScale
+ *
+ * @brief   Set the gyroscope scale
+ *
+ * @param   scale - rad/s in Q24 per LSB
+ *
+ * @return  none
+ */
+void Fusion_setGyroScale(uint16_t scale)
+{
+  gyroScale = scale;
+}
+
+/*********************************************************************
+ * @fn      Fusion_update
+ *
+ * @brief   Mahony complementary filter in fixed point. The gyroscope
+ *          rate is corrected by the error between the measured and the
+ *          estimated direction of gravity (and of the magnetic field if
+ *          available) before it is integrated into the quaternion.
+ *
+ * @param   gyro - gyroscope X, Y, Z (raw)
+ * @param   acc - accelerometer X, Y, Z (any scale)
+ * @param   mag - magnetometer X, Y, Z (any scale), NULL if not used
+ * @param   dtMs - time since the previous update (ms)
+ *
+ * @return  none
+ */
+void Fusion_update(const int16_t *gyro, const int16_t *acc,
+                   const int16_t *mag, uint16_t dtMs)
+{
+  int32_t a[3], m[3];
+  int32_t gx, gy, gz;
+  int32_t ex, ey, ez;
+  int32_t vx, vy, vz;
+  int32_t qa, qb, qc;
+  int32_t q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
+  uint32_t norm;
+
+  if (dtMs > FUSION_MAX_DT)
+  {
+    dtMs = FUSION_MAX_DT;
+  }
+
+  // Rate in rad/s, Q24
+  gx = (int32_t)gyro[0] * gyroScale;
+  gy = (int32_t)gyro[1] * gyroScale;
+  gz = (int32_t)gyro[2] * gyroScale;
+
+  // Feedback only if the accelerometer measurement is valid
+  if (normalize(acc, a))
+  {
+    q0q0 = FMUL(q0, q0);
+    q0q1 = FMUL(q0, q1);
+    q0q2 = FMUL(q0, q2);
+    q0q3 = FMUL(q0, q3);
+    q1q1 = FMUL(q1, q1);
+    q1q2 = FMUL(q1, q2);
+    q1q3 = FMUL(q1, q3);
+    q2q2 = FMUL(q2, q2);
+    q2q3 = FMUL(q2, q3);
+    q3q3 = FMUL(q3, q3);
+
+    // Estimated direction of gravity (half)
+    vx = q1q3 - q0q2;
+    vy = q0q1 + q2q3;
+    vz = q0q0 - F_HALF + q3q3;
+
+    // Error is the cross product between measured and estimated direction
+    ex = FMUL(a[1], vz) - FMUL(a[2], vy);
+    ey = FMUL(a[2], vx) - FMUL(a[0], vz);
+    ez = FMUL(a[0], vy) - FMUL(a[1], vx);
+
+    if (mag != NULL && normalize(mag, m))
+    {
+      int32_t hx, hy, bx, bz;
+      int32_t wx, wy, wz;
+
+      // Reference direction of the earth's magnetic field
+      hx = 2 * (FMUL(m[0], F_HALF - q2q2 - q3q3) + FMUL(m[1], q1q2 - q0q3) +
+                FMUL(m[2], q1q3 + q0q2));
+      hy = 2 * (FMUL(m[0], q1q2 + q0q3) + FMUL(m[1], F_HALF - q1q1 - q3q3) +
+                FMUL(m[2], q2q3 - q0q1));
+      bx = isqrt64((uint64_t)((int64_t)hx * hx + (int64_t)hy * hy));
+      bz = 2 * (FMUL(m[0], q1q3 - q0q2) + FMUL(m[1], q2q3 + q0q1) +
+                FMUL(m[2], F_HALF - q1q1 - q2q2));
+
+      // Estimated direction of the magnetic field (half)
+      wx = FMUL(bx, F_HALF - q2q2 - q3q3) + FMUL(bz, q1q3 - q0q2);
+      wy = FMUL(bx, q1q2 - q0q3) + FMUL(bz, q0q1 + q2q3);
+      wz = FMUL(bx, q0q2 + q1q3) + FMUL(bz, F_HALF - q1q1 - q2q2);
+
+      ex += FMUL(m[1], wz) - FMUL(m[2], wy);
+      ey += FMUL(m[2], wx) - FMUL(m[0], wz);
+      ez += FMUL(m[0], wy) - FMUL(m[1], wx);
+    }
+
+    // Error to Q24 rate units
+    ex >>= (FQ - GQ);
+    ey >>= (FQ - GQ);
+    ez >>= (FQ - GQ);
+
+#if FUSION_TWO_KI > 0
+    // Integral feedback
+    iFbX += (int32_t)(((int64_t)ex * FUSION_TWO_KI * dtMs) / (1000L << 16));
+    iFbY += (int32_t)(((int64_t)ey * FUSION_TWO_KI * dtMs) / (1000L << 16));
+    iFbZ += (int32_t)(((int64_t)ez * FUSION_TWO_KI * dtMs) / (1000L << 16));
+#endif
+    gx += iFbX;
+    gy += iFbY;
+    gz += iFbZ;
+
+    // Proportional feedback
+    gx += (int32_t)(((int64_t)ex * FUSION_TWO_KP) >> 16);
+    gy += (int32_t)(((int64_t)ey * FUSION_TWO_KP) >> 16);
+    gz += (int32_t)(((int64_t)ez * FUSION_TWO_KP) >> 16);
+  }
+
+  // Half angle step in Q28: rate(Q24) * 16 * dt(ms) / 2000
+  gx = (int32_t)(((int64_t)gx * dtMs) / 125);
+  gy = (int32_t)(((int64_t)gy * dtMs) / 125);
+  gz = (int32_t)(((int64_t)gz * dtMs) / 125);
+
+  // Integrate rate of change of the quaternion
+  qa = q0;
+  qb = q1;
+  qc = q2;
+  q0 += -FMUL(qb, gx) - FMUL(qc, gy) - FMUL(q3, gz);
+  q1 +=  FMUL(qa, gx) + FMUL(qc, gz) - FMUL(q3, gy);
+  q2 +=  FMUL(qa, gy) - FMUL(qb, gz) + FMUL(q3, gx);
+  q3 +=  FMUL(qa, gz) + FMUL(qb, gy) - FMUL(qc, gx);
+
+  // Normalise the quaternion
+  norm = isqrt64((uint64_t)((int64_t)q0 * q0 + (int64_t)q1 * q1 +
+                            (int64_t)q2 * q2 + (int64_t)q3 * q3));
+  if (norm > 0)
+  {
+    q0 = (int32_t)(((int64_t)q0 << FQ) / norm);
+    q1 = (int32_t)(((int64_t)q1 << FQ) / norm);
+    q2 = (int32_t)(((int64_t)q2 << FQ) / norm);
+    q3 = (int32_t)(((int64_t)q3 << FQ) / norm);
+  }
+  else
+  {
+    Fusion_init();
+  }
+}
+
+/*********************************************************************
+ * @fn      Fusion_getQuaternion
+ *
+ * @brief   Get the current orientation estimate
+ *
+ * @param   quat - w, x, y, z in Q14
+ *
+ * @return  none
+ */
+void Fusion_getQuaternion(int16_t *quat)
+{
+  const int32_t shift = FQ - 14;
+  const int32_t round = 1L << (FQ - 15);
+
+  quat[0] = (int16_t)((q0 + round) >> shift);
+  quat[1] = (int16_t)((q1 + round) >> shift);
+  quat[2] = (int16_t)((q2 + round) >> shift);
+  quat[3] = (int16_t)((q3 + round) >> shift);
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      isqrt64
+ *
+ * @brief   Integer square root
+ *
+ * @param   v - value
+ *
+ * @return  floor(sqrt(v))
+ */
+static uint32_t isqrt64(uint64_t v)
+{
+  uint64_t res = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > v)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (v >= res + bit)
+    {
+      v -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+    {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)res;
+}
+
+/*********************************************************************
+ * @fn      normalize
+ *
+ * @brief   Scale a raw vector to unit length
+ *
+ * @param   in - raw X, Y, Z
+ * @param   out - unit vector, Q28
+ *
+ * @return  false if the vector is zero
+ */
+static bool normalize(const int16_t *in, int32_t *out)
+{
+  uint32_t norm;
+
+  norm = isqrt64((uint32_t)((int32_t)in[0] * in[0]) +
+                 (uint32_t)((int32_t)in[1] * in[1]) +
+                 (uint32_t)((int32_t)in[2] * in[2]));
+  if (norm == 0)
+  {
+    return false;
+  }
+
+  out[0] = (int32_t)(((int64_t)in[0] << FQ) / norm);
+  out[1] = (int32_t)(((int64_t)in[1] << FQ) / norm);
+  out[2] = (int32_t)(((int64_t)in[2] << FQ) / norm);
+
+  return true;
+}
+
+/*********************************************************************
+*********************************************************************/
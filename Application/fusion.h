@@ -0,0 +1,97 @@
+/*******************************************************************************
+  Filename:       fusion.h
+
+  Description:    Fixed point orientation filter (Mahony) for the movement
+                  sensor. Produces a unit quaternion from gyroscope,
+                  accelerometer and (optionally) magnetometer samples.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef FUSION_H
+#define FUSION_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stdint.h"
+#include "stdbool.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Output quaternion format: Q14 (1.0 = 16384), order w, x, y, z
+#define FUSION_QUAT_ONE           16384
+#define FUSION_QUAT_LEN           8
+
+// Gyroscope scale, rad/s in Q24 per LSB at +/-250 deg/s
+#define FUSION_GYRO_250DPS        2234
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Reset the orientation estimate to the identity quaternion
+ */
+extern void Fusion_init(void);
+
+/*
+ * Set the gyroscope scale (rad/s in Q24 per LSB)
+ */
+extern void Fusion_setGyroScale(uint16_t scale);
+
+/*
+ * Update the orientation estimate with one sample. Accelerometer and
+ * magnetometer data may be in any scale, the magnetometer may be NULL.
+ * All vectors must be in the same (accelerometer) frame.
+ */
+extern void Fusion_update(const int16_t *gyro, const int16_t *acc,
+                          const int16_t *mag, uint16_t dtMs);
+
+/*
+ * Get the current orientation estimate (Q14, w, x, y, z)
+ */
+extern void Fusion_getQuaternion(int16_t *quat);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FUSION_H */
@@ -77,6 +77,11 @@ extern void SensorTagIO_processCharChangeEvt( uint8_t paramID );
  */
 extern void SensorTagIO_reset( void);
 
+/*
+ * Update the sampling characteristic (wake-ups saved)
+ */
+extern void SensorTagIO_processSamplingEvent( void);
+
 /*
  * Get the IO mode (local or remote)
  */
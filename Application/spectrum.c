@@ -0,0 +1,478 @@
+/*******************************************************************************
+  Filename:       spectrum.c
+
+  Description:    Fixed point vibration spectrum of the accelerometer. A window
+                  of samples is transformed by a radix-2 FFT and reduced to the
+                  largest peaks and the level in a few frequency bands.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "string.h"
+#include "spectrum.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Sine table resolution (steps per turn), one step per point of the
+// largest window
+#define SIN_STEPS                 SPECTRUM_MAX_POINTS
+#define SIN_QUARTER               (SIN_STEPS / 4)
+
+// Q15 scale
+#define Q15_ONE                   32768L
+
+// Largest value reported
+#define SPECTRUM_MAX_VALUE        0xFFFF
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// First quarter of sin(2 pi m / SIN_STEPS), Q15
+static const int16_t sinTable[SIN_QUARTER + 1] =
+{
+      0,   402,   804,  1206,  1608,  2009,  2411,  2811,
+   3212,  3612,  4011,  4410,  4808,  5205,  5602,  5998,
+   6393,  6787,  7180,  7571,  7962,  8351,  8740,  9127,
+   9512,  9896, 10279, 10660, 11039, 11417, 11793, 12167,
+  12540, 12910, 13279, 13646, 14010, 14373, 14733, 15091,
+  15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+  18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475,
+  20788, 21097, 21403, 21706, 22006, 22302, 22595, 22884,
+  23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+  25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020,
+  27246, 27467, 27684, 27897, 28106, 28311, 28511, 28707,
+  28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+  30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238,
+  31357, 31471, 31581, 31686, 31786, 31881, 31972, 32058,
+  32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+  32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766,
+  32767
+};
+
+// Window of real samples, transformed in place as N/2 complex points
+// (real and imaginary parts interleaved)
+static int16_t window[SPECTRUM_MAX_POINTS];
+
+// Window size (0 = off) and number of samples captured
+static uint16_t nPoints;
+static uint16_t nFill;
+
+// Input axis
+static uint8_t inAxis;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static int16_t sinQ15(uint16_t m);
+static int16_t cosQ15(uint16_t m);
+static void fftComplex(uint16_t m);
+static void peakInsert(SpectrumResult_t *result, uint32_t *peakPow,
+                       uint16_t bin, uint32_t pow);
+static uint32_t isqrt64(uint64_t v);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Spectrum_init
+ *
+ * @brief   Select the window size and input, discarding the current
+ *          window
+ *
+ * @param   log2Points - SPECTRUM_POINTS_256, SPECTRUM_POINTS_512 or
+ *                       SPECTRUM_OFF
+ * @param   axis - SPECTRUM_AXIS_X/Y/Z or SPECTRUM_AXIS_NORM
+ *
+ * @return  none
+ */
+void Spectrum_init(uint8_t log2Points, uint8_t axis)
+{
+  if (log2Points == SPECTRUM_POINTS_256 || log2Points == SPECTRUM_POINTS_512)
+  {
+    nPoints = 1 << log2Points;
+  }
+  else
+  {
+    nPoints = 0;
+  }
+  inAxis = axis;
+  nFill = 0;
+}
+
+/*********************************************************************
+ * @fn      Spectrum_addSample
+ *
+ * @brief   Add one accelerometer sample to the window
+ *
+ * @param   acc - accelerometer X, Y, Z (raw)
+ *
+ * @return  true if the window is complete
+ */
+bool Spectrum_addSample(const int16_t *acc)
+{
+  int32_t v;
+
+  if (nPoints == 0)
+  {
+    return false;
+  }
+
+  if (nFill < nPoints)
+  {
+    if (inAxis < SPECTRUM_AXIS_NORM)
+    {
+      v = acc[inAxis];
+    }
+    else
+    {
+      v = isqrt64((uint32_t)((int32_t)acc[0] * acc[0]) +
+                  (uint32_t)((int32_t)acc[1] * acc[1]) +
+                  (uint32_t)((int32_t)acc[2] * acc[2]));
+      if (v > INT16_MAX)
+      {
+        v = INT16_MAX;
+      }
+    }
+    window[nFill++] = (int16_t)v;
+  }
+
+  return nFill == nPoints;
+}
+
+/*********************************************************************
+ * @fn      Spectrum_compute
+ *
+ * @brief   Transform the complete window and start a new one. The mean
+ *          (gravity) is removed and a Hann window applied. The N real
+ *          samples are transformed as N/2 complex points and the
+ *          spectrum of the real signal is recovered from it one bin at
+ *          a time, so no output buffer is needed. Every stage of the
+ *          transform is scaled by 1/2, which keeps all values within
+ *          16 bits.
+ *
+ * @param   result - largest peaks and band levels, all zero if the
+ *                   window is not complete
+ *
+ * @return  none
+ */
+void Spectrum_compute(SpectrumResult_t *result)
+{
+  uint32_t peakPow[SPECTRUM_PEAKS];
+  uint64_t bandPow[SPECTRUM_BANDS];
+  uint32_t powPrev;
+  uint32_t powCur;
+  int32_t mean;
+  uint16_t step;
+  uint16_t m;
+  uint16_t k;
+  uint8_t i;
+
+  memset(result, 0, sizeof(SpectrumResult_t));
+  memset(peakPow, 0, sizeof(peakPow));
+  memset(bandPow, 0, sizeof(bandPow));
+
+  if (nPoints == 0 || nFill < nPoints)
+  {
+    return;
+  }
+
+  m = nPoints / 2;
+  step = SIN_STEPS / nPoints;
+
+  // Remove the mean and apply the window at half scale (15 bits)
+  mean = 0;
+  for (k = 0; k < nPoints; k++)
+  {
+    mean += window[k];
+  }
+  mean /= (int32_t)nPoints;
+
+  for (k = 0; k < nPoints; k++)
+  {
+    int32_t x = ((int32_t)window[k] - mean) / 2;
+    int32_t w = (Q15_ONE - cosQ15(k * step)) / 2;
+
+    window[k] = (int16_t)((x * w) >> 15);
+  }
+
+  fftComplex(m);
+
+  // Bin k of the real signal from complex points k and m - k. The DC bin
+  // and the Nyquist bin are skipped.
+  powPrev = 0;
+  powCur = 0;
+  for (k = 1; k <= m; k++)
+  {
+    uint32_t pow = 0;
+
+    if (k < m)
+    {
+      const int16_t *zk = &window[2 * k];
+      const int16_t *zc = &window[2 * (m - k)];
+      int32_t ar = (int32_t)zk[0] + zc[0];
+      int32_t ai = (int32_t)zk[1] - zc[1];
+      int32_t br = (int32_t)zk[0] - zc[0];
+      int32_t bi = (int32_t)zk[1] + zc[1];
+      int32_t c = cosQ15(k * step);
+      int32_t s = sinQ15(k * step);
+      int32_t xr = (ar + ((c * bi - s * br) >> 15)) / 2;
+      int32_t xi = (ai - ((c * br + s * bi) >> 15)) / 2;
+
+      pow = (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+      bandPow[(uint32_t)k * SPECTRUM_BANDS / m] += pow;
+    }
+
+    // Local maximum one bin back. Bin 1 has no left neighbour here (the
+    // DC bin is skipped) and lies within the window main lobe of the
+    // removed mean, so the first candidate is bin 2.
+    if (k >= 3 && powCur > powPrev && powCur >= pow)
+    {
+      peakInsert(result, peakPow, k - 1, powCur);
+    }
+    powPrev = powCur;
+    powCur = pow;
+  }
+
+  // A sine of amplitude A gives |X| = A/4 in its bin (half scale input,
+  // window gain 1/2) and 3/32 A^2 summed over the window main lobe
+  for (i = 0; i < SPECTRUM_PEAKS; i++)
+  {
+    uint32_t mag = isqrt64(peakPow[i]) * 4;
+
+    result->peakMag[i] = mag > SPECTRUM_MAX_VALUE ? SPECTRUM_MAX_VALUE : mag;
+  }
+
+  for (i = 0; i < SPECTRUM_BANDS; i++)
+  {
+    uint32_t rms = isqrt64(bandPow[i] * 16 / 3);
+
+    result->bandRms[i] = rms > SPECTRUM_MAX_VALUE ? SPECTRUM_MAX_VALUE : rms;
+  }
+
+  nFill = 0;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      sinQ15
+ *
+ * @brief   Sine from the quarter wave table
+ *
+ * @param   m - angle, 2 pi m / SIN_STEPS
+ *
+ * @return  sine (Q15)
+ */
+static int16_t sinQ15(uint16_t m)
+{
+  uint16_t r;
+
+  m %= SIN_STEPS;
+  r = m % SIN_QUARTER;
+
+  switch (m / SIN_QUARTER)
+  {
+  case 0:
+    return sinTable[r];
+  case 1:
+    return sinTable[SIN_QUARTER - r];
+  case 2:
+    return -sinTable[r];
+  default:
+    return -sinTable[SIN_QUARTER - r];
+  }
+}
+
+/*********************************************************************
+ * @fn      cosQ15
+ *
+ * @brief   Cosine from the quarter wave table
+ *
+ * @param   m - angle, 2 pi m / SIN_STEPS
+ *
+ * @return  cosine (Q15)
+ */
+static int16_t cosQ15(uint16_t m)
+{
+  return sinQ15(m + SIN_QUARTER);
+}
+
+/*********************************************************************
+ * @fn      fftComplex
+ *
+ * @brief   In place radix-2 decimation in time FFT of the window as
+ *          complex points, each stage scaled by 1/2
+ *
+ * @param   m - number of complex points (power of two)
+ *
+ * @return  none
+ */
+static void fftComplex(uint16_t m)
+{
+  uint16_t size;
+  uint16_t half;
+  uint16_t bit;
+  uint16_t i;
+  uint16_t j;
+
+  // Bit reversed order
+  j = 0;
+  for (i = 1; i < m; i++)
+  {
+    int16_t t;
+
+    bit = m >> 1;
+    while (j & bit)
+    {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j |= bit;
+
+    if (i < j)
+    {
+      t = window[2 * i];
+      window[2 * i] = window[2 * j];
+      window[2 * j] = t;
+      t = window[2 * i + 1];
+      window[2 * i + 1] = window[2 * j + 1];
+      window[2 * j + 1] = t;
+    }
+  }
+
+  // Butterflies
+  for (size = 2; size <= m; size <<= 1)
+  {
+    half = size >> 1;
+
+    for (j = 0; j < half; j++)
+    {
+      int32_t wr = cosQ15(j * (SIN_STEPS / size));
+      int32_t wi = -sinQ15(j * (SIN_STEPS / size));
+
+      for (i = j; i < m; i += size)
+      {
+        int16_t *a = &window[2 * i];
+        int16_t *b = &window[2 * (i + half)];
+        int32_t tr = (b[0] * wr - b[1] * wi) >> 15;
+        int32_t ti = (b[0] * wi + b[1] * wr) >> 15;
+        int32_t ar = a[0];
+        int32_t ai = a[1];
+
+        a[0] = (int16_t)((ar + tr) >> 1);
+        a[1] = (int16_t)((ai + ti) >> 1);
+        b[0] = (int16_t)((ar - tr) >> 1);
+        b[1] = (int16_t)((ai - ti) >> 1);
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      peakInsert
+ *
+ * @brief   Insert a peak into the list of largest peaks
+ *
+ * @param   result - peak bins
+ * @param   peakPow - peak power, sorted largest first
+ * @param   bin - bin of the new peak
+ * @param   pow - power of the new peak
+ *
+ * @return  none
+ */
+static void peakInsert(SpectrumResult_t *result, uint32_t *peakPow,
+                       uint16_t bin, uint32_t pow)
+{
+  uint8_t i;
+
+  if (pow <= peakPow[SPECTRUM_PEAKS - 1])
+  {
+    return;
+  }
+
+  i = SPECTRUM_PEAKS - 1;
+  while (i > 0 && peakPow[i - 1] < pow)
+  {
+    peakPow[i] = peakPow[i - 1];
+    result->peakBin[i] = result->peakBin[i - 1];
+    i--;
+  }
+  peakPow[i] = pow;
+  result->peakBin[i] = bin;
+}
+
+/*********************************************************************
+ * @fn      isqrt64
+ *
+ * @brief   Integer square root
+ *
+ * @param   v - value
+ *
+ * @return  floor(sqrt(v))
+ */
+static uint32_t isqrt64(uint64_t v)
+{
+  uint64_t res = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > v)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (v >= res + bit)
+    {
+      v -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+    {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)res;
+}
+
+/*********************************************************************
+*********************************************************************/
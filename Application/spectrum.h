@@ -0,0 +1,113 @@
+/*******************************************************************************
+  Filename:       spectrum.h
+
+  Description:    Fixed point vibration spectrum of the accelerometer. A window
+                  of samples is transformed by a radix-2 FFT and reduced to the
+                  largest peaks and the level in a few frequency bands.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "stdint.h"
+#include "stdbool.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Window size, log2 of the number of points (0 = off)
+#define SPECTRUM_OFF              0
+#define SPECTRUM_POINTS_256       8
+#define SPECTRUM_POINTS_512       9
+#define SPECTRUM_MAX_POINTS       512
+
+// Input: one accelerometer axis or the length of the vector
+#define SPECTRUM_AXIS_X           0
+#define SPECTRUM_AXIS_Y           1
+#define SPECTRUM_AXIS_Z           2
+#define SPECTRUM_AXIS_NORM        3
+
+// Result size
+#define SPECTRUM_PEAKS            4
+#define SPECTRUM_BANDS            4
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Peaks are sorted by magnitude, largest first; bin k is at k * rate / N Hz.
+// Magnitudes are amplitudes and band levels RMS values, both in LSB.
+typedef struct
+{
+  uint16_t peakBin[SPECTRUM_PEAKS];
+  uint16_t peakMag[SPECTRUM_PEAKS];
+  uint16_t bandRms[SPECTRUM_BANDS];
+} SpectrumResult_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Select the window size and input, discarding the current window
+ */
+extern void Spectrum_init(uint8_t log2Points, uint8_t axis);
+
+/*
+ * Add one accelerometer sample (X, Y, Z) to the window. Returns true when
+ * the window is complete; further samples are ignored until it has been
+ * processed by Spectrum_compute.
+ */
+extern bool Spectrum_addSample(const int16_t *acc);
+
+/*
+ * Transform the complete window and start a new one
+ */
+extern void Spectrum_compute(SpectrumResult_t *result);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPECTRUM_H */
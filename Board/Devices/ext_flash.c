@@ -35,9 +35,12 @@
 *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *
 *******************************************************************************/
+#include <ti/sysbios/knl/Clock.h>
+
 #include "Board.h"
 #include "bsp_spi.h"
 #include "ext_flash.h"
+#include "string.h"
 
 /*
  * Implementation for WinBond W25X20CL Flash
@@ -48,6 +51,7 @@
 
 #define BLS_CODE_PROGRAM          0x02 /**< Page Program */
 #define BLS_CODE_READ             0x03 /**< Read Data */
+#define BLS_CODE_FAST_READ        0x0B /**< Fast Read (8 dummy cycles) */
 #define BLS_CODE_READ_STATUS      0x05 /**< Read Status Register */
 #define BLS_CODE_WRITE_ENABLE     0x06 /**< Write Enable */
 #define BLS_CODE_SECTOR_ERASE     0x20 /**< Sector Erase */
@@ -73,10 +77,20 @@
 /* Part specific constants */
 #define BLS_PROGRAM_PAGE_SIZE     256
 #define BLS_ERASE_SECTOR_SIZE     4096
+#define BLS_READ_MAX_RATE         33000000 /**< fR, Read Data clock limit */
+
+/* Reads of at least this size use Fast Read; the dummy byte is negligible */
+#define BLS_FAST_READ_MIN         64
+
+/* SPI bit rate used for the flash */
+#ifndef EXT_FLASH_BIT_RATE
+#define EXT_FLASH_BIT_RATE        BSP_SPI_BIT_RATE_MAX
+#endif
 
 // Private functions
 static int extFlashWaitReady(void);
 static int extFlashWaitPowerDown(void);
+static uint32_t extFlashRate(size_t length, uint32_t ticks);
 
 /* -----------------------------------------------------------------------------
 *                           Local variables
@@ -258,6 +272,23 @@ static int extFlashWaitPowerDown(void)
   return -1;
 }
 
+/**
+ * Convert a transfer of length bytes in a number of clock ticks to a rate.
+ * @return Rate in bytes per second.
+ */
+static uint32_t extFlashRate(size_t length, uint32_t ticks)
+{
+  uint32_t us;
+
+  us = ticks * Clock_tickPeriod;
+  if (us == 0)
+  {
+    us = 1;
+  }
+
+  return (uint32_t)(((uint64_t)length * 1000000) / us);
+}
+
 /**
  * Enable write.
  * @return Zero when successful.
@@ -290,6 +321,7 @@ bool extFlashOpen(void)
 
   /* Make sure SPI is available */
   bspSpiOpen();
+  bspSpiSetBitRate(EXT_FLASH_BIT_RATE);
 
   /* Put the part is standby mode */
   extFlashPowerStandby();
@@ -317,7 +349,8 @@ void extFlashClose(void)
 /* See ext_flash.h file for description */
 bool extFlashRead(size_t offset, size_t length, uint8_t *buf)
 {
-  uint8_t wbuf[4];
+  uint8_t wbuf[5];
+  size_t wlen;
 
   /* Wait till previous erase/program operation completes */
   int ret = extFlashWaitReady();
@@ -326,17 +359,28 @@ bool extFlashRead(size_t offset, size_t length, uint8_t *buf)
     return false;
   }
 
-  /* SPI is driven with very low frequency (1MHz < 33MHz fR spec)
-   * in this temporary implementation.
-   * and hence it is not necessary to use fast read. */
-  wbuf[0] = BLS_CODE_READ;
+  /* Read Data is limited to fR; Fast Read adds one dummy byte after the
+   * address and is valid up to the maximum clock of the part. Use it for
+   * long sequential reads and whenever the bus is faster than fR. */
   wbuf[1] = (offset >> 16) & 0xff;
   wbuf[2] = (offset >> 8) & 0xff;
   wbuf[3] = offset & 0xff;
 
+  if (length >= BLS_FAST_READ_MIN || bspSpiGetBitRate() > BLS_READ_MAX_RATE)
+  {
+    wbuf[0] = BLS_CODE_FAST_READ;
+    wbuf[4] = 0xFF;
+    wlen = 5;
+  }
+  else
+  {
+    wbuf[0] = BLS_CODE_READ;
+    wlen = 4;
+  }
+
   extFlashSelect();
 
-  if (bspSpiWrite(wbuf, sizeof(wbuf)))
+  if (bspSpiWrite(wbuf, wlen))
   {
     /* failure */
     extFlashDeselect();
@@ -466,6 +510,76 @@ bool extFlashErase(size_t offset, size_t length)
   return true;
 }
 
+/* See ext_flash.h file for description */
+bool extFlashBenchmark(size_t offset, size_t length, uint8_t *buf,
+                       size_t bufLen, extFlashBenchmark_t *result)
+{
+  uint32_t t;
+  size_t i, j, n;
+
+  memset(result, 0, sizeof(*result));
+  if (length == 0 || bufLen == 0)
+  {
+    return false;
+  }
+
+  /* Erase; includes the wait for the last sector */
+  t = Clock_getTicks();
+  if (!extFlashErase(offset, length) || extFlashWaitReady())
+  {
+    return false;
+  }
+  result->eraseRate = extFlashRate(length, Clock_getTicks() - t);
+
+  /* Program a known pattern */
+  for (i = 0; i < bufLen; i++)
+  {
+    buf[i] = (uint8_t)i;
+  }
+
+  t = Clock_getTicks();
+  for (i = 0; i < length; i += n)
+  {
+    n = length - i < bufLen ? length - i : bufLen;
+    if (!extFlashWrite(offset + i, n, buf))
+    {
+      return false;
+    }
+  }
+  if (extFlashWaitReady())
+  {
+    return false;
+  }
+  result->programRate = extFlashRate(length, Clock_getTicks() - t);
+
+  /* Read back, timing excludes the verification */
+  t = 0;
+  for (i = 0; i < length; i += n)
+  {
+    uint32_t t0;
+
+    n = length - i < bufLen ? length - i : bufLen;
+
+    t0 = Clock_getTicks();
+    if (!extFlashRead(offset + i, n, buf))
+    {
+      return false;
+    }
+    t += Clock_getTicks() - t0;
+
+    for (j = 0; j < n; j++)
+    {
+      if (buf[j] != (uint8_t)j)
+      {
+        return false;
+      }
+    }
+  }
+  result->readRate = extFlashRate(length, t);
+
+  return true;
+}
+
 /* See ext_flash.h file for description */
 bool extFlashTest(void)
 {
@@ -40,9 +40,18 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define EXT_FLASH_PAGE_SIZE   4096
 
+/* Result of extFlashBenchmark, all rates in bytes per second */
+typedef struct
+{
+  uint32_t readRate;
+  uint32_t programRate;
+  uint32_t eraseRate;
+} extFlashBenchmark_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -81,6 +90,17 @@ extern bool extFlashErase(size_t offset, size_t length);
 */
 extern bool extFlashWrite(size_t offset, size_t length, const uint8_t *buf);
 
+/**
+* Measure erase, program and read throughput over a range of the flash.
+* The range is erased and overwritten with a test pattern; buf is used as
+* work buffer, each program and read instruction transfers up to bufLen
+* bytes. Must be called with the flash open.
+*
+* @return True when successful and the pattern reads back correctly.
+*/
+extern bool extFlashBenchmark(size_t offset, size_t length, uint8_t *buf,
+                              size_t bufLen, extFlashBenchmark_t *result);
+
 /**
 * Test the flash (power on self-test)
 *
@@ -99,6 +99,19 @@
 #define OSRST(v)                            ((v) << 5)
 #define OSRSP(v)                            ((v) << 2)
 
+// Bit fields in CONFIG register
+#define T_SB(v)                             ((v) << 5)
+#define FILTER(v)                           ((v) << 2)
+
+// Conversion time (us): fixed part, per sample and pressure overhead
+#define CONV_TIME_BASE                      1250
+#define CONV_TIME_SAMPLE                    2300
+#define CONV_TIME_PRESS                     575
+
+// Little endian 16 bit word of the calibration data
+#define CAL_WORD(d,i)                       ((uint16_t)(d)[2*(i)] | \
+                                             ((uint16_t)(d)[2*(i)+1] << 8))
+
 // Sensor selection/deselection
 #define SENSOR_SELECT()     bspI2cSelect(BSP_I2C_INTERFACE_0,SENSOR_I2C_ADDRESS)
 #define SENSOR_DESELECT()   bspI2cDeselect()
@@ -120,19 +133,26 @@ typedef struct {
 	int16_t dig_P7;
 	int16_t dig_P8;
 	int16_t dig_P9;
-	int32_t t_fine;
 } Bmp280Calibration_t;
 
 /* -----------------------------------------------------------------------------
 *                                           Local Functions
 * ------------------------------------------------------------------------------
 */
+static void sensorBmp280CalParse(const uint8_t *calData);
 
 /* -----------------------------------------------------------------------------
 *                                           Local Variables
 * ------------------------------------------------------------------------------
 */
-static uint8_t calData[CALIB_DATA_SIZE];
+
+// Calibration, read once from the sensor
+static Bmp280Calibration_t calib;
+static bool calibValid;
+
+// Measurement and filter settings (CTRL_MEAS and CONFIG registers)
+static uint8_t ctrlMeas = PM_NORMAL | OSRSP(BMP_OSRS_X8) | OSRST(BMP_OSRS_X1);
+static uint8_t config = T_SB(BMP_STANDBY_0_5MS) | FILTER(BMP_FILTER_OFF);
 
 /*******************************************************************************
  * @fn          sensorBmp280Init
@@ -145,12 +165,23 @@ bool sensorBmp280Init(void)
 {
   bool ret;
   uint8_t val;
+  uint8_t calData[CALIB_DATA_SIZE];
 
   if (!SENSOR_SELECT())
     return false;
 
-  // Read and store calibration data
-  ret = sensorReadReg( ADDR_CALIB, calData, CALIB_DATA_SIZE);
+  // Read and store calibration data; it is fixed, so read only once
+  ret = true;
+  if (!calibValid)
+  {
+    ret = sensorReadReg( ADDR_CALIB, calData, CALIB_DATA_SIZE);
+
+    if (ret)
+    {
+      sensorBmp280CalParse(calData);
+      calibValid = true;
+    }
+  }
 
   if (ret)
   {
@@ -168,7 +199,9 @@ bool sensorBmp280Init(void)
 /*******************************************************************************
  * @fn          sensorBmp280Enable
  *
- * @brief       Enable/disable measurements
+ * @brief       Enable/disable measurements. In forced mode enabling starts
+ *              one conversion, after which the sensor sleeps again; in
+ *              normal mode the sensor converts until disabled.
  *
  * @param       enable - flag to turn the sensor on/off
  *
@@ -178,24 +211,92 @@ void sensorBmp280Enable(bool enable)
 {
   uint8_t val;
 
+  if (!SENSOR_SELECT())
+    return;
+
   if (enable)
   {
-    // Enable forced mode; pressure oversampling 4; temp. oversampling 1
-    val = PM_NORMAL | OSRSP(4) | OSRST(1);
+    // Filter and standby time; only accepted while the sensor sleeps,
+    // which it does when disabled and between forced conversions
+    sensorWriteReg(ADDR_CONFIG, &config, sizeof(config));
+    val = ctrlMeas;
   }
   else
   {
     val = PM_OFF;
   }
 
-  if (!SENSOR_SELECT())
-    return;
-
   sensorWriteReg(ADDR_CTRL_MEAS, &val, sizeof(val));
   SENSOR_DESELECT();
 }
 
 
+/*******************************************************************************
+ * @fn          sensorBmp280Configure
+ *
+ * @brief       Select the measurement mode, oversampling, IIR filter and
+ *              standby time. Takes effect the next time the sensor is
+ *              enabled.
+ *
+ * @param       mode - BMP_MODE_FORCED or BMP_MODE_NORMAL
+ *
+ * @param       osrsT - temperature oversampling, BMP_OSRS_X1 .. BMP_OSRS_X16
+ *
+ * @param       osrsP - pressure oversampling, BMP_OSRS_SKIP .. BMP_OSRS_X16
+ *
+ * @param       filter - IIR filter, BMP_FILTER_OFF .. BMP_FILTER_16
+ *
+ * @param       standby - time between conversions in normal mode,
+ *                        BMP_STANDBY_0_5MS .. BMP_STANDBY_4000MS
+ *
+ * @return      true if the settings are valid
+ */
+bool sensorBmp280Configure(uint8_t mode, uint8_t osrsT, uint8_t osrsP,
+                           uint8_t filter, uint8_t standby)
+{
+  // Temperature is always measured, it is needed for the compensation
+  if ((mode != BMP_MODE_FORCED && mode != BMP_MODE_NORMAL) ||
+      osrsT < BMP_OSRS_X1 || osrsT > BMP_OSRS_X16 ||
+      osrsP > BMP_OSRS_X16 || filter > BMP_FILTER_16 ||
+      standby > BMP_STANDBY_4000MS)
+  {
+    return false;
+  }
+
+  ctrlMeas = mode | OSRSP(osrsP) | OSRST(osrsT);
+  config = T_SB(standby) | FILTER(filter);
+
+  return true;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorBmp280ConversionTime
+ *
+ * @brief       Maximum time of one conversion with the current oversampling
+ *
+ * @return      conversion time (ms, rounded up)
+ */
+uint16_t sensorBmp280ConversionTime(void)
+{
+  uint8_t osrsT;
+  uint8_t osrsP;
+  uint32_t t;
+
+  osrsT = (ctrlMeas >> 5) & 0x07;
+  osrsP = (ctrlMeas >> 2) & 0x07;
+
+  // Number of samples is 2^(osrs - 1), none if skipped
+  t = CONV_TIME_BASE + CONV_TIME_SAMPLE * (1 << (osrsT - 1));
+  if (osrsP != BMP_OSRS_SKIP)
+  {
+    t += CONV_TIME_SAMPLE * (1 << (osrsP - 1)) + CONV_TIME_PRESS;
+  }
+
+  return (uint16_t)((t + 999) / 1000);
+}
+
+
 /*******************************************************************************
  * @fn          sensorBmp280Read
  *
@@ -230,27 +331,76 @@ bool sensorBmp280Read(uint8_t *data)
 }
 
 
+/*******************************************************************************
+ * @fn          sensorBmp280ReadBatch
+ *
+ * @brief       Prepare a batch entry that reads temperature and pressure
+ *              data, see bspI2cBatchSubmit (interface 0)
+ *
+ * @param       op - batch entry
+ * @param       data - buffer for temperature and pressure (6 bytes)
+ *
+ * @return      none
+ */
+void sensorBmp280ReadBatch(bspI2cBatchOp_t *op, uint8_t *data)
+{
+  bspI2cBatchRead(op, SENSOR_I2C_ADDRESS, ADDR_PRESS_MSB, data, BMP_DATA_SIZE);
+}
+
+
+/*******************************************************************************
+ * @fn          sensorBmp280ReadDone
+ *
+ * @brief       Validate the data of a completed batch entry
+ *
+ * @param       op - batch entry prepared by sensorBmp280ReadBatch
+ * @param       data - buffer for temperature and pressure (6 bytes)
+ *
+ * @return      TRUE if valid data
+ */
+bool sensorBmp280ReadDone(bspI2cBatchOp_t *op, uint8_t *data)
+{
+  bool success;
+
+  success = op->success;
+
+  if (success)
+  {
+    // Validate data
+    success = !(data[0]==0x80 && data[1]==0x00 && data[2]==0x00);
+  }
+
+  if (!success)
+  {
+    sensorSetErrorData(data,BMP_DATA_SIZE);
+  }
+
+  return success;
+}
+
+
 /*******************************************************************************
  * @fn          sensorBmp280Convert
  *
- * @brief       Convert raw data to object and ambience temperature
+ * @brief       Convert raw data to temperature and pressure, using the
+ *              integer compensation of the BMP280 data sheet and the cached
+ *              calibration. Reentrant; only reads the calibration.
  *
  * @param       data - raw data from sensor
  *
- * @param       temp - converted temperature
+ * @param       temp - converted temperature (0.01 degrees C)
  *
- * @param       press - converted pressure
+ * @param       press - converted pressure (Pa), 0 if not calibrated
  *
  * @return      none
  ******************************************************************************/
 void sensorBmp280Convert(uint8_t *data, int32_t *temp, uint32_t *press)
 {
   int32_t utemp, upress;
-  Bmp280Calibration_t *p = (Bmp280Calibration_t *)calData;
-	int32_t v_x1_u32r;
-	int32_t v_x2_u32r;
+  const Bmp280Calibration_t *p = &calib;
+  int32_t v1, v2;
   int32_t t_fine;
-	uint32_t pressure;
+  int64_t w1, w2, pressure;
 
   // Pressure
   upress = (int32_t)((((uint32_t)(data[0])) << 12) |
@@ -261,41 +411,65 @@ void sensorBmp280Convert(uint8_t *data, int32_t *temp, uint32_t *press)
                     (((uint32_t)(data[4])) << 4) | ((uint32_t)data[5] >> 4));
 
   // Compensate temperature
-	v_x1_u32r  = ((((utemp >> 3) - ((int32_t)p->dig_T1 << 1))) *
-                ((int32_t)p->dig_T2)) >> 11;
-	v_x2_u32r  = (((((utemp >> 4) - ((int32_t)p->dig_T1)) *
-                  ((utemp >> 4) - ((int32_t)p->dig_T1))) >> 12) *
-                ((int32_t)p->dig_T3)) >> 14;
-	t_fine = v_x1_u32r + v_x2_u32r;
+  v1 = ((((utemp >> 3) - ((int32_t)p->dig_T1 << 1))) *
+        ((int32_t)p->dig_T2)) >> 11;
+  v2 = (((((utemp >> 4) - ((int32_t)p->dig_T1)) *
+          ((utemp >> 4) - ((int32_t)p->dig_T1))) >> 12) *
+        ((int32_t)p->dig_T3)) >> 14;
+  t_fine = v1 + v2;
   *temp = (int32_t)((t_fine * 5 + 128) >> 8);
 
-  // Compensate pressure
-	v_x1_u32r = (((int32_t)t_fine) >> 1) - (int32_t)64000;
-	v_x2_u32r = (((v_x1_u32r >> 2) * (v_x1_u32r >> 2)) >> 11) *
-    ((int32_t)p->dig_P6);
-	v_x2_u32r = v_x2_u32r + ((v_x1_u32r * ((int32_t)p->dig_P5)) << 1);
-	v_x2_u32r = (v_x2_u32r >> 2) + (((int32_t)p->dig_P4) << 16);
-	v_x1_u32r = (((p->dig_P3 * (((v_x1_u32r >> 2) *
-                 (v_x1_u32r >> 2)) >> 13)) >> 3) +
-                  ((((int32_t)p->dig_P2) * v_x1_u32r) >> 1)) >> 18;
-	v_x1_u32r = ((((32768+v_x1_u32r)) * ((int32_t)p->dig_P1))	>> 15);
-
-	if (v_x1_u32r == 0)
-		return; /* Avoid exception caused by division by zero */
-
-	pressure = (((uint32_t)(((int32_t)1048576) - upress) -
-               (v_x2_u32r >> 12))) * 3125;
-	if (pressure < 0x80000000)
-		pressure = (pressure << 1) / ((uint32_t)v_x1_u32r);
-	else
-		pressure = (pressure / (uint32_t)v_x1_u32r) * 2;
-	v_x1_u32r = (((int32_t)p->dig_P9) *
-               ((int32_t)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
-	v_x2_u32r = (((int32_t)(pressure >> 2)) * ((int32_t)p->dig_P8)) >> 13;
-	pressure = (uint32_t)((int32_t)pressure +
-                        ((v_x1_u32r + v_x2_u32r + p->dig_P7) >> 4));
-
-  *press = pressure;
+  // Compensate pressure (64 bit, Q24.8); the 32 bit variant of the data
+  // sheet is off by a few Pa
+  w1 = (int64_t)t_fine - 128000;
+  w2 = w1 * w1 * (int64_t)p->dig_P6;
+  w2 = w2 + ((w1 * (int64_t)p->dig_P5) << 17);
+  w2 = w2 + (((int64_t)p->dig_P4) << 35);
+  w1 = ((w1 * w1 * (int64_t)p->dig_P3) >> 8) +
+       ((w1 * (int64_t)p->dig_P2) << 12);
+  w1 = ((((int64_t)1) << 47) + w1) * ((int64_t)p->dig_P1) >> 33;
+
+  if (w1 == 0)
+  {
+    // Avoid exception caused by division by zero
+    *press = 0;
+    return;
+  }
+
+  pressure = 1048576 - upress;
+  pressure = (((pressure << 31) - w2) * 3125) / w1;
+  w1 = (((int64_t)p->dig_P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+  w2 = (((int64_t)p->dig_P8) * pressure) >> 19;
+  pressure = ((pressure + w1 + w2) >> 8) + (((int64_t)p->dig_P7) << 4);
+
+  // Round to Pa
+  *press = (uint32_t)((pressure + 128) >> 8);
+}
+
+/*******************************************************************************
+ * @fn          sensorBmp280CalParse
+ *
+ * @brief       Store the calibration data (little endian words T1-T3,
+ *              P1-P9)
+ *
+ * @param       calData - calibration data read from the sensor
+ *
+ * @return      none
+ ******************************************************************************/
+static void sensorBmp280CalParse(const uint8_t *calData)
+{
+  calib.dig_T1 = CAL_WORD(calData, 0);
+  calib.dig_T2 = (int16_t)CAL_WORD(calData, 1);
+  calib.dig_T3 = (int16_t)CAL_WORD(calData, 2);
+  calib.dig_P1 = CAL_WORD(calData, 3);
+  calib.dig_P2 = (int16_t)CAL_WORD(calData, 4);
+  calib.dig_P3 = (int16_t)CAL_WORD(calData, 5);
+  calib.dig_P4 = (int16_t)CAL_WORD(calData, 6);
+  calib.dig_P5 = (int16_t)CAL_WORD(calData, 7);
+  calib.dig_P6 = (int16_t)CAL_WORD(calData, 8);
+  calib.dig_P7 = (int16_t)CAL_WORD(calData, 9);
+  calib.dig_P8 = (int16_t)CAL_WORD(calData, 10);
+  calib.dig_P9 = (int16_t)CAL_WORD(calData, 11);
 }
 
 /*******************************************************************************
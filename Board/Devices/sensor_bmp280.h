@@ -47,12 +47,42 @@ extern "C"
  */
 #include "stdint.h"
 #include "stdbool.h"
+#include "bsp_i2c.h"
 
 /*********************************************************************
  * CONSTANTS
  */
 #define BMP_DATA_SIZE           6
 
+// Power modes
+#define BMP_MODE_FORCED         1
+#define BMP_MODE_NORMAL         3
+
+// Oversampling (temperature and pressure)
+#define BMP_OSRS_SKIP           0
+#define BMP_OSRS_X1             1
+#define BMP_OSRS_X2             2
+#define BMP_OSRS_X4             3
+#define BMP_OSRS_X8             4
+#define BMP_OSRS_X16            5
+
+// IIR filter coefficient
+#define BMP_FILTER_OFF          0
+#define BMP_FILTER_2            1
+#define BMP_FILTER_4            2
+#define BMP_FILTER_8            3
+#define BMP_FILTER_16           4
+
+// Standby time between conversions in normal mode
+#define BMP_STANDBY_0_5MS       0
+#define BMP_STANDBY_62_5MS      1
+#define BMP_STANDBY_125MS       2
+#define BMP_STANDBY_250MS       3
+#define BMP_STANDBY_500MS       4
+#define BMP_STANDBY_1000MS      5
+#define BMP_STANDBY_2000MS      6
+#define BMP_STANDBY_4000MS      7
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -62,7 +92,12 @@ extern "C"
  */
 bool sensorBmp280Init(void);
 void sensorBmp280Enable(bool enable);
+bool sensorBmp280Configure(uint8_t mode, uint8_t osrsT, uint8_t osrsP,
+                           uint8_t filter, uint8_t standby);
+uint16_t sensorBmp280ConversionTime(void);
 bool sensorBmp280Read(uint8_t *pBuf);
+void sensorBmp280ReadBatch(bspI2cBatchOp_t *op, uint8_t *pBuf);
+bool sensorBmp280ReadDone(bspI2cBatchOp_t *op, uint8_t *pBuf);
 void sensorBmp280Convert(uint8_t *raw, int32_t *temp, uint32_t *press);
 bool sensorBmp280Test(void);
 
@@ -65,6 +65,18 @@
 #define HDC1000_VAL_DEV_ID         0x1000
 #define HDC1000_VAL_CONFIG         0x1000 // 14 bit, acquired in sequence
 
+// Configuration register fields
+#define HDC1000_CFG_TRES(r)        ((r) << 10)
+#define HDC1000_CFG_HRES(r)        ((r) << 8)
+
+// Typical conversion times (us) and margin (1/x) added to them
+#define CONV_TIME_TEMP_14BIT       6350
+#define CONV_TIME_TEMP_11BIT       3650
+#define CONV_TIME_HUM_14BIT        6500
+#define CONV_TIME_HUM_11BIT        3850
+#define CONV_TIME_HUM_8BIT         2500
+#define CONV_TIME_MARGIN           10
+
 // Sensor selection/de-selection
 #define SENSOR_SELECT()     bspI2cSelect(BSP_I2C_INTERFACE_0,SENSOR_I2C_ADDRESS)
 #define SENSOR_DESELECT()   bspI2cDeselect()
@@ -91,6 +103,20 @@ typedef struct
 static bool  success;
 static SensorData_t data;
 
+// Resolution of the sequential acquisition
+static uint8_t tempResolution = HDC1000_RES_14BIT;
+static uint8_t humResolution = HDC1000_RES_14BIT;
+
+static const uint16_t tempConvTime[] =
+{
+  CONV_TIME_TEMP_14BIT, CONV_TIME_TEMP_11BIT
+};
+
+static const uint16_t humConvTime[] =
+{
+  CONV_TIME_HUM_14BIT, CONV_TIME_HUM_11BIT, CONV_TIME_HUM_8BIT
+};
+
 /*******************************************************************************
 * @fn          sensorHdc1000Init
 *
@@ -106,7 +132,9 @@ bool sensorHdc1000Init(void)
     return false;
 
   // Enable reading data in one operation
-  val = SWAP(HDC1000_VAL_CONFIG);
+  val = HDC1000_VAL_CONFIG | HDC1000_CFG_TRES(tempResolution)
+    | HDC1000_CFG_HRES(humResolution);
+  val = SWAP(val);
   success = sensorWriteReg(HDC1000_REG_CONFIG,(uint8_t*)&val,2);
 
   SENSOR_DESELECT();
@@ -114,6 +142,48 @@ bool sensorHdc1000Init(void)
   return success;
 }
 
+/*******************************************************************************
+* @fn          sensorHdc1000Configure
+*
+* @brief       Set the resolution of the temperature and humidity
+*              measurements (acquired in sequence)
+*
+* @param       tempRes - temperature resolution (14 or 11 bit)
+*
+* @param       humRes - humidity resolution (14, 11 or 8 bit)
+*
+* @return      true if valid resolution and I2C operation successful
+*******************************************************************************/
+bool sensorHdc1000Configure(uint8_t tempRes, uint8_t humRes)
+{
+  if (tempRes > HDC1000_RES_11BIT || humRes > HDC1000_RES_8BIT)
+  {
+    return false;
+  }
+
+  tempResolution = tempRes;
+  humResolution = humRes;
+
+  return sensorHdc1000Init();
+}
+
+/*******************************************************************************
+* @fn          sensorHdc1000ConversionTime
+*
+* @brief       Time from start of measurement until both results are ready
+*
+* @return      conversion time (ms, rounded up)
+*******************************************************************************/
+uint16_t sensorHdc1000ConversionTime(void)
+{
+  uint32_t t;
+
+  t = tempConvTime[tempResolution] + humConvTime[humResolution];
+  t += t / CONV_TIME_MARGIN;
+
+  return (uint16_t)((t + 999) / 1000);
+}
+
 /*******************************************************************************
 * @fn          sensorHdc1000Start
 *
@@ -179,20 +249,21 @@ bool sensorHdc1000Read(uint16_t *rawTemp, uint16_t *rawHum)
 *
 * @param       rawHum - raw humidity value
 *
-* @param       temp - converted temperature
+* @param       temp - converted temperature (0.01 C)
 *
-* @param       hum - converted humidity
+* @param       hum - converted humidity (0.01 %RH)
 *
 * @return      none
 *******************************************************************************/
 void sensorHdc1000Convert(uint16_t rawTemp, uint16_t rawHum,
-                        float *temp, float *hum)
+                        int16_t *temp, uint16_t *hum)
 {
-  //-- calculate temperature [C]
-  *temp = ((double)(int16_t)rawTemp / 65536)*165 - 40;
+  //-- calculate temperature [0.01 C], T = raw / 2^16 * 165 - 40
+  *temp = (int16_t)((((uint32_t)rawTemp * 165 * FIXED_SCALE) + 0x8000) >> 16)
+    - 40 * FIXED_SCALE;
 
-  //-- calculate relative humidity [%RH]
-  *hum = ((double)rawHum / 65536)*100;
+  //-- calculate relative humidity [0.01 %RH], RH = raw / 2^16 * 100
+  *hum = (uint16_t)((((uint32_t)rawHum * 100 * FIXED_SCALE) + 0x8000) >> 16);
 }
 
 
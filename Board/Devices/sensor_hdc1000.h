@@ -52,13 +52,20 @@ extern "C"
  * CONSTANTS
  */
 
+// Measurement resolution (8 bit for humidity only)
+#define HDC1000_RES_14BIT       0
+#define HDC1000_RES_11BIT       1
+#define HDC1000_RES_8BIT        2
+
 /*********************************************************************
  * FUNCTIONS
  */
 bool sensorHdc1000Init(void);
+bool sensorHdc1000Configure(uint8_t tempRes, uint8_t humRes);
+uint16_t sensorHdc1000ConversionTime(void);
 void sensorHdc1000Start(void);
 bool sensorHdc1000Read(uint16_t *rawHum, uint16_t *rawTemp);
-void sensorHdc1000Convert(uint16_t rawHum, uint16_t rawTemp, float *temp, float *hum);
+void sensorHdc1000Convert(uint16_t rawTemp, uint16_t rawHum, int16_t *temp, uint16_t *hum);
 bool sensorHdc1000Test(void);
 
 /*********************************************************************/
@@ -44,6 +44,8 @@
 #include "sensor_opt3001.h" // For reset of I2C bus
 #include "sensor.h"
 #include "bsp_i2c.h"
+#include "string.h"
+#include <driverlib/aon_rtc.h>
 
 /* -----------------------------------------------------------------------------
 *                                           Constants
@@ -76,8 +78,19 @@
 #define LP_ACCEL_ODR                  0x1E // R/W
 #define WOM_THR                       0x1F // R/W
 #define FIFO_EN                       0x23 // R/W
+#define I2C_MST_CTRL                  0x24 // R/W
+#define I2C_SLV0_ADDR                 0x25 // R/W
+#define I2C_SLV0_REG                  0x26 // R/W
+#define I2C_SLV0_CTRL                 0x27 // R/W
+#define I2C_SLV1_ADDR                 0x28 // R/W
+#define I2C_SLV1_REG                  0x29 // R/W
+#define I2C_SLV1_CTRL                 0x2A // R/W
 
-// .. registers 0x24 - 0x36 are not applicable to the SensorTag HW configuration
+// .. registers 0x2B - 0x33 are not applicable to the SensorTag HW configuration
+
+#define I2C_SLV4_CTRL                 0x34 // R/W
+
+// .. registers 0x35 - 0x36 are not applicable to the SensorTag HW configuration
 
 #define INT_PIN_CFG                   0x37 // R/W
 #define INT_ENABLE                    0x38 // R/W
@@ -97,8 +110,16 @@
 #define GYRO_ZOUT_H                   0x47 // R
 #define GYRO_ZOUT_L                   0x48 // R
 
-// .. registers 0x49 - 0x60 are not applicable to the SensorTag HW configuration
-// .. registers 0x63 - 0x67 are not applicable to the SensorTag HW configuration
+#define EXT_SENS_DATA_00              0x49 // R
+
+// .. registers 0x4A - 0x60 are not applicable to the SensorTag HW configuration
+// .. register 0x63 is not applicable to the SensorTag HW configuration
+
+#define I2C_SLV1_DO                   0x64 // R/W
+
+// .. registers 0x65 - 0x66 are not applicable to the SensorTag HW configuration
+
+#define I2C_MST_DELAY_CTRL            0x67 // R/W
 
 #define SIGNAL_PATH_RESET             0x68 // R/W
 #define ACCEL_INTEL_CTRL              0x69 // R/W
@@ -125,6 +146,14 @@
 
 // Data sizes
 #define DATA_SIZE                     6
+#define MAG_DATA_SIZE                 7     // X/Y/Z + ST2
+#define TEMP_SIZE                     2
+
+// FIFO read-out: whole frames per I2C burst (limited by 8-bit length)
+#define FIFO_CHUNK_FRAMES             21
+
+// Internal sample rate when the DLPF is enabled (Hz)
+#define MPU_INTERNAL_RATE             1000
 
 // Output data rates
 #define INV_LPA_0_3125HZ              0
@@ -158,11 +187,35 @@
 // User control register
 #define BIT_LATCH_EN                  0x20
 #define BIT_ACTL                      0x80
+#define BIT_FIFO_EN                   0x40
+#define BIT_FIFO_RST                  0x04
+#define BIT_I2C_MST_EN                0x20
+
+// Configuration register: stop writing to the FIFO when full
+#define BIT_FIFO_MODE                 0x40
+
+// FIFO enable register
+#define BIT_FIFO_GYRO_XYZ             0x70
+#define BIT_FIFO_ACCEL                0x08
+#define FIFO_SELECT                   (BIT_FIFO_GYRO_XYZ | BIT_FIFO_ACCEL)
 
 // INT Pin / Bypass Enable Configuration
 #define BIT_BYPASS_EN                 0x02
 #define BIT_AUX_IF_EN                 0x20
 
+// Auxiliary I2C master
+#define I2C_MST_CLK_400KHZ            0x0D
+#define BIT_WAIT_FOR_ES               0x40  // Data ready waits for slave data
+#define BIT_SLV_READ                  0x80
+#define BIT_SLV_EN                    0x80
+#define BIT_SLV0_DLY_EN               0x01
+#define BIT_SLV1_DLY_EN               0x02
+#define I2C_MST_DLY_MAX               31
+
+// Magnetometer continuous mode rates (Hz)
+#define MAG_CONT1_RATE                8
+#define MAG_CONT2_RATE                100
+
 // Magnetometer registers
 #define MAG_WHO_AM_I                  0x00  // Should return 0x48
 #define MAG_INFO                      0x01
@@ -221,6 +274,13 @@ static void sensorMpu9250_Callback(PIN_Handle handle, PIN_Id pinId);
 static void sensorMagInit(void);
 static void sensorMagEnable(bool);
 static bool sensorMpu9250SetBypass(void);
+static bool sensorMpu9250FifoReset(void);
+static bool sensorMagAuxStart(void);
+static void sensorMagAuxStop(void);
+static uint8_t sensorMagAuxDelay(void);
+static bool sensorMpu9250SetRate(uint8_t div);
+static uint8_t sensorMpu9250DlpfSelect(uint16_t bw);
+static uint8_t sensorMagConvert(uint8_t *rawData, int16_t *data);
 
 /* -----------------------------------------------------------------------------
 *                           Local Variables
@@ -230,6 +290,7 @@ static uint8_t mpuConfig;
 static uint8_t magStatus;
 static uint8_t accRange;
 static uint8_t accRangeReg;
+static uint8_t gyroRange = GYR_RANGE_250DPS;
 static uint8_t val;
 
 // Magnetometer calibration
@@ -241,6 +302,55 @@ static int16_t calZ;
 static uint8_t scale = MFS_16BITS;      // 16 bit resolution
 static uint8_t mode = MAG_MODE_SINGLE;  // Operating mode
 
+// Filter bandwidth limits (Hz, 0 = none) and filter selection
+static uint16_t accBandwidth;
+static uint16_t gyroBandwidth;
+static uint8_t dlpfSel = MPU_DLPF_AUTO;
+
+// Full scale per range setting: accelerometer (G), gyroscope (deg/s)
+static const uint8_t accFullScale[] = { 2, 4, 8, 16 };
+static const uint16_t gyroFullScale[] = { 250, 500, 1000, 2000 };
+
+// Filters from wide to narrow, with the lowest sample rate that keeps each
+// bandwidth below half the sample rate
+static const struct
+{
+  uint16_t minRate;    // Hz
+  uint8_t bandwidth;   // Hz
+  uint8_t dlpf;
+} dlpfTable[] =
+{
+  { 200, 92, MPU_DLPF_92HZ },
+  { 100, 41, MPU_DLPF_41HZ },
+  {  50, 20, MPU_DLPF_20HZ },
+  {  20, 10, MPU_DLPF_10HZ },
+  {   0,  5, MPU_DLPF_5HZ  },
+};
+#define DLPF_TABLE_SIZE   (sizeof(dlpfTable) / sizeof(dlpfTable[0]))
+
+// Interrupt pin configuration (latched unless the FIFO is running)
+static uint8_t intPinCfg = BIT_BYPASS_EN | BIT_LATCH_EN;
+
+// Data ready pulses per call-back (0 = no decimation, e.g. wake on motion)
+static volatile uint8_t intDecimation;
+static volatile uint8_t intCount;
+
+// Data ready time stamps (AON RTC), written by the ISR only. The indices
+// run freely; the ring size divides 256.
+static uint32_t tsRing[MPU_TS_RING_SIZE];
+static volatile uint8_t tsHead;
+static uint8_t tsTail;
+
+// Shadow of USER_CTRL (FIFO and auxiliary I2C master enable)
+static uint8_t userCtrl;
+
+// Internal sample rate (Hz), paces the auxiliary I2C master
+static uint16_t sampleRate;
+
+// Magnetometer via the auxiliary I2C master: selected / running
+static bool magAux;
+static bool magAuxOn;
+
 // Pins that are used by the MPU9250
 static PIN_Config MpuPinTable[] =
 {
@@ -352,6 +462,11 @@ bool sensorMpu9250Reset(void)
   accRange = ACC_RANGE_INVALID;
   mpuConfig = 0;   // All axes off
   magStatus = 0;
+  intDecimation = 0;
+  intPinCfg = BIT_BYPASS_EN | BIT_LATCH_EN;
+  userCtrl = 0;
+  sampleRate = 8000;   // DLPF off after reset
+  magAuxOn = false;
 
   if (!SENSOR_SELECT())
   {
@@ -473,260 +588,733 @@ uint8_t sensorMpu9250IntStatus(void)
 }
 
 /*******************************************************************************
-* @fn          sensorMpu9250Enable
+* @fn          sensorMpu9250FifoEnable
 *
-* @brief       Enable accelerometer readout
+* @brief       Let the MPU collect gyro and accelerometer samples in its FIFO
+*              at a hardware timed rate. The registered call-back is invoked
+*              once every 'watermark' samples; the MPU has no FIFO level
+*              interrupt so the data ready pulses are counted in the ISR.
 *
-* @param       Axes: Gyro bitmap [0..2], X = 1, Y = 2, Z = 4. 0 = gyro off
-* @                  Acc  bitmap [3..5], X = 8, Y = 16, Z = 32. 0 = accelerometer off
-*                    MPU  bit [6], all axes
+* @param       rate - sample rate in Hz (MPU_FIFO_MIN_RATE - MPU_FIFO_MAX_RATE)
 *
-* @return      None
+* @param       watermark - number of samples per call-back (1 - MPU_FIFO_MAX_FRAMES)
+*
+* @return      True if success
 */
-void sensorMpu9250Enable(uint16_t axes)
+bool sensorMpu9250FifoEnable(uint16_t rate, uint8_t watermark)
 {
-  ST_ASSERT_V(sensorMpu9250PowerIsOn());
-
-  if (mpuConfig == 0 && axes != 0)
+  if (rate < MPU_FIFO_MIN_RATE || rate > MPU_FIFO_MAX_RATE ||
+      watermark == 0 || watermark > MPU_FIFO_MAX_FRAMES)
   {
-    // Wake up the sensor if it was off
-    sensorMpu9250WakeUp();
+    return false;
   }
 
-  mpuConfig = axes;
+  ST_ASSERT(sensorMpu9250PowerIsOn());
 
-  if (mpuConfig != 0)
-  {
-    // Enable gyro + accelerometer + magnetometer readout
-    sensorMpu9250SelectAxes();
-  }
-  else if (mpuConfig == 0)
+  // Make sure pin interrupt is disabled while reconfiguring
+  PIN_setInterrupt(hMpuPin, PIN_ID(Board_MPU_INT)|PIN_IRQ_DIS);
+
+  // Samples per call-back, also paces single compass measurements
+  intCount = 0;
+  intDecimation = watermark;
+
+  if (!SENSOR_SELECT())
   {
-     sensorMpuSleep();
+    return false;
   }
-}
 
+  // Stop and flush the FIFO
+  val = 0;
+  ST_ASSERT(sensorWriteReg(FIFO_EN, &val, 1));
+  userCtrl &= ~BIT_FIFO_EN;
+  val = userCtrl | BIT_FIFO_RST;
+  ST_ASSERT(sensorWriteReg(USER_CTRL, &val, 1));
+
+  // Sample rate = internal rate / (1 + SMPLRT_DIV)
+  ST_ASSERT(sensorMpu9250SetRate((MPU_INTERNAL_RATE / rate) - 1));
+
+  // Pulsed data ready interrupt, one edge per sample
+  intPinCfg = BIT_BYPASS_EN;
+  val = magAuxOn ? (intPinCfg & ~BIT_BYPASS_EN) : intPinCfg;
+  ST_ASSERT(sensorWriteReg(INT_PIN_CFG, &val, 1));
+
+  val = BIT_RAW_RDY_EN;
+  ST_ASSERT(sensorWriteReg(INT_ENABLE, &val, 1));
+
+  // Start collecting gyro and accelerometer data
+  userCtrl |= BIT_FIFO_EN;
+  ST_ASSERT(sensorWriteReg(USER_CTRL, &userCtrl, 1));
+  val = FIFO_SELECT;
+  ST_ASSERT(sensorWriteReg(FIFO_EN, &val, 1));
+
+  // Clear interrupt
+  sensorReadReg(INT_STATUS,&val,1);
+
+  SENSOR_DESELECT();
+
+  sensorMpu9250TimestampFlush();
+
+  // Enable pin for data ready interrupt
+  PIN_setInterrupt(hMpuPin, PIN_ID(Board_MPU_INT)|PIN_IRQ_POSEDGE);
+
+  return true;
+}
 
 /*******************************************************************************
-* @fn          sensorMpu9250AccSetRange
+* @fn          sensorMpu9250DataRdyEnable
 *
-* @brief       Set the range of the accelerometer
+* @brief       Let the MPU pace the register read-out. The sample rate
+*              divider and DLPF are programmed for the requested period and
+*              the registered call-back is invoked from the data ready
+*              interrupt, once per period. Periods longer than the slowest
+*              sample rate are obtained by counting data ready pulses.
+*              Faster sampling would cost interrupts without giving more
+*              data; the FIFO does that.
 *
-* @param       newRange: ACC_RANGE_2G, ACC_RANGE_4G, ACC_RANGE_8G, ACC_RANGE_16G
+* @param       period - read-out period in ms (MPU_DRDY_MIN_PERIOD -
+*                       MPU_DRDY_MAX_PERIOD)
 *
-* @return      true if write succeeded
+* @return      True if success
 */
-bool sensorMpu9250AccSetRange(uint8_t newRange)
+bool sensorMpu9250DataRdyEnable(uint16_t period)
 {
-  bool success;
+  uint16_t n;
+  uint8_t div;
 
-  if (newRange == accRange)
+  if (period < MPU_DRDY_MIN_PERIOD || period > MPU_DRDY_MAX_PERIOD)
   {
-    return true;
+    return false;
   }
 
   ST_ASSERT(sensorMpu9250PowerIsOn());
 
+  // Fewest pulses per period that give an exact sample interval (ms)
+  for (n = (period + 255) / 256; n < 255 && (period % n) != 0; n++)
+  {
+  }
+  if ((period % n) != 0)
+  {
+    n = (period + 255) / 256;
+  }
+  div = (period + n / 2) / n - 1;
+
+  // Make sure pin interrupt is disabled while reconfiguring
+  PIN_setInterrupt(hMpuPin, PIN_ID(Board_MPU_INT)|PIN_IRQ_DIS);
+
+  // Samples per call-back, also paces single compass measurements
+  intCount = 0;
+  intDecimation = n;
+
   if (!SENSOR_SELECT())
   {
     return false;
   }
 
-  accRangeReg = (newRange << 3);
+  // Register read-out, no FIFO
+  val = 0;
+  ST_ASSERT(sensorWriteReg(FIFO_EN, &val, 1));
+  userCtrl &= ~BIT_FIFO_EN;
+  ST_ASSERT(sensorWriteReg(USER_CTRL, &userCtrl, 1));
+
+  ST_ASSERT(sensorMpu9250SetRate(div));
+
+  // Pulsed data ready interrupt, one edge per sample
+  intPinCfg = BIT_BYPASS_EN;
+  val = magAuxOn ? (intPinCfg & ~BIT_BYPASS_EN) : intPinCfg;
+  ST_ASSERT(sensorWriteReg(INT_PIN_CFG, &val, 1));
+
+  val = BIT_RAW_RDY_EN;
+  ST_ASSERT(sensorWriteReg(INT_ENABLE, &val, 1));
+
+  // Clear interrupt
+  sensorReadReg(INT_STATUS,&val,1);
 
-  // Apply the range
-  success = sensorWriteReg(ACCEL_CONFIG, &accRangeReg, 1);
   SENSOR_DESELECT();
 
-  if (success)
-  {
-    accRange = newRange;
-  }
+  sensorMpu9250TimestampFlush();
 
-  return success;
+  // Enable pin for data ready interrupt
+  PIN_setInterrupt(hMpuPin, PIN_ID(Board_MPU_INT)|PIN_IRQ_POSEDGE);
+
+  return true;
 }
 
 /*******************************************************************************
-* @fn          sensorMpu9250AccReadRange
+* @fn          sensorMpu9250TimestampRead
 *
-* @brief       Apply the selected accelerometer range
+* @brief       Fetch data ready time stamps, oldest first. One time stamp is
+*              latched per sample, also when the call-back is decimated. If
+*              more than MPU_TS_RING_SIZE samples are pending only the most
+*              recent ones are kept.
 *
-* @param       none
+* @param       ts - buffer for time stamps (AON RTC, 16.16 seconds)
 *
-* @return      range: ACC_RANGE_2G, ACC_RANGE_4G, ACC_RANGE_8G, ACC_RANGE_16G
+* @param       maxTs - maximum number of time stamps to fetch
+*
+* @return      Number of time stamps fetched
 */
-uint8_t sensorMpu9250AccReadRange(void)
+uint8_t sensorMpu9250TimestampRead(uint32_t *ts, uint8_t maxTs)
 {
-  ST_ASSERT(sensorMpu9250PowerIsOn());
+  uint8_t head;
+  uint8_t n;
 
-  if (!SENSOR_SELECT())
+  head = tsHead;
+  if ((uint8_t)(head - tsTail) > MPU_TS_RING_SIZE)
   {
-    return false;
+    // Overrun; skip the overwritten entries
+    tsTail = head - MPU_TS_RING_SIZE;
   }
 
-  // Apply the range
-  sensorReadReg(ACCEL_CONFIG, &accRangeReg, 1);
-  SENSOR_DESELECT();
-
-  accRange = (accRangeReg>>3) & 3;
+  for (n = 0; n < maxTs && tsTail != head; n++)
+  {
+    ts[n] = tsRing[tsTail % MPU_TS_RING_SIZE];
+    tsTail++;
+  }
 
-  return accRange;
+  return n;
 }
 
-
 /*******************************************************************************
-* @fn          sensorMpu9250AccRead
+* @fn          sensorMpu9250TimestampFlush
 *
-* @brief       Read data from the accelerometer - X, Y, Z - 3 words
+* @brief       Discard pending data ready time stamps
 *
-* @return      True if data is valid
+* @return      none
 */
-bool sensorMpu9250AccRead(uint16_t *data )
+void sensorMpu9250TimestampFlush(void)
 {
-  bool success;
-
-  ST_ASSERT(sensorMpu9250PowerIsOn());
+  tsTail = tsHead;
+}
 
-  // Burst read of all accelerometer values
-  if (!SENSOR_SELECT())
+/*******************************************************************************
+* @fn          sensorMpu9250SetBandwidth
+*
+* @brief       Select the low pass filter of the accelerometer and gyroscope.
+*              The sample rate is set by the read-out period or the FIFO
+*              rate. MPU_DLPF_AUTO takes the widest filter below half the
+*              sample rate, further limited per sensor by a bandwidth.
+*              Applied the next time hardware timed read-out is enabled.
+*
+* @param       accBw - accelerometer bandwidth limit in Hz (0 = none)
+*
+* @param       gyroBw - gyroscope bandwidth limit in Hz (0 = none)
+*
+* @param       dlpf - MPU_DLPF_AUTO or a fixed MPU_DLPF_xxx bandwidth
+*
+* @return      True if the settings are valid
+*/
+bool sensorMpu9250SetBandwidth(uint16_t accBw, uint16_t gyroBw, uint8_t dlpf)
+{
+  if ((accBw > 0 && (accBw < MPU_BW_MIN || accBw > MPU_BW_MAX)) ||
+      (gyroBw > 0 && (gyroBw < MPU_BW_MIN || gyroBw > MPU_BW_MAX)) ||
+      dlpf > MPU_DLPF_5HZ)
   {
     return false;
   }
 
-  success = sensorReadReg(ACCEL_XOUT_H, (uint8_t*)data, DATA_SIZE);
-  SENSOR_DESELECT();
+  accBandwidth = accBw;
+  gyroBandwidth = gyroBw;
+  dlpfSel = dlpf;
 
-  if (success)
-  {
-    convertToLe((uint8_t*)data,DATA_SIZE);
-  }
+  return true;
+}
 
-  return success;
+/*******************************************************************************
+* @fn          sensorMpu9250DataRdyDisable
+*
+* @brief       Stop hardware timed read-out (FIFO or data ready interrupt)
+*
+* @return      none
+*/
+void sensorMpu9250DataRdyDisable(void)
+{
+  sensorMpu9250FifoDisable();
 }
 
 /*******************************************************************************
-* @fn          sensorMpu9250GyroRead
+* @fn          sensorMpu9250FifoDisable
 *
-* @brief       Read data from the gyroscope - X, Y, Z - 3 words
+* @brief       Stop FIFO collection and return to register read-out
 *
-* @return      TRUE if valid data, FALSE if not
+* @return      none
 */
-bool sensorMpu9250GyroRead(uint16_t *data )
+void sensorMpu9250FifoDisable(void)
 {
-  bool success;
+  PIN_setInterrupt(hMpuPin, PIN_ID(Board_MPU_INT)|PIN_IRQ_DIS);
+  intDecimation = 0;
+  intPinCfg = BIT_BYPASS_EN | BIT_LATCH_EN;
 
-  ST_ASSERT(sensorMpu9250PowerIsOn());
+  ST_ASSERT_V(sensorMpu9250PowerIsOn());
 
-  // Select this sensor
   if (!SENSOR_SELECT())
   {
-    return false;
+    return;
   }
 
-  // Burst read of all gyroscope values
-  success = sensorReadReg(GYRO_XOUT_H, (uint8_t*)data, DATA_SIZE);
-
-  SENSOR_DESELECT();
+  val = 0;
+  ST_ASSERT_V(sensorWriteReg(FIFO_EN, &val, 1));
+  ST_ASSERT_V(sensorWriteReg(INT_ENABLE, &val, 1));
+  userCtrl &= ~BIT_FIFO_EN;
+  ST_ASSERT_V(sensorWriteReg(USER_CTRL, &userCtrl, 1));
+  val = magAuxOn ? (intPinCfg & ~BIT_BYPASS_EN) : intPinCfg;
+  ST_ASSERT_V(sensorWriteReg(INT_PIN_CFG, &val, 1));
 
-  if (success)
-  {
-    convertToLe((uint8_t*)data,DATA_SIZE);
-  }
+  // Clear interrupt
+  sensorReadReg(INT_STATUS,&val,1);
 
-  return success;
+  SENSOR_DESELECT();
 }
 
-
 /*******************************************************************************
- * @fn          sensorMpu9250Test
- *
- * @brief       Run a sensor self-test
- *
- * @return      TRUE if passed, FALSE if failed
- */
-bool sensorMpu9250Test(void)
+* @fn          sensorMpu9250FifoRead
+*
+* @brief       Drain complete frames from the FIFO in as few bursts as
+*              possible. Each frame is stored as gyro X/Y/Z followed by
+*              accelerometer X/Y/Z, little endian (same layout as the
+*              register read-out). On overflow or misalignment the complete
+*              frames are returned and the FIFO is flushed.
+*
+* @param       data - buffer for at least maxFrames frames
+*
+* @param       maxFrames - maximum number of frames to read
+*
+* @param       nFrames - number of frames read
+*
+* @return      FIFO status
+*/
+uint8_t sensorMpu9250FifoRead(uint16_t *data, uint8_t maxFrames,
+                              uint8_t *nFrames)
 {
-  static bool first = true;
+  uint8_t status;
+  uint8_t rawData[MPU_FIFO_FRAME_SIZE];
+  uint8_t *p;
+  uint16_t count;
+  uint8_t n;
+  uint8_t i;
 
-  ST_ASSERT(sensorMpu9250PowerIsOn());
+  *nFrames = 0;
 
-  // Select Gyro/Accelerometer
-  if (!SENSOR_SELECT())
+  if (!sensorMpu9250PowerIsOn())
   {
-    return false;
+    return MPU_FIFO_READ_ERR;
   }
 
-  // Make sure power is ramped up
-  if (first)
+  if (!SENSOR_SELECT())
   {
-    delay_ms(100);
-    first = false;
+    return MPU_FIFO_READ_ERR;
   }
 
-  // Check the WHO AM I register
-  ST_ASSERT(sensorReadReg(WHO_AM_I, &val, 1));
-  ST_ASSERT(val == 0x71);
+  // Number of bytes in the FIFO (13 bits, big endian)
+  if (!sensorReadReg(FIFO_COUNT_H, rawData, 2))
+  {
+    SENSOR_DESELECT();
+    return MPU_FIFO_READ_ERR;
+  }
+  count = ((rawData[0] & 0x1F) << 8) | rawData[1];
 
-  SENSOR_DESELECT();
+  status = MPU_FIFO_OK;
+  if (count > MPU_FIFO_SIZE - MPU_FIFO_FRAME_SIZE)
+  {
+    // No room for another frame; samples have been dropped
+    status = MPU_FIFO_OVERFLOW;
+  }
+  else if (count % MPU_FIFO_FRAME_SIZE != 0)
+  {
+    status = MPU_FIFO_MISALIGNED;
+  }
 
-  return true;
-}
+  count /= MPU_FIFO_FRAME_SIZE;
+  if (count > maxFrames)
+  {
+    count = maxFrames;
+  }
 
+  // Burst read of complete frames
+  p = (uint8_t*)data;
+  while (*nFrames < count)
+  {
+    n = count - *nFrames;
+    if (n > FIFO_CHUNK_FRAMES)
+    {
+      n = FIFO_CHUNK_FRAMES;
+    }
 
-/*******************************************************************************
- * @fn          sensorMpu9250AccConvert
- *
- * @brief       Convert raw data to G units
- *
- * @param       rawData - raw data from sensor
- *
- * @return      Converted value
- ******************************************************************************/
-float sensorMpu9250AccConvert(int16_t rawData)
-{
-  float v;
+    if (!sensorReadReg(FIFO_R_W, p, n * MPU_FIFO_FRAME_SIZE))
+    {
+      status = MPU_FIFO_READ_ERR;
+      break;
+    }
 
-  switch (accRange)
-  {
-  case ACC_RANGE_2G:
-    //-- calculate acceleration, unit G, range -2, +2
-    v = (rawData * 1.0) / (32768/2);
-    break;
+    // Device order is accelerometer then gyro, big endian
+    for (i = 0; i < n; i++)
+    {
+      memcpy(rawData, p, MPU_FIFO_FRAME_SIZE);
+      memcpy(p, &rawData[DATA_SIZE], DATA_SIZE);
+      memcpy(p + DATA_SIZE, rawData, DATA_SIZE);
+      convertToLe(p, MPU_FIFO_FRAME_SIZE);
+      p += MPU_FIFO_FRAME_SIZE;
+    }
 
-  case ACC_RANGE_4G:
-    //-- calculate acceleration, unit G, range -4, +4
-    v = (rawData * 1.0) / (32768/4);
-    break;
+    *nFrames += n;
+  }
 
-  case ACC_RANGE_8G:
-    //-- calculate acceleration, unit G, range -8, +8
-    v = (rawData * 1.0) / (32768/8);
-    break;
+  SENSOR_DESELECT();
 
-  case ACC_RANGE_16G:
-    //-- calculate acceleration, unit G, range -16, +16
-    v = (rawData * 1.0) / (32768/16);
-    break;
+  if (status != MPU_FIFO_OK)
+  {
+    // Start over with an empty, aligned FIFO
+    sensorMpu9250FifoReset();
   }
 
-  return v;
+  return status;
 }
 
 /*******************************************************************************
- * @fn          sensorMpu9250GyroConvert
- *
- * @brief       Convert raw data to deg/sec units
- *
- * @param       data - raw data from sensor
- *
- * @return      none
- ******************************************************************************/
-float sensorMpu9250GyroConvert(int16_t data)
-{
-  //-- calculate rotation, unit deg/s, range -250, +250
-  return (data * 1.0) / (65536 / 500);
-}
-
+* @fn          sensorMpu9250Enable
+*
+* @brief       Enable accelerometer readout
+*
+* @param       Axes: Gyro bitmap [0..2], X = 1, Y = 2, Z = 4. 0 = gyro off
+* @                  Acc  bitmap [3..5], X = 8, Y = 16, Z = 32. 0 = accelerometer off
+*                    MPU  bit [6], all axes
+*
+* @return      None
+*/
+void sensorMpu9250Enable(uint16_t axes)
+{
+  ST_ASSERT_V(sensorMpu9250PowerIsOn());
+
+  if (mpuConfig == 0 && axes != 0)
+  {
+    // Wake up the sensor if it was off
+    sensorMpu9250WakeUp();
+  }
+
+  mpuConfig = axes;
+
+  if (mpuConfig != 0)
+  {
+    // Enable gyro + accelerometer + magnetometer readout
+    sensorMpu9250SelectAxes();
+  }
+  else if (mpuConfig == 0)
+  {
+     sensorMpuSleep();
+  }
+}
+
+
+/*******************************************************************************
+* @fn          sensorMpu9250AccSetRange
+*
+* @brief       Set the range of the accelerometer
+*
+* @param       newRange: ACC_RANGE_2G, ACC_RANGE_4G, ACC_RANGE_8G, ACC_RANGE_16G
+*
+* @return      true if write succeeded
+*/
+bool sensorMpu9250AccSetRange(uint8_t newRange)
+{
+  bool success;
+
+  if (newRange == accRange)
+  {
+    return true;
+  }
+
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  accRangeReg = (newRange << 3);
+
+  // Apply the range
+  success = sensorWriteReg(ACCEL_CONFIG, &accRangeReg, 1);
+  SENSOR_DESELECT();
+
+  if (success)
+  {
+    accRange = newRange;
+  }
+
+  return success;
+}
+
+/*******************************************************************************
+* @fn          sensorMpu9250GyroSetRange
+*
+* @brief       Set the range of the gyroscope. The range is kept when the
+*              MPU is powered down and restored when it wakes up.
+*
+* @param       newRange: GYR_RANGE_250DPS, GYR_RANGE_500DPS,
+*                        GYR_RANGE_1000DPS, GYR_RANGE_2000DPS
+*
+* @return      true if write succeeded
+*/
+bool sensorMpu9250GyroSetRange(uint8_t newRange)
+{
+  bool success;
+
+  if (newRange > GYR_RANGE_2000DPS)
+  {
+    return false;
+  }
+
+  gyroRange = newRange;
+
+  // Applied on wake-up if not running
+  if (!sensorMpu9250PowerIsOn() || mpuConfig == 0)
+  {
+    return true;
+  }
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // Full scale select; FCHOICE_B = 0 keeps the DLPF in use
+  val = gyroRange << 3;
+  success = sensorWriteReg(GYRO_CONFIG, &val, 1);
+  SENSOR_DESELECT();
+
+  return success;
+}
+
+/*******************************************************************************
+* @fn          sensorMpu9250GyroReadRange
+*
+* @brief       Return the selected gyroscope range
+*
+* @return      range: GYR_RANGE_250DPS .. GYR_RANGE_2000DPS
+*/
+uint8_t sensorMpu9250GyroReadRange(void)
+{
+  return gyroRange;
+}
+
+/*******************************************************************************
+* @fn          sensorMpu9250AccReadRange
+*
+* @brief       Apply the selected accelerometer range
+*
+* @param       none
+*
+* @return      range: ACC_RANGE_2G, ACC_RANGE_4G, ACC_RANGE_8G, ACC_RANGE_16G
+*/
+uint8_t sensorMpu9250AccReadRange(void)
+{
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // Apply the range
+  sensorReadReg(ACCEL_CONFIG, &accRangeReg, 1);
+  SENSOR_DESELECT();
+
+  accRange = (accRangeReg>>3) & 3;
+
+  return accRange;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMpu9250AccRead
+*
+* @brief       Read data from the accelerometer - X, Y, Z - 3 words
+*
+* @return      True if data is valid
+*/
+bool sensorMpu9250AccRead(uint16_t *data )
+{
+  bool success;
+
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  // Burst read of all accelerometer values
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  success = sensorReadReg(ACCEL_XOUT_H, (uint8_t*)data, DATA_SIZE);
+  SENSOR_DESELECT();
+
+  if (success)
+  {
+    convertToLe((uint8_t*)data,DATA_SIZE);
+  }
+
+  return success;
+}
+
+/*******************************************************************************
+* @fn          sensorMpu9250MovRead
+*
+* @brief       Read gyroscope, accelerometer and (when collected by the
+*              auxiliary I2C master) magnetometer data in a single burst.
+*              Output layout: gyro X/Y/Z, acc X/Y/Z, mag X/Y/Z - 9 words.
+*              The magnetometer status is updated.
+*
+* @return      True if data is valid
+*/
+bool sensorMpu9250MovRead(uint16_t *data)
+{
+  uint8_t rawData[DATA_SIZE + TEMP_SIZE + DATA_SIZE + MAG_DATA_SIZE];
+  uint8_t len;
+  bool success;
+
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  // Accelerometer, temperature, gyro and external sensor data are contiguous
+  len = DATA_SIZE + TEMP_SIZE + DATA_SIZE;
+  if (magAuxOn)
+  {
+    len += MAG_DATA_SIZE;
+  }
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  success = sensorReadReg(ACCEL_XOUT_H, rawData, len);
+  SENSOR_DESELECT();
+
+  if (success)
+  {
+    // Same order as the separate read-outs: gyro first
+    memcpy(&data[0], &rawData[DATA_SIZE + TEMP_SIZE], DATA_SIZE);
+    memcpy(&data[3], &rawData[0], DATA_SIZE);
+    convertToLe((uint8_t*)data, DATA_SIZE * 2);
+
+    if (magAuxOn)
+    {
+      magStatus = sensorMagConvert(&rawData[DATA_SIZE * 2 + TEMP_SIZE],
+                                   (int16_t*)&data[6]);
+    }
+    else
+    {
+      magStatus = MAG_DATA_NOT_RDY;
+    }
+  }
+
+  return success;
+}
+
+/*******************************************************************************
+* @fn          sensorMpu9250GyroRead
+*
+* @brief       Read data from the gyroscope - X, Y, Z - 3 words
+*
+* @return      TRUE if valid data, FALSE if not
+*/
+bool sensorMpu9250GyroRead(uint16_t *data )
+{
+  bool success;
+
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  // Select this sensor
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // Burst read of all gyroscope values
+  success = sensorReadReg(GYRO_XOUT_H, (uint8_t*)data, DATA_SIZE);
+
+  SENSOR_DESELECT();
+
+  if (success)
+  {
+    convertToLe((uint8_t*)data,DATA_SIZE);
+  }
+
+  return success;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorMpu9250Test
+ *
+ * @brief       Run a sensor self-test
+ *
+ * @return      TRUE if passed, FALSE if failed
+ */
+bool sensorMpu9250Test(void)
+{
+  static bool first = true;
+
+  ST_ASSERT(sensorMpu9250PowerIsOn());
+
+  // Select Gyro/Accelerometer
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // Make sure power is ramped up
+  if (first)
+  {
+    delay_ms(100);
+    first = false;
+  }
+
+  // Check the WHO AM I register
+  ST_ASSERT(sensorReadReg(WHO_AM_I, &val, 1));
+  ST_ASSERT(val == 0x71);
+
+  SENSOR_DESELECT();
+
+  return true;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorMpu9250AccConvert
+ *
+ * @brief       Convert raw data to G units
+ *
+ * @param       rawData - raw data from sensor
+ *
+ * @return      Converted value (0.01 G)
+ ******************************************************************************/
+int16_t sensorMpu9250AccConvert(int16_t rawData)
+{
+  if (accRange > ACC_RANGE_16G)
+  {
+    return 0;
+  }
+
+  //-- calculate acceleration, unit 0.01 G, range -fs, +fs
+  return (int16_t)FIXED_DIV_POW2((int32_t)rawData * accFullScale[accRange]
+                                 * FIXED_SCALE, 15);
+}
+
+/*******************************************************************************
+ * @fn          sensorMpu9250GyroConvert
+ *
+ * @brief       Convert raw data to deg/sec units
+ *
+ * @param       data - raw data from sensor
+ *
+ * @return      Converted value (0.01 deg/s)
+ ******************************************************************************/
+int32_t sensorMpu9250GyroConvert(int16_t data)
+{
+  //-- calculate rotation, unit 0.01 deg/s, range -fs, +fs; the scale
+  //-- 100/32768 is applied as 25/8192 to stay within 32 bits at 2000 deg/s
+  return FIXED_DIV_POW2((int32_t)data * gyroFullScale[gyroRange]
+                        * (FIXED_SCALE / 4), 13);
+}
+
 
 
 /*******************************************************************************
@@ -742,6 +1330,12 @@ static void sensorMpuSleep(void)
 
   ST_ASSERT_V(sensorMpu9250PowerIsOn());
 
+  if (magAuxOn)
+  {
+    // Stop continuous compass conversions
+    sensorMagEnable(false);
+  }
+
   if (!SENSOR_SELECT())
   {
     return;
@@ -791,9 +1385,15 @@ static void sensorMpu9250WakeUp(void)
 
   if (success)
   {
-    // Restore the range
+    // Restore the ranges
     success = sensorWriteReg(ACCEL_CONFIG, &accRangeReg, 1);
 
+    if (success)
+    {
+      val = gyroRange << 3;
+      success = sensorWriteReg(GYRO_CONFIG, &val, 1);
+    }
+
     if (success)
     {
       // Clear interrupts
@@ -842,8 +1442,7 @@ static bool sensorMpu9250SetBypass(void)
 
   if (SENSOR_SELECT())
   {
-    val = BIT_BYPASS_EN | BIT_LATCH_EN;
-    success = sensorWriteReg(INT_PIN_CFG, &val, 1);
+    success = sensorWriteReg(INT_PIN_CFG, &intPinCfg, 1);
     delay_ms(10);
 
     SENSOR_DESELECT();
@@ -857,6 +1456,289 @@ static bool sensorMpu9250SetBypass(void)
 }
 
 
+/*******************************************************************************
+* @fn          sensorMpu9250FifoReset
+*
+* @brief       Flush the FIFO while keeping it enabled
+*
+* @return      True if success
+*/
+static bool sensorMpu9250FifoReset(void)
+{
+  bool success;
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  val = userCtrl | BIT_FIFO_RST;
+  success = sensorWriteReg(USER_CTRL, &val, 1);
+
+  SENSOR_DESELECT();
+
+  // Pending time stamps belong to discarded samples
+  sensorMpu9250TimestampFlush();
+
+  return success;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMagAuxDelay
+*
+* @brief       Number of samples to skip between two compass reads by the
+*              auxiliary I2C master, so that it polls at the compass rate.
+*              In single measurement mode it polls once per read-out (as
+*              slowly as possible if the read-out is not hardware timed),
+*              but not faster than the compass converts.
+*
+* @return      I2C_MST_DLY value
+*/
+static uint8_t sensorMagAuxDelay(void)
+{
+  uint16_t n;
+  uint16_t readout;
+
+  n = sampleRate / (mode == MAG_MODE_CONT1 ? MAG_CONT1_RATE : MAG_CONT2_RATE);
+  if (mode == MAG_MODE_SINGLE)
+  {
+    readout = intDecimation > 0 ? intDecimation : I2C_MST_DLY_MAX + 1;
+    if (readout > n)
+    {
+      n = readout;
+    }
+  }
+  if (n > I2C_MST_DLY_MAX)
+  {
+    n = I2C_MST_DLY_MAX + 1;
+  }
+
+  return n > 0 ? n - 1 : 0;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMpu9250SetRate
+*
+* @brief       Program the sample rate divider and a matching low pass filter
+*              for gyro and accelerometer. The sensor must be selected.
+*
+* @param       div - sample rate = MPU_INTERNAL_RATE / (1 + div)
+*
+* @return      True if success
+*/
+static bool sensorMpu9250SetRate(uint8_t div)
+{
+  sampleRate = MPU_INTERNAL_RATE / (div + 1);
+
+  if (!sensorWriteReg(SMPLRT_DIV, &div, 1))
+  {
+    return false;
+  }
+
+  // Gyro DLPF, drop new samples when the FIFO is full (keeps frames aligned)
+  val = BIT_FIFO_MODE | sensorMpu9250DlpfSelect(gyroBandwidth);
+  if (!sensorWriteReg(CONFIG, &val, 1))
+  {
+    return false;
+  }
+
+  // Accelerometer DLPF
+  val = sensorMpu9250DlpfSelect(accBandwidth);
+  if (!sensorWriteReg(ACCEL_CONFIG_2, &val, 1))
+  {
+    return false;
+  }
+
+  if (magAuxOn)
+  {
+    // Keep the compass polling rate
+    val = sensorMagAuxDelay();
+    return sensorWriteReg(I2C_SLV4_CTRL, &val, 1);
+  }
+
+  return true;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMpu9250DlpfSelect
+*
+* @brief       Filter setting for a sensor: the fixed selection if any,
+*              otherwise the widest filter below half of the sample rate
+*              and within the bandwidth limit of the sensor. The narrowest
+*              filter is taken if none qualifies.
+*
+* @param       bw - bandwidth limit in Hz (0 = none)
+*
+* @return      DLPF_CFG / A_DLPF_CFG value
+*/
+static uint8_t sensorMpu9250DlpfSelect(uint16_t bw)
+{
+  uint8_t i;
+
+  if (dlpfSel != MPU_DLPF_AUTO)
+  {
+    return dlpfSel;
+  }
+
+  for (i = 0; i < DLPF_TABLE_SIZE - 1; i++)
+  {
+    if (sampleRate >= dlpfTable[i].minRate &&
+        (bw == 0 || bw >= dlpfTable[i].bandwidth))
+    {
+      break;
+    }
+  }
+
+  return dlpfTable[i].dlpf;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMagAuxStart
+*
+* @brief       Start the compass in the selected mode and let the auxiliary
+*              I2C master copy its data to EXT_SENS_DATA, so that it is read
+*              together with the gyro and accelerometer. In single
+*              measurement mode the master starts the next measurement
+*              after each read. Bypass is turned off.
+*
+* @return      True if success
+*/
+static bool sensorMagAuxStart(void)
+{
+  bool success;
+  uint8_t delayCtrl;
+
+  if (!SENSOR_SELECT_MAG())
+  {
+    return false;
+  }
+
+  // Mode changes must go via power-down
+  val = MAG_MODE_OFF;
+  success = sensorWriteReg(MAG_CNTL1, &val, 1);
+  delay_ms(1);
+
+  if (success)
+  {
+    val = (scale << 4) | mode;
+    success = sensorWriteReg(MAG_CNTL1, &val, 1);
+  }
+  SENSOR_DESELECT();
+
+  if (!success || !SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // The compass is now only visible to the MPU
+  val = intPinCfg & ~BIT_BYPASS_EN;
+  ST_ASSERT(sensorWriteReg(INT_PIN_CFG, &val, 1));
+
+  // 400 kHz, data ready is delayed until the compass data is loaded
+  val = BIT_WAIT_FOR_ES | I2C_MST_CLK_400KHZ;
+  ST_ASSERT(sensorWriteReg(I2C_MST_CTRL, &val, 1));
+
+  // Slave 0: read X/Y/Z + ST2 (reading ST2 releases the data registers)
+  val = BIT_SLV_READ | SENSOR_MAG_I2_ADDRESS;
+  ST_ASSERT(sensorWriteReg(I2C_SLV0_ADDR, &val, 1));
+  val = MAG_XOUT_L;
+  ST_ASSERT(sensorWriteReg(I2C_SLV0_REG, &val, 1));
+  val = BIT_SLV_EN | MAG_DATA_SIZE;
+  ST_ASSERT(sensorWriteReg(I2C_SLV0_CTRL, &val, 1));
+  delayCtrl = BIT_SLV0_DLY_EN;
+
+  if (mode == MAG_MODE_SINGLE)
+  {
+    // Slave 1: write CNTL1 after the read, starting the next measurement
+    val = SENSOR_MAG_I2_ADDRESS;
+    ST_ASSERT(sensorWriteReg(I2C_SLV1_ADDR, &val, 1));
+    val = MAG_CNTL1;
+    ST_ASSERT(sensorWriteReg(I2C_SLV1_REG, &val, 1));
+    val = (scale << 4) | MAG_MODE_SINGLE;
+    ST_ASSERT(sensorWriteReg(I2C_SLV1_DO, &val, 1));
+    val = BIT_SLV_EN | 1;
+    ST_ASSERT(sensorWriteReg(I2C_SLV1_CTRL, &val, 1));
+    delayCtrl |= BIT_SLV1_DLY_EN;
+  }
+
+  // Reduced polling rate
+  val = sensorMagAuxDelay();
+  ST_ASSERT(sensorWriteReg(I2C_SLV4_CTRL, &val, 1));
+  ST_ASSERT(sensorWriteReg(I2C_MST_DELAY_CTRL, &delayCtrl, 1));
+
+  userCtrl |= BIT_I2C_MST_EN;
+  ST_ASSERT(sensorWriteReg(USER_CTRL, &userCtrl, 1));
+
+  SENSOR_DESELECT();
+
+  magAuxOn = true;
+
+  return true;
+}
+
+
+/*******************************************************************************
+* @fn          sensorMagAuxStop
+*
+* @brief       Stop the auxiliary I2C master. The caller restores bypass.
+*
+* @return      none
+*/
+static void sensorMagAuxStop(void)
+{
+  magAuxOn = false;
+  userCtrl &= ~BIT_I2C_MST_EN;
+
+  if (!SENSOR_SELECT())
+  {
+    return;
+  }
+
+  sensorWriteReg(USER_CTRL, &userCtrl, 1);
+  val = 0;
+  sensorWriteReg(I2C_SLV0_CTRL, &val, 1);
+  sensorWriteReg(I2C_SLV1_CTRL, &val, 1);
+
+  SENSOR_DESELECT();
+
+  // Let an ongoing auxiliary transaction complete
+  delay_ms(1);
+}
+
+
+/*******************************************************************************
+* @fn          sensorMagConvert
+*
+* @brief       Convert raw compass data (X/Y/Z little endian + ST2) and apply
+*              the sensitivity adjustment
+*
+* @return      Magnetometer status
+*/
+static uint8_t sensorMagConvert(uint8_t *rawData, int16_t *data)
+{
+  // Check if magnetic sensor overflow set, if not then report data
+  if (rawData[6] & 0x08)
+  {
+    return MAG_OVERFLOW;
+  }
+
+  data[0] = ((int16_t)rawData[1] << 8) | rawData[0];  // Turn the MSB and LSB into a signed 16-bit value
+  data[1] = ((int16_t)rawData[3] << 8) | rawData[2];  // Data stored as little Endian
+  data[2] = ((int16_t)rawData[5] << 8) | rawData[4];
+
+  // Sensitivity adjustment
+  data[0] = data[0] * calX >> 8;
+  data[1] = data[1] * calY >> 8;
+  data[2] = data[2] * calZ >> 8;
+
+  return MAG_STATUS_OK;
+}
+
+
 /*******************************************************************************
 * @fn          sensorMagInit
 *
@@ -910,6 +1792,11 @@ void sensorMpu9250MagReset(void)
 {
   ST_ASSERT_V(sensorMpu9250PowerIsOn());
 
+  if (magAuxOn)
+  {
+    sensorMagAuxStop();
+  }
+
   if (sensorMpu9250SetBypass())
   {
     if (SENSOR_SELECT_MAG())
@@ -920,13 +1807,18 @@ void sensorMpu9250MagReset(void)
       delay_ms(10);
 
       // Re-enable if already active
-      if (mpuConfig & MPU_AX_MAG)
+      if ((mpuConfig & MPU_AX_MAG) && !magAux)
       {
         val = (scale << 4) | mode;
         sensorWriteReg(MAG_CNTL1, &val, 1); // Set magnetometer data resolution and sample ODR
       }
       SENSOR_DESELECT();
     }
+
+    if ((mpuConfig & MPU_AX_MAG) && magAux)
+    {
+      sensorMagAuxStart();
+    }
   }
 }
 
@@ -944,12 +1836,22 @@ static void sensorMagEnable(bool enable)
 
   ST_ASSERT_V(sensorMpu9250PowerIsOn());
 
+  if (magAuxOn)
+  {
+    sensorMagAuxStop();
+  }
+
   if (!sensorMpu9250SetBypass())
   {
     return;
   }
 
-  if (SENSOR_SELECT_MAG())
+  if (enable && magAux)
+  {
+    // Continuous conversions collected by the auxiliary I2C master
+    sensorMagAuxStart();
+  }
+  else if (SENSOR_SELECT_MAG())
   {
     if (enable)
     {
@@ -967,6 +1869,76 @@ static void sensorMagEnable(bool enable)
   }
 }
 
+/*******************************************************************************
+ * @fn          sensorMpu9250MagAuxMode
+ *
+ * @brief       Select how the compass is read: via the auxiliary I2C master
+ *              of the MPU9250 (true) or directly in bypass mode (false)
+ *
+ * @return      none
+ */
+void sensorMpu9250MagAuxMode(bool enable)
+{
+  magAux = enable;
+
+  // Apply to a running compass
+  if (sensorMpu9250PowerIsOn() && (mpuConfig & MPU_AX_MAG))
+  {
+    sensorMagEnable(true);
+  }
+}
+
+
+/*******************************************************************************
+ * @fn          sensorMpu9250MagSetOdr
+ *
+ * @brief       Select the compass output data rate
+ *
+ * @param       odr - MAG_ODR_SINGLE (one measurement per read-out),
+ *                    MAG_ODR_8HZ or MAG_ODR_100HZ
+ *
+ * @return      True if the rate is valid
+ */
+bool sensorMpu9250MagSetOdr(uint8_t odr)
+{
+  uint8_t newMode;
+
+  switch (odr)
+  {
+  case MAG_ODR_SINGLE:
+    newMode = MAG_MODE_SINGLE;
+    break;
+  case MAG_ODR_8HZ:
+    newMode = MAG_MODE_CONT1;
+    break;
+  case MAG_ODR_100HZ:
+    newMode = MAG_MODE_CONT2;
+    break;
+  default:
+    return false;
+  }
+
+  if (newMode == mode)
+  {
+    return true;
+  }
+
+  if (sensorMpu9250PowerIsOn() && (mpuConfig & MPU_AX_MAG))
+  {
+    // Mode changes must go via power-down
+    sensorMagEnable(false);
+    mode = newMode;
+    sensorMagEnable(true);
+  }
+  else
+  {
+    mode = newMode;
+  }
+
+  return true;
+}
+
+
 /*******************************************************************************
  * @fn          sensorMpu9250MagTest
  *
@@ -976,8 +1948,18 @@ static void sensorMagEnable(bool enable)
  */
 bool sensorMpu9250MagTest(void)
 {
+  bool restart;
+  bool success;
+
   ST_ASSERT(sensorMpu9250PowerIsOn());
 
+  // Bypass is needed to access the compass directly
+  restart = magAuxOn;
+  if (restart)
+  {
+    sensorMagAuxStop();
+  }
+
   // Connect magnetometer internally in MPU9250
   sensorMpu9250SetBypass();
 
@@ -986,12 +1968,16 @@ bool sensorMpu9250MagTest(void)
 
   // Check the WHO AM I register
   val = 0xFF;
-  ST_ASSERT(sensorReadReg(MAG_WHO_AM_I, &val, 1));
-  ST_ASSERT(val == MAG_DEVICE_ID);
+  success = sensorReadReg(MAG_WHO_AM_I, &val, 1) && val == MAG_DEVICE_ID;
 
   SENSOR_DESELECT();
 
-  return true;
+  if (restart)
+  {
+    sensorMagAuxStart();
+  }
+
+  return success;
 }
 
 /*******************************************************************************
@@ -1011,10 +1997,31 @@ uint8_t sensorMpu9250MagRead(int16_t *data)
 
   magStatus = MAG_STATUS_OK;
 
+  if (magAuxOn)
+  {
+    // Latest data fetched by the auxiliary I2C master
+    if (!SENSOR_SELECT())
+    {
+      magStatus = MAG_READ_DATA_ERR;
+      return magStatus;
+    }
+
+    if (sensorReadReg(EXT_SENS_DATA_00, rawData, MAG_DATA_SIZE))
+    {
+      magStatus = sensorMagConvert(rawData, data);
+    }
+    else
+    {
+      magStatus = MAG_READ_DATA_ERR;
+    }
+    SENSOR_DESELECT();
+
+    return magStatus;
+  }
+
   // Connect magnetometer internally in MPU9250
   SENSOR_SELECT();
-  val = BIT_BYPASS_EN | BIT_LATCH_EN;
-  if (!sensorWriteReg(INT_PIN_CFG, &val, 1))
+  if (!sensorWriteReg(INT_PIN_CFG, &intPinCfg, 1))
   {
     magStatus = MAG_BYPASS_FAIL;
   }
@@ -1036,24 +2043,7 @@ uint8_t sensorMpu9250MagRead(int16_t *data)
       // Burst read of all compass values + ST2 register
       if (sensorReadReg(MAG_XOUT_L, &rawData[0],7))
       {
-        val = rawData[6]; // ST2 register
-
-        // Check if magnetic sensor overflow set, if not then report data
-        if(!(val & 0x08))
-        {
-          data[0] = ((int16_t)rawData[1] << 8) | rawData[0];  // Turn the MSB and LSB into a signed 16-bit value
-          data[1] = ((int16_t)rawData[3] << 8) | rawData[2];  // Data stored as little Endian
-          data[2] = ((int16_t)rawData[5] << 8) | rawData[4];
-
-          // Sensitivity adjustment
-          data[0] = data[0] * calX >> 8;
-          data[1] = data[1] * calY >> 8;
-          data[2] = data[2] * calZ >> 8;
-        }
-        else
-        {
-          magStatus = MAG_OVERFLOW;
-        }
+        magStatus = sensorMagConvert(rawData, data);
       }
       else
       {
@@ -1070,9 +2060,12 @@ uint8_t sensorMpu9250MagRead(int16_t *data)
     magStatus = MAG_READ_ST_ERR;
   }
 
-  // Start new conversion
-  val = (scale << 4) | mode;
-  sensorWriteReg(MAG_CNTL1, &val, 1); // Set magnetometer data resolution and sample ODR
+  if (mode == MAG_MODE_SINGLE)
+  {
+    // Start new conversion
+    val = (scale << 4) | mode;
+    sensorWriteReg(MAG_CNTL1, &val, 1); // Set magnetometer data resolution and sample ODR
+  }
 
   SENSOR_DESELECT();
 
@@ -1107,6 +2100,20 @@ static void sensorMpu9250_Callback(PIN_Handle handle, PIN_Id pinId)
 {
   if (pinId == Board_MPU_INT)
   {
+    // Time of the sample, before any decimation
+    tsRing[tsHead % MPU_TS_RING_SIZE] = AONRTCCurrentCompareValueGet();
+    tsHead++;
+
+    if (intDecimation > 0)
+    {
+      // Only wake the application at the FIFO watermark or read-out period
+      if (++intCount < intDecimation)
+      {
+        return;
+      }
+      intCount = 0;
+    }
+
     if (isrCallbackFn != NULL)
     {
       isrCallbackFn();
@@ -60,6 +60,30 @@ extern "C" {
 #define ACC_RANGE_16G     3
 #define ACC_RANGE_INVALID 0xFF
 
+// Gyroscope range
+#define GYR_RANGE_250DPS  0
+#define GYR_RANGE_500DPS  1
+#define GYR_RANGE_1000DPS 2
+#define GYR_RANGE_2000DPS 3
+
+// Low pass filter bandwidth (gyro and accelerometer)
+#define MPU_DLPF_AUTO     0     // Widest below half the sample rate
+#define MPU_DLPF_184HZ    1
+#define MPU_DLPF_92HZ     2
+#define MPU_DLPF_41HZ     3
+#define MPU_DLPF_20HZ     4
+#define MPU_DLPF_10HZ     5
+#define MPU_DLPF_5HZ      6
+
+// Bandwidth limit per sensor for MPU_DLPF_AUTO (Hz, 0 = none)
+#define MPU_BW_MIN        5
+#define MPU_BW_MAX        184
+
+// Magnetometer output data rate (Hz)
+#define MAG_ODR_SINGLE    0     // One measurement per read-out
+#define MAG_ODR_8HZ       8
+#define MAG_ODR_100HZ     100
+
 // Axis bitmaps
 #define MPU_AX_GYR        0x07
 #define MPU_AX_ACC        0x38
@@ -79,6 +103,28 @@ extern "C" {
 #define MAG_BYPASS_FAIL   0x05
 #define MAG_NO_POWER      0x06
 
+// FIFO frame: gyro X/Y/Z + accelerometer X/Y/Z (16 bit each)
+#define MPU_FIFO_FRAME_SIZE   12
+#define MPU_FIFO_SIZE         512
+#define MPU_FIFO_MAX_FRAMES   (MPU_FIFO_SIZE / MPU_FIFO_FRAME_SIZE)
+
+// FIFO sample rate limits (Hz)
+#define MPU_FIFO_MIN_RATE     4
+#define MPU_FIFO_MAX_RATE     1000
+
+// Data ready read-out period limits (ms)
+#define MPU_DRDY_MIN_PERIOD   1
+#define MPU_DRDY_MAX_PERIOD   (255 * 256)
+
+// Data ready time stamps kept by the driver (power of 2, max 128)
+#define MPU_TS_RING_SIZE      32
+
+// FIFO status
+#define MPU_FIFO_OK           0x00
+#define MPU_FIFO_OVERFLOW     0x01
+#define MPU_FIFO_MISALIGNED   0x02
+#define MPU_FIFO_READ_ERR     0x03
+
 /* ----------------------------------------------------------------------------
  *                                           Typedefs
  * -----------------------------------------------------------------------------
@@ -104,16 +150,31 @@ bool sensorMpu9250WomEnable(uint8_t threshold);
 bool sensorMpu9250AccSetRange(uint8_t range);
 uint8_t sensorMpu9250AccReadRange(void);
 bool sensorMpu9250AccRead(uint16_t *rawData);
-float sensorMpu9250AccConvert(int16_t rawValue);
+int16_t sensorMpu9250AccConvert(int16_t rawValue);
 
+bool sensorMpu9250GyroSetRange(uint8_t range);
+uint8_t sensorMpu9250GyroReadRange(void);
 bool sensorMpu9250GyroRead(uint16_t *rawData);
-float sensorMpu9250GyroConvert(int16_t rawValue);
+bool sensorMpu9250MovRead(uint16_t *rawData);
+int32_t sensorMpu9250GyroConvert(int16_t rawValue);
 uint8_t sensorMpu9250IntStatus(void);
 
+bool sensorMpu9250FifoEnable(uint16_t rate, uint8_t watermark);
+void sensorMpu9250FifoDisable(void);
+bool sensorMpu9250DataRdyEnable(uint16_t period);
+void sensorMpu9250DataRdyDisable(void);
+bool sensorMpu9250SetBandwidth(uint16_t accBw, uint16_t gyroBw, uint8_t dlpf);
+uint8_t sensorMpu9250TimestampRead(uint32_t *ts, uint8_t maxTs);
+void sensorMpu9250TimestampFlush(void);
+uint8_t sensorMpu9250FifoRead(uint16_t *data, uint8_t maxFrames,
+                              uint8_t *nFrames);
+
 bool sensorMpu9250MagTest(void);
 uint8_t sensorMpu9250MagRead(int16_t *pRawData);
 uint8_t sensorMpu9250MagStatus(void);
 void sensorMpu9250MagReset(void);
+void sensorMpu9250MagAuxMode(bool enable);
+bool sensorMpu9250MagSetOdr(uint8_t odr);
 
 /*******************************************************************************
 */
@@ -39,10 +39,10 @@
 *                                          Includes
 * ------------------------------------------------------------------------------
 */
+#include "Board.h"
 #include "bsp_i2c.h"
 #include "sensor.h"
 #include "sensor_opt3001.h"
-#include "math.h"
 /* -----------------------------------------------------------------------------
 *                                           Constants
 * ------------------------------------------------------------------------------
@@ -65,9 +65,20 @@
 #define DEVICE_ID                       0x0130  // 0x3001
 #define CONFIG_ENABLE                   0x10C4  // 0xC410   - 100 ms, continuous
 #define CONFIG_DISABLE                  0x10C0  // 0xC010   - 100 ms, shut-down
+#define CONFIG_CT_800MS                 0x0008  // 0x0800   - 800 ms conversion
+#define LOW_LIMIT_EOC                   0x00C0  // 0xC000   - end-of-conversion
+#define LOW_LIMIT_DEFAULT               0x0000  // 0x0000
+#define HIGH_LIMIT_DEFAULT              0xFFBF  // 0xBFFF   - full scale
 
 /* Bit values */
 #define DATA_RDY_BIT                    0x8000  // Config: 0x0080 = Data ready
+#define FLAG_HIGH_BIT                   0x4000  // Config: 0x0040 = Above high
+#define FLAG_LOW_BIT                    0x2000  // Config: 0x0020 = Below low
+
+/* Send-on-change window */
+#define WINDOW_MIN_HALF_WIDTH           100     // 1 lux (0.01 lux units)
+#define EXPONENT_MAX                    11
+#define MANTISSA_MAX                    0x0FFF
 
 /* Register length */
 #define REGISTER_LENGTH                 2
@@ -83,13 +94,39 @@
 *                                           Local Functions
 * ------------------------------------------------------------------------------
 */
-
+#ifdef Board_OPT_INT
+static void sensorOpt3001_Callback(PIN_Handle handle, PIN_Id pinId);
+#endif
+static uint16_t sensorOpt3001Encode(uint32_t value, bool roundUp);
 
 /* -----------------------------------------------------------------------------
 *                                           Local Variables
 * ------------------------------------------------------------------------------
 */
 
+// Conversion time selected, applied when the sensor is enabled
+static uint16_t convTime = OPT3001_CONV_TIME_SHORT;
+static bool sensorOn = false;
+
+// Limit registers (register byte order), applied when the sensor is enabled
+static uint16_t limitLow = LOW_LIMIT_DEFAULT;
+static uint16_t limitHigh = HIGH_LIMIT_DEFAULT;
+static bool windowOn = false;
+
+#ifdef Board_OPT_INT
+// Pin used by the OPT3001 (INT is open drain, active low)
+static PIN_Config OptPinTable[] =
+{
+    Board_OPT_INT    | PIN_INPUT_EN | PIN_PULLUP | PIN_IRQ_DIS | PIN_HYSTERESIS,
+
+    PIN_TERMINATE
+};
+static PIN_State pinGpioState;
+static PIN_Handle hOptPin;
+#endif
+
+// The application may register a callback to handle end-of-conversion
+static OptCallbackFn_t isrCallbackFn = NULL;
 /* -----------------------------------------------------------------------------
 *                                           Public functions
 * ------------------------------------------------------------------------------
@@ -105,12 +142,49 @@
  ******************************************************************************/
 bool sensorOpt3001Init(void)
 {
+#ifdef Board_OPT_INT
+  // Pin used by the OPT3001
+  hOptPin = PIN_open(&pinGpioState, OptPinTable);
+
+  // Register OPT3001 interrupt
+  PIN_registerIntCb(hOptPin, sensorOpt3001_Callback);
+#endif
+
+  // Application callback initially NULL
+  isrCallbackFn = NULL;
+  sensorOpt3001SetWindow(0, 0);
+
   sensorOpt3001Enable(false);
 
   return true;
 }
 
 
+/*******************************************************************************
+ * @fn          sensorOpt3001RegisterCallback
+ *
+ * @brief       Register a call-back for end-of-conversion processing. The
+ *              call-back runs in interrupt context; the result must be
+ *              read with sensorOpt3001Read, which also releases INT.
+ *
+ * @return      true if the end-of-conversion interrupt is available
+ ******************************************************************************/
+bool sensorOpt3001RegisterCallback(OptCallbackFn_t pfn)
+{
+  isrCallbackFn = pfn;
+  if (!windowOn)
+  {
+    sensorOpt3001SetWindow(0, 0);
+  }
+
+#ifdef Board_OPT_INT
+  return true;
+#else
+  return false;
+#endif
+}
+
+
 /*******************************************************************************
  * @fn          sensorOpt3001Enable
  *
@@ -122,6 +196,13 @@ void sensorOpt3001Enable(bool enable)
 {
   uint16_t val;
 
+#ifdef Board_OPT_INT
+  if (!enable)
+  {
+    PIN_setInterrupt(hOptPin, PIN_ID(Board_OPT_INT)|PIN_IRQ_DIS);
+  }
+#endif
+
   if (!SENSOR_SELECT())
   {
     return;
@@ -130,14 +211,148 @@ void sensorOpt3001Enable(bool enable)
   if (enable)
   {
     val = CONFIG_ENABLE;
+    if (convTime == OPT3001_CONV_TIME_LONG)
+    {
+      val |= CONFIG_CT_800MS;
+    }
+
+    // End-of-conversion or send-on-change window
+    sensorWriteReg(REG_LOW_LIMIT, (uint8_t *)&limitLow, REGISTER_LENGTH);
+    sensorWriteReg(REG_HIGH_LIMIT, (uint8_t *)&limitHigh, REGISTER_LENGTH);
   }
   else
   {
     val = CONFIG_DISABLE;
   }
 
+  // Writing the configuration also releases INT
   sensorWriteReg(REG_CONFIGURATION, (uint8_t *)&val, REGISTER_LENGTH);
   SENSOR_DESELECT();
+
+  sensorOn = enable;
+
+#ifdef Board_OPT_INT
+  if (enable && isrCallbackFn != NULL)
+  {
+    PIN_setInterrupt(hOptPin, PIN_ID(Board_OPT_INT)|PIN_IRQ_NEGEDGE);
+  }
+#endif
+}
+
+
+/*******************************************************************************
+ * @fn          sensorOpt3001SetConversionTime
+ *
+ * @brief       Select the longest conversion time that fits in a period.
+ *              Takes effect immediately if the sensor is running.
+ *
+ * @param       period - sample period (ms)
+ *
+ * @return      conversion time selected (ms)
+ ******************************************************************************/
+uint16_t sensorOpt3001SetConversionTime(uint16_t period)
+{
+  uint16_t newTime;
+
+  if (period >= OPT3001_CONV_TIME_LONG)
+  {
+    newTime = OPT3001_CONV_TIME_LONG;
+  }
+  else
+  {
+    newTime = OPT3001_CONV_TIME_SHORT;
+  }
+
+  if (newTime != convTime)
+  {
+    convTime = newTime;
+    if (sensorOn)
+    {
+      sensorOpt3001Enable(true);
+    }
+  }
+
+  return convTime;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorOpt3001SetWindow
+ *
+ * @brief       Program the limit registers with a window around a result.
+ *              INT is then asserted (and the window flags set) only when a
+ *              conversion falls outside the window. A width of zero
+ *              restores end-of-conversion reporting.
+ *
+ * @param       rawData - result to center the window on
+ *
+ * @param       width - half width in percent of the result
+ *
+ * @return      true if success
+ ******************************************************************************/
+bool sensorOpt3001SetWindow(uint16_t rawData, uint8_t width)
+{
+  bool success;
+
+  windowOn = width > 0;
+
+  if (windowOn)
+  {
+    uint32_t value;
+    uint32_t halfWidth;
+
+    // Result in units of 0.01 lux
+    value = (uint32_t)(rawData & MANTISSA_MAX) << (rawData >> 12);
+
+    halfWidth = value * width / 100;
+    if (halfWidth < WINDOW_MIN_HALF_WIDTH)
+    {
+      halfWidth = WINDOW_MIN_HALF_WIDTH;
+    }
+
+    if (value > halfWidth)
+    {
+      limitLow = sensorOpt3001Encode(value - halfWidth, false);
+    }
+    else
+    {
+      limitLow = LOW_LIMIT_DEFAULT;
+    }
+    limitHigh = sensorOpt3001Encode(value + halfWidth, true);
+  }
+  else
+  {
+#ifdef Board_OPT_INT
+    limitLow = isrCallbackFn != NULL ? LOW_LIMIT_EOC : LOW_LIMIT_DEFAULT;
+#else
+    limitLow = LOW_LIMIT_DEFAULT;
+#endif
+    limitHigh = HIGH_LIMIT_DEFAULT;
+  }
+
+  if (!sensorOn)
+  {
+    // Applied when the sensor is enabled
+    return true;
+  }
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  // Writing the limits also releases INT
+  success = sensorWriteReg(REG_LOW_LIMIT, (uint8_t *)&limitLow,
+                           REGISTER_LENGTH);
+  if (success)
+  {
+    success = sensorWriteReg(REG_HIGH_LIMIT, (uint8_t *)&limitHigh,
+                             REGISTER_LENGTH);
+  }
+
+  SENSOR_DESELECT();
+
+  return success;
 }
 
 
@@ -188,6 +403,108 @@ bool sensorOpt3001Read(uint16_t *rawData)
 }
 
 
+/*******************************************************************************
+ * @fn          sensorOpt3001ReadBatch
+ *
+ * @brief       Prepare the batch entries that read the configuration and
+ *              the result register, see bspI2cBatchSubmit (interface 0)
+ *
+ * @param       ops - OPT3001_BATCH_OPS batch entries
+ * @param       regs - buffer for configuration and result (2 registers)
+ *
+ * @return      none
+ ******************************************************************************/
+void sensorOpt3001ReadBatch(bspI2cBatchOp_t *ops, uint16_t *regs)
+{
+  bspI2cBatchRead(&ops[0], SENSOR_I2C_ADDRESS, REG_CONFIGURATION,
+                  (uint8_t *)&regs[0], REGISTER_LENGTH);
+  bspI2cBatchRead(&ops[1], SENSOR_I2C_ADDRESS, REG_RESULT,
+                  (uint8_t *)&regs[1], DATA_LENGTH);
+}
+
+
+/*******************************************************************************
+ * @fn          sensorOpt3001ReadDone
+ *
+ * @brief       Check and convert the registers of completed batch entries
+ *
+ * @param       ops - batch entries prepared by sensorOpt3001ReadBatch
+ * @param       regs - configuration and result registers
+ * @param       rawData - buffer to store data in
+ *
+ * @return      true if valid data
+ ******************************************************************************/
+bool sensorOpt3001ReadDone(bspI2cBatchOp_t *ops, uint16_t *regs,
+                           uint16_t *rawData)
+{
+  bool success;
+
+  success = ops[0].success && ops[1].success;
+
+  if (success)
+  {
+    success = (regs[0] & DATA_RDY_BIT) == DATA_RDY_BIT;
+  }
+
+  if (success)
+  {
+    // Swap bytes
+    *rawData = (regs[1] << 8) | (regs[1]>>8 &0xFF);
+  }
+  else
+  {
+    sensorSetErrorData((uint8_t*)rawData, DATA_LENGTH);
+  }
+
+  return success;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorOpt3001ReadWindow
+ *
+ * @brief       Read the result register if a conversion has left the window
+ *              set by sensorOpt3001SetWindow. Reading the configuration
+ *              clears the window flags and releases INT.
+ *
+ * @param       Buffer to store data in (untouched if inside the window)
+ *
+ * @return      true if the light level has left the window
+ ******************************************************************************/
+bool sensorOpt3001ReadWindow(uint16_t *rawData)
+{
+  bool success;
+  uint16_t val;
+
+  if (!SENSOR_SELECT())
+  {
+    return false;
+  }
+
+  success = sensorReadReg(REG_CONFIGURATION, (uint8_t *)&val, REGISTER_LENGTH);
+
+  if (success)
+  {
+    success = (val & (FLAG_HIGH_BIT | FLAG_LOW_BIT)) != 0;
+  }
+
+  if (success)
+  {
+    success = sensorReadReg(REG_RESULT, (uint8_t*)&val, DATA_LENGTH);
+  }
+
+  if (success)
+  {
+    // Swap bytes
+    *rawData = (val << 8) | (val>>8 &0xFF);
+  }
+
+  SENSOR_DESELECT();
+
+  return success;
+}
+
+
 /*******************************************************************************
  * @fn          sensorOpt3001Test
  *
@@ -221,20 +538,86 @@ bool sensorOpt3001Test(void)
 /*******************************************************************************
  * @fn          sensorOpt3001Convert
  *
- * @brief       Convert raw data to object and ambience temperature
+ * @brief       Convert raw data to light level
  *
- * @param       data - raw data from sensor
+ * @param       rawData - raw data from sensor
  *
- * @param       lux - converted value (lux)
- *
- * @return      none
+ * @return      converted value (0.01 lux)
  ******************************************************************************/
-float sensorOpt3001Convert(uint16_t rawData)
+uint32_t sensorOpt3001Convert(uint16_t rawData)
 {
-  uint16_t e, m;
+  uint32_t m;
+  uint16_t e;
 
   m = rawData & 0x0FFF;
   e = (rawData & 0xF000) >> 12;
 
-  return m * (0.01 * exp2(e));
+  // The LSB is 0.01 lux * 2^e, exact in fixed point
+  return m << e;
+}
+
+/* -----------------------------------------------------------------------------
+*                                           Private functions
+* ------------------------------------------------------------------------------
+*/
+
+/*******************************************************************************
+ * @fn          sensorOpt3001Encode
+ *
+ * @brief       Convert a light level to the limit register format, using the
+ *              smallest exponent that holds the value
+ *
+ * @param       value - light level (0.01 lux)
+ *
+ * @param       roundUp - round up rather than down when precision is lost
+ *
+ * @return      limit (register byte order)
+ ******************************************************************************/
+static uint16_t sensorOpt3001Encode(uint32_t value, bool roundUp)
+{
+  uint32_t m;
+  uint16_t e;
+  uint16_t val;
+
+  e = 0;
+  m = value;
+  while (m > MANTISSA_MAX && e < EXPONENT_MAX)
+  {
+    e++;
+    m = roundUp ? (value + (1UL << e) - 1) >> e : value >> e;
+  }
+
+  if (m > MANTISSA_MAX)
+  {
+    m = MANTISSA_MAX;
+  }
+
+  val = (e << 12) | (uint16_t)m;
+
+  // Swap bytes
+  return (val << 8) | (val >> 8);
+}
+
+#ifdef Board_OPT_INT
+/*******************************************************************************
+ *  @fn         sensorOpt3001_Callback
+ *
+ *  Interrupt service routine for the OPT3001 (end of conversion)
+ *
+ *  @param      handle PIN_Handle connected to the callback
+ *
+ *  @param      pinId  PIN_Id of the DIO triggering the callback
+ *
+ *  @return     none
+ ******************************************************************************/
+static void sensorOpt3001_Callback(PIN_Handle handle, PIN_Id pinId)
+{
+  if (pinId == Board_OPT_INT)
+  {
+    if (isrCallbackFn != NULL)
+    {
+      isrCallbackFn();
+    }
+  }
 }
+#endif
@@ -46,23 +46,38 @@ extern "C"
  * INCLUDES
  */
 #include "stdint.h"
+#include "bsp_i2c.h"
 
 /*********************************************************************
  * CONSTANTS
  */
 
+/* Batch entries used by sensorOpt3001ReadBatch */
+#define OPT3001_BATCH_OPS               2
+
+/* Conversion time (ms) */
+#define OPT3001_CONV_TIME_SHORT         100
+#define OPT3001_CONV_TIME_LONG          800
 
 /*********************************************************************
  * TYPEDEFS
  */
+typedef void (*OptCallbackFn_t)(void);
 
 /*********************************************************************
  * FUNCTIONS
  */
 bool sensorOpt3001Init(void);
+bool sensorOpt3001RegisterCallback(OptCallbackFn_t pfn);
 void sensorOpt3001Enable(bool enable);
+uint16_t sensorOpt3001SetConversionTime(uint16_t period);
+bool sensorOpt3001SetWindow(uint16_t rawData, uint8_t width);
 bool sensorOpt3001Read(uint16_t *rawData);
-float sensorOpt3001Convert(uint16_t rawData);
+void sensorOpt3001ReadBatch(bspI2cBatchOp_t *ops, uint16_t *regs);
+bool sensorOpt3001ReadDone(bspI2cBatchOp_t *ops, uint16_t *regs,
+                           uint16_t *rawData);
+bool sensorOpt3001ReadWindow(uint16_t *rawData);
+uint32_t sensorOpt3001Convert(uint16_t rawData);
 bool sensorOpt3001Test(void);
 
 
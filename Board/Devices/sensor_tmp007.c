@@ -40,10 +40,10 @@
 *                                          Includes
 * ------------------------------------------------------------------------------
 */
+#include "Board.h"
 #include "bsp_i2c.h"
 #include "sensor.h"
 #include "sensor_tmp007.h"
-#include "math.h"
 
 /* -----------------------------------------------------------------------------
 *                                           Constants
@@ -59,6 +59,7 @@
 #define TMP007_REG_ADDR_CONFIG          0x02
 #define TMP007_REG_ADDR_OBJ_TEMP        0x03
 #define TMP007_REG_ADDR_STATUS          0x04
+#define TMP007_REG_ADDR_MASK            0x05
 #define TMP007_REG_PROD_ID              0x1F
 
 /* TMP007 register values */
@@ -66,10 +67,27 @@
 #define TMP007_VAL_CONFIG_OFF           0x0000  // Sensor off state
 #define TMP007_VAL_CONFIG_RESET         0x8000  // Reset command
 #define TMP007_VAL_PROD_ID              0x0078  // Product ID
+#define TMP007_VAL_MASK_CONV_RDY        0x4000  // ALERT on conversion ready
+
+/* Configuration fields */
+#define TMP007_CFG_CR(avg)              ((avg) << 9)  // Conversion rate
+#define TMP007_CFG_ALRTEN               0x0100  // ALERT pin enable
+#define TMP007_CFG_INT                  0x0020  // Interrupt (not comparator)
 
 /* Bit values */
 #define CONV_RDY_BIT                    0x4000  // Conversion ready
 
+/* Conversion time of one sample (ms, 0.26 s per averaged sample in the
+   datasheet) and margin (1/x) added to it */
+#define CONV_TIME_SAMPLE                260
+#define CONV_TIME_MARGIN                10
+
+/* Energy estimate: supply current (uA) and charge of an MCU wake-up with
+   I2C access (nC) */
+#define CURRENT_ACTIVE                  270
+#define CURRENT_SHUTDOWN                2
+#define CHARGE_WAKEUP                   1500
+
 /* Register length */
 #define REGISTER_LENGTH                 2
 
@@ -84,6 +102,9 @@
 *                                           Local Functions
 * ------------------------------------------------------------------------------
 */
+#ifdef Board_TMP_RDY
+static void sensorTmp007_Callback(PIN_Handle handle, PIN_Id pinId);
+#endif
 
 /* -----------------------------------------------------------------------------
 *                                           Local Variables
@@ -91,6 +112,24 @@
 */
 static uint8_t buf[DATA_SIZE];
 static uint16_t val;
+
+// Number of conversions averaged (TMP007_AVG_x)
+static uint8_t averaging = TMP007_AVG_1;
+
+#ifdef Board_TMP_RDY
+// Pin used by the TMP007 (ALERT is open drain, active low)
+static PIN_Config TmpPinTable[] =
+{
+    Board_TMP_RDY    | PIN_INPUT_EN | PIN_PULLUP | PIN_IRQ_DIS | PIN_HYSTERESIS,
+
+    PIN_TERMINATE
+};
+static PIN_State pinGpioState;
+static PIN_Handle hTmpPin;
+#endif
+
+// The application may register a callback to handle conversion ready
+static TmpCallbackFn_t isrCallbackFn = NULL;
 /* -----------------------------------------------------------------------------
 *                                           Public functions
 * ------------------------------------------------------------------------------
@@ -106,11 +145,51 @@ static uint16_t val;
  ******************************************************************************/
 bool sensorTmp007Init(void)
 {
+#ifdef Board_TMP_RDY
+  if (hTmpPin == NULL)
+  {
+    // Pin used by the TMP007; without it the sensor is read on a timer
+    hTmpPin = PIN_open(&pinGpioState, TmpPinTable);
+
+    // Register TMP007 interrupt
+    if (hTmpPin != NULL)
+    {
+      PIN_registerIntCb(hTmpPin, sensorTmp007_Callback);
+    }
+  }
+#endif
+
   // Configure sensor
   return sensorTmp007Enable(false);
 }
 
 
+/*******************************************************************************
+ * @fn          sensorTmp007RegisterCallback
+ *
+ * @brief       Register a call-back for conversion ready (ALERT pin). The
+ *              call-back runs in interrupt context; sensorTmp007Read
+ *              reads the status register, which releases ALERT.
+ *
+ * @return      true if the conversion ready interrupt is available (the
+ *              call-back is not registered otherwise)
+ ******************************************************************************/
+bool sensorTmp007RegisterCallback(TmpCallbackFn_t pfn)
+{
+#ifdef Board_TMP_RDY
+  if (hTmpPin != NULL)
+  {
+    isrCallbackFn = pfn;
+    return true;
+  }
+#endif
+
+  isrCallbackFn = NULL;
+
+  return false;
+}
+
+
 /*******************************************************************************
  * @fn          sensorTmp007Enable
  *
@@ -122,11 +201,32 @@ bool sensorTmp007Enable(bool enable)
 {
   bool success;
 
+#ifdef Board_TMP_RDY
+  if (hTmpPin != NULL)
+  {
+    PIN_setInterrupt(hTmpPin, PIN_ID(Board_TMP_RDY)|PIN_IRQ_DIS);
+  }
+#endif
+
   if (!SENSOR_SELECT())
     return false;
 
   if (enable)
-    val = TMP007_VAL_CONFIG_ON;
+  {
+    val = TMP007_VAL_CONFIG_ON | TMP007_CFG_CR(averaging);
+
+#ifdef Board_TMP_RDY
+    if (isrCallbackFn != NULL)
+    {
+      uint16_t mask;
+
+      // Assert ALERT when a result is ready
+      mask = SWAP(TMP007_VAL_MASK_CONV_RDY);
+      sensorWriteReg(TMP007_REG_ADDR_MASK, (uint8_t*)&mask, REGISTER_LENGTH);
+      val |= TMP007_CFG_ALRTEN | TMP007_CFG_INT;
+    }
+#endif
+  }
   else
     val = TMP007_VAL_CONFIG_OFF;
 
@@ -136,10 +236,121 @@ bool sensorTmp007Enable(bool enable)
 
   SENSOR_DESELECT();
 
+#ifdef Board_TMP_RDY
+  if (enable && success && isrCallbackFn != NULL)
+  {
+    PIN_setInterrupt(hTmpPin, PIN_ID(Board_TMP_RDY)|PIN_IRQ_NEGEDGE);
+  }
+#endif
+
   return success;
 }
 
 
+/*******************************************************************************
+ * @fn          sensorTmp007SetAveraging
+ *
+ * @brief       Set the number of conversions averaged per result, applied
+ *              when the sensor is enabled
+ *
+ * @param       avg - TMP007_AVG_1 .. TMP007_AVG_16
+ *
+ * @return      true if valid
+ ******************************************************************************/
+bool sensorTmp007SetAveraging(uint8_t avg)
+{
+  if (avg > TMP007_AVG_16)
+  {
+    return false;
+  }
+
+  averaging = avg;
+
+  return true;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorTmp007ConversionTime
+ *
+ * @brief       Time from enable until a result is ready
+ *
+ * @return      conversion time (ms)
+ ******************************************************************************/
+uint16_t sensorTmp007ConversionTime(void)
+{
+  uint16_t t;
+
+  t = CONV_TIME_SAMPLE << averaging;
+
+  return t + t / CONV_TIME_MARGIN;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorTmp007Charge
+ *
+ * @brief       Estimate the charge used per sample period (sensor supply
+ *              and MCU wake-ups)
+ *
+ * @param       mode - TMP007_MODE_DUTY_CYCLED or TMP007_MODE_CONTINUOUS
+ *
+ * @param       period - sample period (ms)
+ *
+ * @return      charge (nC), 0xFFFFFFFF if the period can not be met
+ ******************************************************************************/
+uint32_t sensorTmp007Charge(uint8_t mode, uint16_t period)
+{
+  uint32_t tConv;
+  uint32_t charge;
+
+  tConv = sensorTmp007ConversionTime();
+
+  if (mode == TMP007_MODE_CONTINUOUS)
+  {
+    // Converting all the time, one wake-up per result
+    charge = (uint32_t)CURRENT_ACTIVE * period;
+    charge += CHARGE_WAKEUP * ((period + tConv - 1) / tConv);
+  }
+  else
+  {
+    if (period < tConv)
+    {
+      return 0xFFFFFFFF;
+    }
+
+    // Converting for one result, wake-ups to enable and to read
+    charge = (uint32_t)CURRENT_ACTIVE * tConv;
+    charge += (uint32_t)CURRENT_SHUTDOWN * (period - tConv);
+    charge += CHARGE_WAKEUP * 2;
+  }
+
+  return charge;
+}
+
+
+/*******************************************************************************
+ * @fn          sensorTmp007SelectMode
+ *
+ * @brief       Select the operating mode that uses the least energy for a
+ *              sample period
+ *
+ * @param       period - sample period (ms)
+ *
+ * @return      TMP007_MODE_DUTY_CYCLED or TMP007_MODE_CONTINUOUS
+ ******************************************************************************/
+uint8_t sensorTmp007SelectMode(uint16_t period)
+{
+  if (sensorTmp007Charge(TMP007_MODE_CONTINUOUS, period) <
+      sensorTmp007Charge(TMP007_MODE_DUTY_CYCLED, period))
+  {
+    return TMP007_MODE_CONTINUOUS;
+  }
+
+  return TMP007_MODE_DUTY_CYCLED;
+}
+
+
 /*******************************************************************************
  * @fn          sensorTmp007Read
  *
@@ -247,24 +458,45 @@ bool sensorTmp007Test(void)
  *
  * @param       rawObjTemp - raw temperature from sensor
  *
- * @param       tObj - converted object temperature
+ * @param       tObj - converted object temperature (0.01 C)
  *
- * @param       tAmb - converted ambience temperature
+ * @param       tTgt - converted ambience temperature (0.01 C)
  *
  * @return      none
  ******************************************************************************/
-void sensorTmp007Convert(uint16_t rawTemp, uint16_t rawObjTemp, float *tObj,
-                         float *tTgt)
+void sensorTmp007Convert(uint16_t rawTemp, uint16_t rawObjTemp, int16_t *tObj,
+                         int16_t *tTgt)
 {
-  const float SCALE_LSB = 0.03125;
-  float t;
-  int it;
+  int32_t it;
 
-  it = (int)((rawObjTemp) >> 2);
-  t = ((float)(it)) * SCALE_LSB;
-  *tObj = t;
+  // 14-bit two's complement, LSB 0.03125 C = 3.125 hundredths (25/8)
+  it = (int16_t)rawObjTemp >> 2;
+  *tObj = (int16_t)FIXED_DIV_POW2(it * 25, 3);
 
-  it = (int)((rawTemp) >> 2);
-  t = (float)it;
-  *tTgt = t * SCALE_LSB;
+  it = (int16_t)rawTemp >> 2;
+  *tTgt = (int16_t)FIXED_DIV_POW2(it * 25, 3);
+}
+
+#ifdef Board_TMP_RDY
+/*******************************************************************************
+ *  @fn         sensorTmp007_Callback
+ *
+ *  Interrupt service routine for the TMP007 (conversion ready)
+ *
+ *  @param      handle PIN_Handle connected to the callback
+ *
+ *  @param      pinId  PIN_Id of the DIO triggering the callback
+ *
+ *  @return     none
+ ******************************************************************************/
+static void sensorTmp007_Callback(PIN_Handle handle, PIN_Id pinId)
+{
+  if (pinId == Board_TMP_RDY)
+  {
+    if (isrCallbackFn != NULL)
+    {
+      isrCallbackFn();
+    }
+  }
 }
+#endif
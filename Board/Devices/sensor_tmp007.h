@@ -52,23 +52,39 @@ extern "C"
  * CONSTANTS
  */
 
+// Number of conversions averaged per result
+#define TMP007_AVG_1            0
+#define TMP007_AVG_2            1
+#define TMP007_AVG_4            2
+#define TMP007_AVG_8            3
+#define TMP007_AVG_16           4
+
+// Operating mode: enabled for each sample, or converting continuously
+#define TMP007_MODE_DUTY_CYCLED 0
+#define TMP007_MODE_CONTINUOUS  1
 
 /*********************************************************************
  * TYPEDEFS
  */
+typedef void (*TmpCallbackFn_t)(void);
 
 /*********************************************************************
  * FUNCTIONS
  */
 bool sensorTmp007Init(void);
+bool sensorTmp007RegisterCallback(TmpCallbackFn_t pfn);
 bool sensorTmp007Enable(bool enable);
+bool sensorTmp007SetAveraging(uint8_t avg);
+uint16_t sensorTmp007ConversionTime(void);
+uint32_t sensorTmp007Charge(uint8_t mode, uint16_t period);
+uint8_t sensorTmp007SelectMode(uint16_t period);
 bool sensorTmp007Test(void);
 
 bool sensorTmp006Read(uint16_t *rawVolt, uint16_t *rawTemp);
 void sensorTmp006Convert(uint16_t rawVolt, uint16_t rawTemp, float *tObj, float *tTgt);
 
 bool sensorTmp007Read(uint16_t *rawTemp, uint16_t *rawObjTemp);
-void sensorTmp007Convert(uint16_t rawTemp, uint16_t rawObjTemp, float *tObj, float *tTgt);
+void sensorTmp007Convert(uint16_t rawTemp, uint16_t rawObjTemp, int16_t *tObj, int16_t *tTgt);
 
 
 #ifdef __cplusplus
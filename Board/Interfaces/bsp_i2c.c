@@ -41,7 +41,10 @@
 /*******************************************************************************
  * INCLUDES
  */
+#include <xdc/runtime/Types.h>
 #include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/family/arm/m3/Hwi.h>
+#include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/family/arm/cc26xx/Power.h>
@@ -49,17 +52,27 @@
 #include <ti/drivers/i2c/I2CCC26XX.h>
 
 #include <driverlib/prcm.h>
+#include <driverlib/i2c.h>
+#include <inc/hw_types.h>
+#include <inc/hw_cpu_dwt.h>
+#include <inc/hw_cpu_scs.h>
 
 #include "Board.h"
 #include "sensor.h"
 
 #include "bsp_i2c.h"
+#include "string.h"
 
 /*******************************************************************************
  * CONSTANTS
  */
 #define I2C_TIMEOUT 2500
 
+/*******************************************************************************
+ * MACROS
+ */
+#define CYCLE_COUNT()   HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT)
+
 /*******************************************************************************
  * GLOBAL variables
  */
@@ -73,6 +86,8 @@ static volatile uint8_t interface;
 static I2C_Handle i2cHandle;
 static I2C_Params i2cParams;
 static Semaphore_Struct mutex;
+static Semaphore_Struct transferDone;
+static volatile bool transferStatus;
 static const I2CCC26XX_I2CPinCfg pinCfg1 =
 {
    // Pin configuration for I2C interface 1
@@ -80,6 +95,35 @@ static const I2CCC26XX_I2CPinCfg pinCfg1 =
   .pinSCL = Board_I2C0_SCL1
 };
 
+// Interface switch cost
+static uint32_t cyclesPerUs;
+static uint32_t switchCount;
+static uint32_t switchTime;
+static uint32_t switchMax;
+
+// Batch in progress
+static bspI2cBatchOp_t *batchOps;
+static uint8_t batchSize;
+static volatile uint8_t batchPending;
+static volatile uint8_t batchFailed;
+static bspI2cBatchCB_t batchCB;
+
+// Bus metrics per slave, and start of the running transaction (ticks)
+static bspI2cMetrics_t metrics[BSP_I2C_METRICS_SLAVES];
+static uint32_t transferStart;
+
+/*******************************************************************************
+ * LOCAL functions
+ */
+static bool transferWait(I2C_Transaction *transaction);
+static void transferCB(I2C_Handle handle, I2C_Transaction *transaction,
+                       bool status);
+static void interfaceSelect(uint8_t newInterface);
+static bspI2cMetrics_t *metricsFind(uint8_t address);
+static void metricsUpdate(I2C_Transaction *transaction, bool status);
+static void metricsTimeout(uint8_t address);
+static uint32_t switchCostStart(void);
+static void switchCostStop(uint32_t start);
 
 /*******************************************************************************
  * @fn          bspI2cWrite
@@ -101,7 +145,7 @@ bool bspI2cWrite(uint8_t *data, uint8_t len)
   masterTransaction.readBuf      = NULL;
   masterTransaction.slaveAddress = slaveAddr;
 
-  return I2C_transfer(i2cHandle, &masterTransaction) == TRUE;
+  return transferWait(&masterTransaction);
 }
 
 
@@ -144,7 +188,7 @@ bool bspI2cRead(uint8_t *data, uint8_t len)
   masterTransaction.readBuf      = data;
   masterTransaction.slaveAddress = slaveAddr;
 
-  return I2C_transfer(i2cHandle, &masterTransaction) == TRUE;
+  return transferWait(&masterTransaction);
 }
 
 /*******************************************************************************
@@ -169,7 +213,176 @@ bool bspI2cWriteRead(uint8_t *wdata, uint8_t wlen, uint8_t *rdata, uint8_t rlen)
   masterTransaction.readBuf      = rdata;
   masterTransaction.slaveAddress = slaveAddr;
 
-  return I2C_transfer(i2cHandle, &masterTransaction) == TRUE;
+  return transferWait(&masterTransaction);
+}
+
+
+/*******************************************************************************
+ * @fn          bspI2cBatchRead
+ *
+ * @brief       Prepare a register read for a batch
+ *
+ * @param       op - batch entry
+ * @param       address - slave address
+ * @param       reg - register to read
+ * @param       data - buffer for the data
+ * @param       len - number of bytes to read
+ *
+ * @return      none
+ */
+void bspI2cBatchRead(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                     uint8_t *data, uint8_t len)
+{
+  op->wbuf[0] = reg;
+
+  op->transaction.writeCount   = 1;
+  op->transaction.writeBuf     = op->wbuf;
+  op->transaction.readCount    = len;
+  op->transaction.readBuf      = data;
+  op->transaction.slaveAddress = address;
+  op->transaction.arg          = op;
+}
+
+
+/*******************************************************************************
+ * @fn          bspI2cBatchWrite
+ *
+ * @brief       Prepare a register write for a batch. The data is copied so
+ *              the caller's buffer may be reused at once.
+ *
+ * @param       op - batch entry
+ * @param       address - slave address
+ * @param       reg - register to write
+ * @param       data - data to write
+ * @param       len - number of bytes to write (max BSP_I2C_BATCH_WRITE_MAX)
+ *
+ * @return      none
+ */
+void bspI2cBatchWrite(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                      uint8_t *data, uint8_t len)
+{
+  uint8_t i;
+
+  if (len > BSP_I2C_BATCH_WRITE_MAX)
+  {
+    len = BSP_I2C_BATCH_WRITE_MAX;
+  }
+
+  op->wbuf[0] = reg;
+  for (i = 0; i < len; i++)
+  {
+    op->wbuf[i+1] = data[i];
+  }
+
+  op->transaction.writeCount   = len + 1;
+  op->transaction.writeBuf     = op->wbuf;
+  op->transaction.readCount    = 0;
+  op->transaction.readBuf      = NULL;
+  op->transaction.slaveAddress = address;
+  op->transaction.arg          = op;
+}
+
+
+/*******************************************************************************
+ * @fn          bspI2cBatchSubmit
+ *
+ * @brief       Queue a batch of register reads and writes on one interface
+ *              and return without waiting. The driver runs the transactions
+ *              back to back from its interrupt; the bus stays reserved
+ *              for the batch until the callback is made.
+ *
+ *              The callback runs once all queued entries are done, the
+ *              result of each entry is in its 'success' field. It runs in
+ *              Hwi context, or before this function returns if the batch
+ *              completed while it was being queued. Entries the driver
+ *              refuses count as failed. The batch entries must stay valid
+ *              until the callback.
+ *
+ * @param       newInterface - interface of the devices in the batch
+ * @param       ops - batch entries, prepared by bspI2cBatchRead/Write
+ * @param       nOps - number of entries
+ * @param       cb - completion callback
+ *
+ * @return      true if the batch has been queued, false if no entry could
+ *              be queued (no callback is made)
+ */
+bool bspI2cBatchSubmit(uint8_t newInterface, bspI2cBatchOp_t *ops, uint8_t nOps,
+                       bspI2cBatchCB_t cb)
+{
+  uint8_t i;
+  uint8_t nQueued;
+  unsigned int key;
+
+  if (nOps == 0 || cb == NULL)
+  {
+    return false;
+  }
+
+  // Acquire I2C resource, released when the batch completes
+  if (!Semaphore_pend(Semaphore_handle(&mutex),MS_2_TICKS(I2C_TIMEOUT)))
+  {
+    for (i = 0; i < nOps; i++)
+    {
+      metricsTimeout(ops[i].transaction.slaveAddress);
+    }
+    return false;
+  }
+
+  interfaceSelect(newInterface);
+
+  batchOps = ops;
+  batchSize = nOps;
+  batchFailed = 0;
+  batchCB = cb;
+
+  // One extra count keeps the batch open while it is being queued
+  batchPending = 1;
+
+  // Queue the transactions; the first one starts at once
+  nQueued = 0;
+  transferStart = Clock_getTicks();
+  for (i = 0; i < nOps; i++)
+  {
+    ops[i].success = false;
+    ops[i].transaction.arg = &ops[i];
+
+    key = Hwi_disable();
+    batchPending++;
+    Hwi_restore(key);
+
+    if (I2C_transfer(i2cHandle, &ops[i].transaction))
+    {
+      nQueued++;
+    }
+    else
+    {
+      // Refused by the driver; no callback will come for this entry
+      key = Hwi_disable();
+      batchPending--;
+      batchFailed++;
+      Hwi_restore(key);
+    }
+  }
+
+  // Close the batch
+  key = Hwi_disable();
+  batchPending--;
+  i = batchPending;
+  Hwi_restore(key);
+
+  if (i == 0)
+  {
+    // Nothing left on the bus
+    Semaphore_post(Semaphore_handle(&mutex));
+
+    if (nQueued == 0)
+    {
+      return false;
+    }
+    batchCB(batchOps, batchSize, batchFailed);
+  }
+
+  return true;
 }
 
 
@@ -188,33 +401,14 @@ bool bspI2cSelect(uint8_t newInterface, uint8_t address)
   // Acquire I2C resource
   if (!Semaphore_pend(Semaphore_handle(&mutex),MS_2_TICKS(I2C_TIMEOUT)))
   {
+    metricsTimeout(address);
     return false;
   }
 
   // Store new slave address
   slaveAddr = address;
 
-  // Interface changed ?
-  if (newInterface != interface)
-  {
-    // Store new interface
-    interface = newInterface;
-
-    // Shut down RTOS driver
-    I2C_close(i2cHandle);
-
-    // Sets custom to NULL, selects I2C interface 0
-    I2C_Params_init(&i2cParams);
-
-    // Assign I2C data/clock pins according to selected I2C interface 1
-    if (interface == BSP_I2C_INTERFACE_1)
-    {
-      i2cParams.custom = (void*)&pinCfg1;
-    }
-
-    // Re-open RTOS driver with new bus pin assignment
-    i2cHandle = I2C_open(Board_I2C, &i2cParams);
-  }
+  interfaceSelect(newInterface);
 
   return true;
 }
@@ -234,6 +428,77 @@ void bspI2cDeselect(void)
   Semaphore_post(Semaphore_handle(&mutex));
 }
 
+/*******************************************************************************
+ * @fn          bspI2cGetSwitchCost
+ *
+ * @brief       Get the cost of switching between I2C interfaces since
+ *              start-up or the last bspI2cResetMetrics
+ *
+ * @param       count - number of interface switches
+ * @param       totalUs - total time spent switching (microseconds)
+ * @param       maxUs - longest switch (microseconds)
+ *
+ * @return      none
+ */
+void bspI2cGetSwitchCost(uint32_t *count, uint32_t *totalUs, uint32_t *maxUs)
+{
+  unsigned int key;
+
+  key = Hwi_disable();
+  *count = switchCount;
+  *totalUs = switchTime;
+  *maxUs = switchMax;
+  Hwi_restore(key);
+}
+
+/*******************************************************************************
+ * @fn          bspI2cGetMetrics
+ *
+ * @brief       Get the bus metrics of a slave. Slaves are entered in the
+ *              order of their first transaction.
+ *
+ * @param       index - entry, 0 .. BSP_I2C_METRICS_SLAVES-1
+ * @param       pMetrics - copy of the entry
+ *
+ * @return      false if the entry is not in use
+ */
+bool bspI2cGetMetrics(uint8_t index, bspI2cMetrics_t *pMetrics)
+{
+  unsigned int key;
+
+  if (index >= BSP_I2C_METRICS_SLAVES)
+  {
+    return false;
+  }
+
+  key = Hwi_disable();
+  *pMetrics = metrics[index];
+  Hwi_restore(key);
+
+  return pMetrics->address != 0;
+}
+
+/*******************************************************************************
+ * @fn          bspI2cResetMetrics
+ *
+ * @brief       Clear the bus metrics of all slaves and the switch cost
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+void bspI2cResetMetrics(void)
+{
+  unsigned int key;
+
+  key = Hwi_disable();
+  memset(metrics, 0, sizeof(metrics));
+  switchCount = 0;
+  switchTime = 0;
+  switchMax = 0;
+  Hwi_restore(key);
+}
+
 
 /*******************************************************************************
  * @fn          bspI2cInit
@@ -247,24 +512,34 @@ void bspI2cDeselect(void)
 void bspI2cInit(void)
 {
   Semaphore_Params semParamsMutex;
+  Types_FreqHz freq;
 
   // Create protection semaphore
   Semaphore_Params_init(&semParamsMutex);
   semParamsMutex.mode = Semaphore_Mode_BINARY;
   Semaphore_construct(&mutex, 1, &semParamsMutex);
+  Semaphore_construct(&transferDone, 0, &semParamsMutex);
 
   // Reset the I2C controller
   HapiResetPeripheral(PRCM_PERIPH_I2C0);
 
+  // The driver runs in callback mode so that transactions can be queued,
+  // blocking access waits for the callback
   I2C_init();
   I2C_Params_init(&i2cParams);
   i2cParams.bitRate = I2C_400kHz;
+  i2cParams.transferMode = I2C_MODE_CALLBACK;
+  i2cParams.transferCallbackFxn = transferCB;
   i2cHandle = I2C_open(Board_I2C, &i2cParams);
 
   // Initialize local variables
   slaveAddr = 0xFF;
   interface = BSP_I2C_INTERFACE_0;
 
+  BIOS_getCpuFreq(&freq);
+  cyclesPerUs = freq.lo / 1000000;
+  bspI2cResetMetrics();
+
   if (i2cHandle == NULL)
   {
     Task_exit();
@@ -297,6 +572,7 @@ void bspI2cReset(void)
   // Reset local variables
   slaveAddr = 0xFF;
   interface = BSP_I2C_INTERFACE_0;
+  i2cParams.custom = NULL;
 
   // Open driver
   i2cHandle = I2C_open(Board_I2C, &i2cParams);
@@ -305,4 +581,279 @@ void bspI2cReset(void)
   Semaphore_post(Semaphore_handle(&mutex));
 }
 
+/*******************************************************************************
+ * @fn          transferWait
+ *
+ * @brief       Run a single transaction and wait for it to complete
+ *
+ * @param       transaction - I2C transaction
+ *
+ * @return      true if success
+ */
+static bool transferWait(I2C_Transaction *transaction)
+{
+  transaction->arg = NULL;
+  transferStart = Clock_getTicks();
+
+  if (!I2C_transfer(i2cHandle, transaction))
+  {
+    return false;
+  }
+
+  Semaphore_pend(Semaphore_handle(&transferDone), BIOS_WAIT_FOREVER);
+
+  return transferStatus;
+}
+
+/*******************************************************************************
+ * @fn          transferCB
+ *
+ * @brief       Driver callback (Hwi context), one call per transaction
+ *
+ * @param       handle - I2C driver handle
+ * @param       transaction - completed transaction
+ * @param       status - true if success
+ *
+ * @return      none
+ */
+static void transferCB(I2C_Handle handle, I2C_Transaction *transaction,
+                       bool status)
+{
+  bspI2cBatchOp_t *op;
+
+  metricsUpdate(transaction, status);
+
+  op = (bspI2cBatchOp_t*)transaction->arg;
+
+  if (op == NULL)
+  {
+    // Blocking transaction
+    transferStatus = status;
+    Semaphore_post(Semaphore_handle(&transferDone));
+    return;
+  }
+
+  op->success = status;
+  if (!status)
+  {
+    batchFailed++;
+  }
+
+  batchPending--;
+  if (batchPending == 0)
+  {
+    // Release the bus before the callback so that it may be reused at once
+    Semaphore_post(Semaphore_handle(&mutex));
+    batchCB(batchOps, batchSize, batchFailed);
+  }
+}
+
+/*******************************************************************************
+ * @fn          metricsFind
+ *
+ * @brief       Find the metrics entry of a slave, a free entry is taken
+ *              for a new slave
+ *
+ * @param       address - slave address
+ *
+ * @return      entry, NULL if the table is full
+ */
+static bspI2cMetrics_t *metricsFind(uint8_t address)
+{
+  uint8_t i;
+
+  for (i = 0; i < BSP_I2C_METRICS_SLAVES; i++)
+  {
+    if (metrics[i].address == address)
+    {
+      return &metrics[i];
+    }
+
+    if (metrics[i].address == 0)
+    {
+      metrics[i].address = address;
+      return &metrics[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * @fn          metricsUpdate
+ *
+ * @brief       Account a completed transaction (Hwi context). The duration
+ *              runs from the start of the transaction, or from the end of
+ *              the previous one in a batch, to the callback.
+ *
+ * @param       transaction - completed transaction
+ * @param       status - true if success
+ *
+ * @return      none
+ */
+static void metricsUpdate(I2C_Transaction *transaction, bool status)
+{
+  bspI2cMetrics_t *m;
+  uint32_t now;
+  uint32_t us;
+  uint32_t err;
+
+  now = Clock_getTicks();
+  us = (now - transferStart) * Clock_tickPeriod;
+  transferStart = now;
+
+  m = metricsFind(transaction->slaveAddress);
+  if (m == NULL)
+  {
+    return;
+  }
+
+  if (m->transactions < UINT16_MAX)
+  {
+    m->transactions++;
+  }
+  m->totalUs += us;
+  if (us > m->maxUs)
+  {
+    m->maxUs = us > UINT16_MAX ? UINT16_MAX : us;
+  }
+
+  if (status)
+  {
+    m->bytes += transaction->writeCount + transaction->readCount;
+  }
+  else
+  {
+    err = I2C_MASTER_ERR_NONE;
+    I2C_control(i2cHandle, I2CCC26XX_CMD_GET_ERROR, &err);
+
+    if (err & I2C_MASTER_ERR_ARB_LOST)
+    {
+      if (m->arbLost < UINT8_MAX)
+      {
+        m->arbLost++;
+      }
+    }
+    else if (err & (I2C_MASTER_ERR_ADDR_ACK | I2C_MASTER_ERR_DATA_ACK))
+    {
+      if (m->nack < UINT8_MAX)
+      {
+        m->nack++;
+      }
+    }
+    else if (m->other < UINT8_MAX)
+    {
+      // Bus error or no error recorded by the driver
+      m->other++;
+    }
+  }
+}
+
+/*******************************************************************************
+ * @fn          metricsTimeout
+ *
+ * @brief       Account a slave that could not get the bus in time
+ *
+ * @param       address - slave address
+ *
+ * @return      none
+ */
+static void metricsTimeout(uint8_t address)
+{
+  bspI2cMetrics_t *m;
+  unsigned int key;
+
+  key = Hwi_disable();
+  m = metricsFind(address);
+  if (m != NULL && m->timeout < UINT8_MAX)
+  {
+    m->timeout++;
+  }
+  Hwi_restore(key);
+}
+
+/*******************************************************************************
+ * @fn          interfaceSelect
+ *
+ * @brief       Move the bus to the pins of an interface
+ *
+ * @param       newInterface - selected interface
+ *
+ * @return      none
+ */
+static void interfaceSelect(uint8_t newInterface)
+{
+  uint32_t start;
+  void *pinCfg;
+
+  // Interface changed ?
+  if (newInterface != interface)
+  {
+    start = switchCostStart();
+
+    // Store new interface
+    interface = newInterface;
+
+    // Assign I2C data/clock pins according to selected I2C interface,
+    // NULL selects interface 0
+    pinCfg = interface == BSP_I2C_INTERFACE_1 ? (void*)&pinCfg1 : NULL;
+
+    // Move the bus to the new pins, the RTOS driver stays open
+    if (I2C_control(i2cHandle, I2CCC26XX_CMD_SET_PINS, pinCfg)
+        != I2C_STATUS_SUCCESS)
+    {
+      // Shut down RTOS driver
+      I2C_close(i2cHandle);
+
+      // Re-open RTOS driver with new bus pin assignment
+      i2cParams.custom = pinCfg;
+      i2cHandle = I2C_open(Board_I2C, &i2cParams);
+    }
+
+    switchCostStop(start);
+  }
+}
+
+/*******************************************************************************
+ * @fn          switchCostStart
+ *
+ * @brief       Start timing an interface switch. The CPU cycle counter is
+ *              (re-)enabled here as the debug unit may lose its state in
+ *              standby.
+ *
+ * @param       none
+ *
+ * @return      cycle count at the start
+ */
+static uint32_t switchCostStart(void)
+{
+  HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+
+  return CYCLE_COUNT();
+}
+
+/*******************************************************************************
+ * @fn          switchCostStop
+ *
+ * @brief       Account the time of an interface switch
+ *
+ * @param       start - cycle count at the start
+ *
+ * @return      none
+ */
+static void switchCostStop(uint32_t start)
+{
+  uint32_t us;
+
+  us = (CYCLE_COUNT() - start) / cyclesPerUs;
+
+  switchCount++;
+  switchTime += us;
+  if (us > switchMax)
+  {
+    switchMax = us;
+  }
+}
+
 #endif
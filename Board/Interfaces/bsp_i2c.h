@@ -51,6 +51,7 @@ extern "C"
 #include "stdbool.h"
 #include "stdint.h"
 #include <inc/hw_memmap.h>
+#include <ti/drivers/I2C.h>
 
 /*********************************************************************
  * CONSTANTS
@@ -59,10 +60,42 @@ extern "C"
 #define BSP_I2C_INTERFACE_1     1
 #define BSP_I2C_INTERFACE_NONE  -1
 
+// Longest register write in a batch (bytes)
+#define BSP_I2C_BATCH_WRITE_MAX 4
+
+// Number of slaves with bus metrics
+#define BSP_I2C_METRICS_SLAVES  8
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// Batch entry: one register read or write, see bspI2cBatchRead/Write
+typedef struct
+{
+  I2C_Transaction transaction;                  // Driver transaction
+  uint8_t wbuf[BSP_I2C_BATCH_WRITE_MAX + 1];    // Register and write data
+  bool success;                                 // Result
+} bspI2cBatchOp_t;
+
+// Batch completion callback (Hwi context)
+typedef void (*bspI2cBatchCB_t)(bspI2cBatchOp_t *ops, uint8_t nOps,
+                                uint8_t nFailed);
+
+// Bus metrics of one slave; counters saturate
+typedef struct
+{
+  uint8_t address;                              // Slave address, 0 if unused
+  uint8_t nack;                                 // Not acknowledged
+  uint8_t arbLost;                              // Arbitration lost
+  uint8_t timeout;                              // Bus not available in time
+  uint8_t other;                                // Other transfer errors
+  uint16_t transactions;                        // Transactions
+  uint16_t maxUs;                               // Longest transaction (us)
+  uint32_t bytes;                               // Bytes transferred
+  uint32_t totalUs;                             // Total transaction time (us)
+} bspI2cMetrics_t;
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -72,7 +105,16 @@ bool bspI2cRead(uint8_t *data, uint8_t len);
 bool bspI2cWrite(uint8_t *data, uint8_t len);
 bool bspI2cWriteSingle(uint8_t data);
 bool bspI2cWriteRead(uint8_t *wdata, uint8_t wlen, uint8_t *rdata, uint8_t rlen);
+void bspI2cBatchRead(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                     uint8_t *data, uint8_t len);
+void bspI2cBatchWrite(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                      uint8_t *data, uint8_t len);
+bool bspI2cBatchSubmit(uint8_t interface, bspI2cBatchOp_t *ops, uint8_t nOps,
+                       bspI2cBatchCB_t cb);
 void bspI2cDeselect(void);
+void bspI2cGetSwitchCost(uint32_t *count, uint32_t *totalUs, uint32_t *maxUs);
+bool bspI2cGetMetrics(uint8_t index, bspI2cMetrics_t *pMetrics);
+void bspI2cResetMetrics(void);
 void bspI2cDisable(void);
 void bspI2cReset(void);
 
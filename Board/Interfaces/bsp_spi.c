@@ -51,6 +51,13 @@
 #include "bsp_spi.h"
 #include "string.h"
 
+/*******************************************************************************
+ * CONSTANTS
+ */
+
+// Largest transfer the UDMA can do in one go
+#define SPI_MAX_TRANSFER      1024
+
 /*******************************************************************************
  * GLOBAL variables
  */
@@ -60,6 +67,7 @@
  */
 static SPI_Handle spiHandle = NULL;
 static SPI_Params spiParams;
+static uint32_t spiBitRate = BSP_SPI_BIT_RATE_DEFAULT;
 
 static PIN_Handle hSpiPin = NULL;
 static PIN_State pinState;
@@ -78,7 +86,8 @@ static uint8_t nUsers = 0;
 /*******************************************************************************
  * @fn          bspSpiWrite
  *
- * @brief       Write to an SPI device
+ * @brief       Write to an SPI device. Long buffers are split in transfers
+ *              the UDMA can handle.
  *
  * @param       buf - pointer to data buffer
  * @param       len - number of bytes to write
@@ -89,22 +98,34 @@ int bspSpiWrite(const uint8_t *buf, size_t len)
 {
   SPI_Transaction masterTransaction;
 
-  masterTransaction.count  = len;
-  masterTransaction.txBuf  = (void*)buf;
-  masterTransaction.arg    = NULL;
-  masterTransaction.rxBuf  = NULL;
+  while (len > 0)
+  {
+    masterTransaction.count  = len > SPI_MAX_TRANSFER ? SPI_MAX_TRANSFER : len;
+    masterTransaction.txBuf  = (void*)buf;
+    masterTransaction.arg    = NULL;
+    masterTransaction.rxBuf  = NULL;
 
-  return SPI_transfer(spiHandle, &masterTransaction) ? 0 : -1;
+    if (!SPI_transfer(spiHandle, &masterTransaction))
+    {
+      return -1;
+    }
+
+    buf += masterTransaction.count;
+    len -= masterTransaction.count;
+  }
+
+  return 0;
 }
 
 
 /*******************************************************************************
  * @fn          bspSpiRead
  *
- * @brief       Read from an SPI device
+ * @brief       Read from an SPI device. Long buffers are split in transfers
+ *              the UDMA can handle.
  *
  * @param       buf - pointer to data buffer
- * @param       len - number of bytes to write
+ * @param       len - number of bytes to read
  *
  * @return      '0' if success, -1 if failed
  */
@@ -112,12 +133,23 @@ int bspSpiRead(uint8_t *buf, size_t len)
 {
   SPI_Transaction masterTransaction;
 
-  masterTransaction.count  = len;
-  masterTransaction.txBuf  = NULL;
-  masterTransaction.arg    = NULL;
-  masterTransaction.rxBuf  = buf;
+  while (len > 0)
+  {
+    masterTransaction.count  = len > SPI_MAX_TRANSFER ? SPI_MAX_TRANSFER : len;
+    masterTransaction.txBuf  = NULL;
+    masterTransaction.arg    = NULL;
+    masterTransaction.rxBuf  = buf;
+
+    if (!SPI_transfer(spiHandle, &masterTransaction))
+    {
+      return -1;
+    }
 
-  return SPI_transfer(spiHandle, &masterTransaction) ? 0 : -1;
+    buf += masterTransaction.count;
+    len -= masterTransaction.count;
+  }
+
+  return 0;
 }
 
 
@@ -172,9 +204,9 @@ void bspSpiOpen(void)
 
   if (spiHandle == NULL)
   {
-    /*  Configure SPI as master, 1 mHz bit rate*/
+    /*  Configure SPI as master at the selected bit rate */
     SPI_Params_init(&spiParams);
-    spiParams.bitRate = 1000000;
+    spiParams.bitRate = spiBitRate;
     spiParams.mode         = SPI_MASTER;
     spiParams.transferMode = SPI_MODE_BLOCKING;
 
@@ -224,6 +256,52 @@ void bspSpiClose(void)
 }
 
 
+/*******************************************************************************
+ * @fn          bspSpiSetBitRate
+ *
+ * @brief       Select the SPI bit rate. Takes effect immediately if the
+ *              driver is open, otherwise when it is opened.
+ *
+ * @param       bitRate - bit rate in Hz
+ *
+ * @return      true if the bit rate is supported
+ */
+bool bspSpiSetBitRate(uint32_t bitRate)
+{
+  if (bitRate == 0 || bitRate > BSP_SPI_BIT_RATE_MAX)
+  {
+    return false;
+  }
+
+  if (spiHandle != NULL)
+  {
+    if (SPI_control(spiHandle, SPICC26XXDMA_CMD_SET_BIT_RATE, &bitRate)
+        != SPI_STATUS_SUCCESS)
+    {
+      return false;
+    }
+    spiParams.bitRate = bitRate;
+  }
+
+  spiBitRate = bitRate;
+
+  return true;
+}
+
+/*******************************************************************************
+ * @fn          bspSpiGetBitRate
+ *
+ * @brief       Get the SPI bit rate
+ *
+ * @param       none
+ *
+ * @return      bit rate in Hz
+ */
+uint32_t bspSpiGetBitRate(void)
+{
+  return spiBitRate;
+}
+
 /*******************************************************************************
  * @fn          bspSpiFlush
  *
@@ -42,6 +42,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* Bit rate used until another one is selected (Hz) */
+#define BSP_SPI_BIT_RATE_DEFAULT  1000000
+
+/* Highest bit rate of the SPI master (Hz) */
+#define BSP_SPI_BIT_RATE_MAX      12000000
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -89,6 +95,20 @@ extern "C"
   */
   extern  int bspSpiWriteRead(uint8_t *buf, uint8_t wlen, uint8_t rlen);
 
+  /**
+  * Select the SPI bit rate (Hz), applied at once if the interface is open
+  *
+  * @return True when the bit rate is supported.
+  */
+  extern bool bspSpiSetBitRate(uint32_t bitRate);
+
+  /**
+  * Get the SPI bit rate (Hz)
+  *
+  * @return Bit rate in Hz.
+  */
+  extern uint32_t bspSpiGetBitRate(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -236,7 +236,6 @@ void sensorSetErrorData(uint8_t *pBuf, uint8_t n)
 //
 //  Various utilities
 //
-#include "math.h"
 
 
 /*******************************************************************************
@@ -262,63 +261,62 @@ void convertToLe(uint8_t *data, uint8_t len)
 }
 
 
-#define PRECISION 100.0
-#define IPRECISION 100
+#define IPRECISION FIXED_SCALE
 
 /*******************************************************************************
- * @fn      floatToSfloat
+ * @fn      fixedToSfloat
  *
- * @brief   Convert a float to a short float
+ * @brief   Convert a fixed point value (hundredths) to a short float
  *
- * @param   data - floating point number to convert
+ * @param   data - fixed point number to convert
  *
  * @return  converted value
  */
-uint16_t floatToSfloat(float data)
+uint16_t fixedToSfloat(int32_t data)
 {
-    double sgn = data > 0 ? +1 : -1;
-    double mantissa = fabs(data) * PRECISION;
-    int exponent = 0;
-    bool scaled = false;
+    uint32_t mantissa;
+    uint16_t exponent;
+    uint16_t int_mantissa;
+
+    mantissa = data < 0 ? -data : data;
 
     // Scale if mantissa is too large
-    while (!scaled)
+    exponent = 0;
+    while (mantissa > (0xFFFUL << exponent))
     {
-      if (mantissa <= (float)0xFFF)
-      {
-        scaled = true;
-      }
-      else
-      {
-        exponent++;
-        mantissa /= 2.0;
-      }
+      exponent++;
     }
 
-    uint16_t int_mantissa = (int) round(sgn * mantissa);
-    uint16_t sfloat = ((exponent & 0xF) << 12) | (int_mantissa & 0xFFF);
+    // Round to nearest
+    if (exponent > 0)
+    {
+      mantissa = (mantissa + (1UL << (exponent - 1))) >> exponent;
+    }
 
-    return sfloat;
+    int_mantissa = data < 0 ? -mantissa : mantissa;
+
+    return ((exponent & 0xF) << 12) | (int_mantissa & 0xFFF);
 }
 
 
 /*******************************************************************************
- * @fn      floatToSfloat
+ * @fn      sfloatToFixed
  *
- * @brief   Convert a short float to a float
+ * @brief   Convert a short float to a fixed point value (hundredths)
  *
- * @param   data - floating point number to convert
+ * @param   rawData - short float to convert
  *
  * @return  converted value
  */
-float sfloatToFloat(uint16_t rawData)
+uint32_t sfloatToFixed(uint16_t rawData)
 {
-  uint16_t e, m;
+  uint32_t m;
+  uint16_t e;
 
   m = rawData & 0x0FFF;
   e = (rawData & 0xF000) >> 12;
 
-  return m * exp2(e) * (1.0/PRECISION);
+  return m << e;
 }
 
 /*******************************************************************************
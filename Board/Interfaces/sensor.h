@@ -87,6 +87,13 @@ extern "C"
 /* Data to use when an error occurs */
 #define ST_ERROR_DATA                         0xCC
 
+/* Fixed point sensor values are in hundredths of their unit */
+#define FIXED_SCALE                           100
+
+/* Signed division by 2^n, rounded to nearest (halves away from zero) */
+#define FIXED_DIV_POW2(x,n) \
+  ( ((x) < 0 ? (x) - (1L << ((n) - 1)) : (x) + (1L << ((n) - 1))) / (1L << (n)) )
+
 /* Loop enclosure for macros */
 #define st(x)      do { x } while (__LINE__ == -1)
 
@@ -113,8 +120,8 @@ bool     sensorWriteReg(uint8_t addr, uint8_t *pBuf, uint8_t nBytes);
 void     sensorSetErrorData(uint8_t *pBuf, uint8_t nBytes);
 
 void     convertToLe(uint8_t *data, uint8_t len);
-uint16_t floatToSfloat(float data);
-float    sfloatToFloat(uint16_t rawData);
+uint16_t fixedToSfloat(int32_t data);
+uint32_t sfloatToFixed(uint16_t rawData);
 uint16_t intToSfloat(int data);
 /*********************************************************************/
 
@@ -93,6 +93,7 @@ static void     I2CCC26XX_completeTransfer(I2C_Handle handle);
 static void     I2CCC26XX_blockingCallback(I2C_Handle handle, I2C_Transaction *msg, bool transferStatus);
 static void     I2CCC26XX_initHw(I2C_Handle handle);
 static int      I2CCC26XX_initIO(I2C_Handle handle, void *pinCfg);
+static int      I2CCC26XX_setPins(I2C_Handle handle, void *pinCfg);
 static Power_NotifyResponse i2cPostNotify(Power_Event eventType, uint32_t clientArg);
 
 /*
@@ -119,6 +120,8 @@ static const uint32_t bitRate[] = {
 static PIN_State pinState;
 /* PIN driver handle */
 static PIN_Handle hPin;
+/* Pins currently connected to the I2C master */
+static I2CCC26XX_I2CPinCfg i2cPins;
 
 /* Guard to avoid power constraints getting out of sync */
 static volatile bool i2cPowerConstraint;
@@ -230,12 +233,34 @@ void I2CCC26XX_close(I2C_Handle handle)
  *  @brief  Function for setting control parameters of the I2C driver
  *          after it has been opened.
  *
- *  @note   Currently not in use.
+ *  @pre    I2CCC26XX_open() has to be called first.
+ *          Calling context: Task, or Hwi, Swi and Task for
+ *          ::I2CCC26XX_CMD_GET_ERROR
+ *
+ *  @param  handle An I2C_Handle returned by I2C_open()
+ *
+ *  @param  cmd    ::I2CCC26XX_CMD_SET_PINS or ::I2CCC26XX_CMD_GET_ERROR
+ *
+ *  @param  arg    Pointer to a ::I2CCC26XX_I2CPinCfg (or NULL), or to a
+ *                 uint32_t for the error status
+ *
+ *  @return I2C_STATUS_SUCCESS, I2C_STATUS_ERROR or I2C_STATUS_UNDEFINEDCMD
+ *
+ *  @note  The generic I2C API should be used when accessing the I2CCC26XX.
  */
 int I2CCC26XX_control(I2C_Handle handle, unsigned int cmd, void *arg)
 {
-    /* No implementation */
-    return (I2C_STATUS_UNDEFINEDCMD);
+    switch (cmd) {
+        case I2CCC26XX_CMD_SET_PINS:
+            return (I2CCC26XX_setPins(handle, arg));
+
+        case I2CCC26XX_CMD_GET_ERROR:
+            *(uint32_t *)arg = ((I2CCC26XX_Object *)handle->object)->errStatus;
+            return (I2C_STATUS_SUCCESS);
+
+        default:
+            return (I2C_STATUS_UNDEFINEDCMD);
+    }
 }
 
 /*
@@ -510,6 +535,7 @@ static void I2CCC26XX_hwiFxn(UArg arg)
     else {
         /* Some sort of error happened! */
         object->mode = I2CCC26XX_ERROR;
+        object->errStatus = errStatus;
 
         if (errStatus & I2C_MASTER_ERR_ARB_LOST) {
             I2CCC26XX_completeTransfer((I2C_Handle) arg);
@@ -696,6 +722,7 @@ static void I2CCC26XX_primeTransfer(I2C_Handle handle,
 
     /* Store the new internal counters and pointers */
     object->currentTransaction = transaction;
+    object->errStatus = I2C_MASTER_ERR_NONE;
 
     object->writeBufIdx = transaction->writeBuf;
     object->writeCountIdx = transaction->writeCount;
@@ -946,7 +973,6 @@ static void I2CCC26XX_initHw(I2C_Handle handle) {
  */
 static int I2CCC26XX_initIO(I2C_Handle handle, void *pinCfg) {
     I2CCC26XX_HWAttrs const *hwAttrs;
-    I2CCC26XX_I2CPinCfg i2cPins;
     PIN_Config i2cPinTable[3];
     uint32_t i=0;
 
@@ -983,6 +1009,80 @@ static int I2CCC26XX_initIO(I2C_Handle handle, void *pinCfg) {
     return I2C_STATUS_SUCCESS;
 }
 
+/*
+ *  ======== I2CCC26XX_setPins ========
+ *  This functions moves the I2C master to another pair of IOs. The new IOs
+ *  are allocated before the current ones are released, so the pins are left
+ *  untouched if the allocation fails.
+ *
+ *  @pre    Function assumes that the I2C handle is pointing to a hardware
+ *          module which has already been opened.
+ */
+static int I2CCC26XX_setPins(I2C_Handle handle, void *pinCfg) {
+    I2CCC26XX_Object *object;
+    I2CCC26XX_HWAttrs const *hwAttrs;
+    I2CCC26XX_I2CPinCfg newPins;
+    int ret;
+
+    /* Get the pointer to the object and hwAttrs */
+    object = handle->object;
+    hwAttrs = handle->hwAttrs;
+
+    /* If the pinCfg pointer is NULL, use hwAttrs pins */
+    if (pinCfg == NULL) {
+        newPins.pinSDA = hwAttrs->sdaPin;
+        newPins.pinSCL = hwAttrs->sclPin;
+    } else {
+        newPins.pinSDA = ((I2CCC26XX_I2CPinCfg *)pinCfg)->pinSDA;
+        newPins.pinSCL = ((I2CCC26XX_I2CPinCfg *)pinCfg)->pinSCL;
+    }
+
+    /* Nothing to do if the pins are already in use */
+    if (newPins.pinSDA == i2cPins.pinSDA && newPins.pinSCL == i2cPins.pinSCL) {
+        return I2C_STATUS_SUCCESS;
+    }
+
+    /* Handle error */
+    if (newPins.pinSDA == PIN_UNASSIGNED || newPins.pinSCL == PIN_UNASSIGNED ||
+        newPins.pinSDA == i2cPins.pinSDA || newPins.pinSDA == i2cPins.pinSCL ||
+        newPins.pinSCL == i2cPins.pinSDA || newPins.pinSCL == i2cPins.pinSCL) {
+        return I2C_STATUS_ERROR;
+    }
+
+    /* The bus must be idle: no blocking transfer and nothing queued */
+    if (!Semaphore_pend(Semaphore_handle(&(object->mutex)), BIOS_NO_WAIT)) {
+        return I2C_STATUS_ERROR;
+    }
+
+    ret = I2C_STATUS_ERROR;
+    if (object->headPtr == NULL) {
+        /* Allocate the new pins, still muxed to GPIO */
+        if (PIN_add(hPin, newPins.pinSDA | PIN_INPUT_EN | PIN_PULLUP | PIN_OPENDRAIN) == PIN_SUCCESS) {
+            if (PIN_add(hPin, newPins.pinSCL | PIN_INPUT_EN | PIN_PULLUP | PIN_OPENDRAIN) == PIN_SUCCESS) {
+                /* Release the current pins, they revert to their GPIO configuration */
+                PIN_remove(hPin, i2cPins.pinSDA);
+                PIN_remove(hPin, i2cPins.pinSCL);
+
+                /* Set IO muxing for the new pins */
+                PINCC26XX_setMux(hPin, newPins.pinSDA, IOC_PORT_MCU_I2C_MSSDA);
+                PINCC26XX_setMux(hPin, newPins.pinSCL, IOC_PORT_MCU_I2C_MSSCL);
+                i2cPins = newPins;
+                ret = I2C_STATUS_SUCCESS;
+
+                Log_print2(Diags_USER2, "I2C: Pins moved to SDA %d, SCL %d",
+                           newPins.pinSDA, newPins.pinSCL);
+            }
+            else {
+                PIN_remove(hPin, newPins.pinSDA);
+            }
+        }
+    }
+
+    Semaphore_post(Semaphore_handle(&(object->mutex)));
+
+    return ret;
+}
+
 /*
  *  ======== i2cPostNotify ========
  *  This functions is called to notify the I2C driver of an ongoing transition
@@ -97,6 +97,8 @@
  *  | I2C_open()           | I2CCC26XX_open()         | Initialize I2C HW and set system dependencies     |
  *  | I2C_close()          | I2CCC26XX_close()        | Disable I2C HW and release system dependencies    |
  *  | I2C_transfer()       | I2CCC26XX_transfer()     | Start I2C transfer                                |
+ *  | I2C_control()        | I2CCC26XX_control()      | Move SDA/SCL to other pins (::I2CCC26XX_CMD_SET_PINS) |
+ *  |                      |                          | Get the last bus error (::I2CCC26XX_CMD_GET_ERROR) |
  *
  *  @note All calls should go through the generic API.
  *
@@ -334,6 +336,37 @@ typedef struct I2CCC26XX_I2CPinCfg {
     uint8_t pinSCL;
 } I2CCC26XX_I2CPinCfg;
 
+/*!
+ *  @brief  I2C_control command to move SDA and SCL to another pair of pins
+ *
+ *  Only the IO muxing is changed; the I2C peripheral, its Hwi and its power
+ *  dependency remain as set up by I2C_open(). This is much faster than
+ *  closing and re-opening the driver with a new ::I2CCC26XX_I2CPinCfg.
+ *  The arg pointer selects the new ::I2CCC26XX_I2CPinCfg, NULL selects the
+ *  ::I2CCC26XX_HWAttrs pins. The new pins must not overlap the current ones.
+ *  Returns I2C_STATUS_ERROR if a transfer is in progress or the pins cannot
+ *  be allocated, in which case the current pins are kept.
+ *  @code
+ *  I2CCC26XX_I2CPinCfg pinCfg;
+ *
+ *  pinCfg.pinSDA = Board_I2C0_SDA1;
+ *  pinCfg.pinSCL = Board_I2C0_SCL1;
+ *
+ *  I2C_control(handle, I2CCC26XX_CMD_SET_PINS, &pinCfg);
+ *  @endcode
+ */
+#define I2CCC26XX_CMD_SET_PINS      (I2C_CMD_RESERVED + 0)
+
+/*!
+ *  @brief  I2C_control command to get the bus error of the last transaction
+ *
+ *  The arg pointer selects a uint32_t that receives the driverlib
+ *  I2C_MASTER_ERR_xxx bits (I2C_MASTER_ERR_NONE if the transaction
+ *  succeeded). May be called from the transfer callback to tell a NACK from
+ *  a lost arbitration.
+ */
+#define I2CCC26XX_CMD_GET_ERROR     (I2C_CMD_RESERVED + 1)
+
 /*!
  *  @brief  I2CCC26XX mode
  *
@@ -400,6 +433,7 @@ typedef struct I2CCC26XX_Object {
 
     /* I2C current transaction */
     I2C_Transaction     *currentTransaction; /*!< Ptr to current I2C transaction */
+    I2CDataType         errStatus;           /*!< Bus error of the transaction */
     uint8_t             *writeBufIdx;        /*!< Internal inc. writeBuf index */
     unsigned int        writeCountIdx;       /*!< Internal dec. writeCounter */
     uint8_t             *readBufIdx;         /*!< Internal inc. readBuf index */
@@ -39,6 +39,8 @@
 #include <inc/hw_ioc.h>
 #include <inc/hw_ints.h>
 #include <inc/hw_ccfg.h>
+#include <inc/hw_cpu_dwt.h>
+#include <inc/hw_cpu_scs.h>
 #include <driverlib/driverlib_release.h>
 #include <driverlib/chipinfo.h>
 #include <ti/sysbios/BIOS.h>
@@ -62,6 +64,13 @@
 // Maximum number of pins (# available depends on package configuration)
 #define MAX_NUM_PINS 31
 
+// CPU cycle counter, used to time the I/O interrupt handler
+#define PIN_CYCLES() HWREG(CPU_DWT_BASE+CPU_DWT_O_CYCCNT)
+
+// Maximum number of passes over the event flags per interrupt entry, so
+// that a chattering input can not keep the handler running
+#define PIN_ISR_MAX_PASSES 4
+
 /// Number of pins available on device
 uint_t PIN_NumPins;
 
@@ -80,21 +89,26 @@ static ti_sysbios_family_arm_m3_Hwi_Struct PinHwi;
 /// PIN driver semaphore used to implement synchronicity for PIN_open()
 static Semaphore_Struct PinSem;
 
+/// Pins serviced first by the I/O interrupt handler, highest priority first
+static PIN_Id PinIsrOrder[PINCC26XX_ISR_ORDER_MAX];
 
+/// Number of pins in PinIsrOrder
+static uint_t PinIsrOrderLen;
 
-// I/O interrupt service routine
-static void PIN_Isr(UArg arg) {
-    uint32_t iEvent;
+/// Bitmask of the pins in PinIsrOrder
+static uint32_t bmPinIsrOrder;
 
-    // Get event flag with lowest index (also pin ID)
-    iEvent = PIN_ctz(HWREG(GPIO_BASE+GPIO_O_EVFLAGS31_0));
+/// Interrupt statistics, one per pin (pin id is index)
+static PINCC26XX_IsrStats PinIsrStats[MAX_NUM_PINS];
 
-    // Clear this event flag and clear CM3 interrupt
-    HWREG(GPIO_NONBUF_BASE+GPIO_O_EVFLAGS31_0) = (1<<iEvent);
-    HWREG(NVIC_UNPEND0) = 1<<(INT_EDGE_DETECT-16);
 
+
+// Service a single event and update the statistics of its pin
+static void PIN_IsrEvent(PIN_Id iEvent, uint32_t tEntry) {
     PIN_Handle handle;
     PIN_IntCb  pCb;
+    uint32_t   tLatency;
+
     if (iEvent<PIN_NumPins) {
         if (handle=PIN_HandleTable[iEvent]) {
             if (pCb=handle->pCbFunc) {
@@ -103,9 +117,63 @@ static void PIN_Isr(UArg arg) {
                 pCb(handle, iEvent);
             }
         }
+
+        // Time from ISR entry until the event has been handled
+        tLatency = PIN_CYCLES()-tEntry;
+        if (PinIsrStats[iEvent].count<0xFFFFFFFF) {
+            PinIsrStats[iEvent].count++;
+        }
+        if (tLatency>PinIsrStats[iEvent].maxLatency) {
+            PinIsrStats[iEvent].maxLatency = tLatency;
+        }
+    }
+}
+
+
+
+// I/O interrupt service routine
+static void PIN_Isr(UArg arg) {
+    uint32_t tEntry;
+    uint32_t bmEvents;
+    uint_t   i;
+    uint_t   nPasses;
+    PIN_Id   iEvent;
+
+    // The debug domain loses the cycle counter setup in standby, so start
+    // the counter on every entry
+    HWREG(CPU_SCS_BASE+CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+    HWREG(CPU_DWT_BASE+CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+    tEntry = PIN_CYCLES();
+
+    // Service all pending events in one entry, including edges arriving
+    // while the callbacks run, rather than re-entering once per event.
+    // Events still pending after the last pass re-trigger the interrupt.
+    for (nPasses=0; nPasses<PIN_ISR_MAX_PASSES; nPasses++) {
+        bmEvents = HWREG(GPIO_BASE+GPIO_O_EVFLAGS31_0);
+        if (bmEvents == 0) {
+            break;
+        }
+
+        // Clear the event flags taken and clear CM3 interrupt
+        HWREG(GPIO_NONBUF_BASE+GPIO_O_EVFLAGS31_0) = bmEvents;
+        HWREG(NVIC_UNPEND0) = 1<<(INT_EDGE_DETECT-16);
+
+        // Pins in the service order first
+        for (i=0; i<PinIsrOrderLen && (bmEvents&bmPinIsrOrder); i++) {
+            iEvent = PinIsrOrder[i];
+            if (bmEvents&(1<<iEvent)) {
+                bmEvents &= ~(1<<iEvent);
+                PIN_IsrEvent(iEvent, tEntry);
+            }
+        }
+
+        // Remaining pins, lowest index (also pin ID) first
+        while (bmEvents) {
+            iEvent = PIN_ctz(bmEvents);
+            bmEvents &= ~(1<<iEvent);
+            PIN_IsrEvent(iEvent, tEntry);
+        }
     }
-    // Return from ISR after processing single event to yield to other ISRs at
-    // same preemption level. Will not unfold stack if interrupt is pending again
 }
 
 
@@ -534,6 +602,63 @@ PIN_Status PINCC26XX_setWakeup(const PIN_Config aPinCfg[]) {
 
 
 
+PIN_Status PINCC26XX_setIsrOrder(const PIN_Id aPinList[]) {
+    uint_t i;
+    uint32_t bmOrder;
+    uint32_t key;
+
+    // Check the whole list before changing anything
+    for (i=0, bmOrder=0; aPinList && aPinList[i]!=PIN_TERMINATE; i++) {
+        if (i>=PINCC26XX_ISR_ORDER_MAX || aPinList[i]>=PIN_NumPins ||
+            (bmOrder&(1<<aPinList[i]))) {
+            return PIN_UNSUPPORTED;
+        }
+        bmOrder |= (1<<aPinList[i]);
+    }
+
+    // The I/O interrupt handler must see a consistent order
+    key = Hwi_disable();
+    for (i=0; aPinList && aPinList[i]!=PIN_TERMINATE; i++) {
+        PinIsrOrder[i] = aPinList[i];
+    }
+    PinIsrOrderLen = i;
+    bmPinIsrOrder = bmOrder;
+    Hwi_restore(key);
+
+    return PIN_SUCCESS;
+}
+
+
+
+PIN_Status PINCC26XX_getIsrStats(PIN_Id pinId, PINCC26XX_IsrStats *pStats) {
+    uint32_t key;
+
+    if (pinId>=PIN_NumPins) {
+        return PIN_UNSUPPORTED;
+    }
+    key = Hwi_disable();
+    *pStats = PinIsrStats[pinId];
+    Hwi_restore(key);
+
+    return PIN_SUCCESS;
+}
+
+
+
+void PINCC26XX_resetIsrStats(void) {
+    uint_t i;
+    uint32_t key;
+
+    key = Hwi_disable();
+    for (i=0; i<MAX_NUM_PINS; i++) {
+        PinIsrStats[i].count = 0;
+        PinIsrStats[i].maxLatency = 0;
+    }
+    Hwi_restore(key);
+}
+
+
+
 uint_t PIN_getPortMask(PIN_Handle handle) {
 	// On CC26xx there is only one port encompassing all pins
     if (handle) {
@@ -339,6 +339,50 @@ extern int_t PINCC26XX_getMux(PIN_Id pinId);
 extern PIN_Status PINCC26XX_setMux(PIN_Handle handle, PIN_Id pinId, int32_t nMux);
 
 
+/// Maximum number of pins in the I/O interrupt service order
+#define PINCC26XX_ISR_ORDER_MAX 8
+
+/** \brief Per-pin I/O interrupt statistics, see #PINCC26XX_getIsrStats()
+ */
+typedef struct {
+    uint32_t count;      ///< Number of events serviced (saturates)
+    uint32_t maxLatency; ///< Worst-case CPU cycles from interrupt entry until the callback returned
+} PINCC26XX_IsrStats;
+
+
+/** \brief Select the order in which simultaneous pin events are serviced
+ *
+ *  The I/O interrupt handler services all pending events in one entry.
+ *  Events on the listed pins are handled first, in list order; events on
+ *  other pins follow, lowest pin ID first.
+ *
+ *  \param aPinList List of up to #PINCC26XX_ISR_ORDER_MAX pin IDs,
+ *                  highest priority first, terminated by #PIN_TERMINATE.
+ *                  NULL or an empty list restores pin ID order.
+ *  \return #PIN_SUCCESS if successful, else error code
+ *  \par Usage
+ *       \code
+ *       const PIN_Id aOrder[] = { PIN_ID(7), PIN_ID(3), PIN_TERMINATE };
+ *       PINCC26XX_setIsrOrder(aOrder);
+ *       \endcode
+ */
+extern PIN_Status PINCC26XX_setIsrOrder(const PIN_Id aPinList[]);
+
+
+/** \brief Get the I/O interrupt statistics of a pin
+ *
+ *  \param pinId    Pin ID
+ *  \param pStats   Pointer to the statistics to fill in
+ *  \return #PIN_SUCCESS if successful, else error code
+ */
+extern PIN_Status PINCC26XX_getIsrStats(PIN_Id pinId, PINCC26XX_IsrStats *pStats);
+
+
+/** \brief Clear the I/O interrupt statistics of all pins
+ */
+extern void PINCC26XX_resetIsrStats(void);
+
+
 
 /** \anchor PINCC26XX_MUX_VALS
  *  \name Device-specific pin mux values for CC26xx family
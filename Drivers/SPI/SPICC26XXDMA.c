@@ -271,6 +271,7 @@ int SPICC26XXDMA_control(SPI_Handle handle, unsigned int cmd, void *arg)
     SPICC26XX_Object        *object;
     SPICC26XX_HWAttrs const *hwAttrs;
     PIN_Config              pinConfig;
+    unsigned int            key;
 
     /* Get the pointer to the object and hwAttr */
     hwAttrs = handle->hwAttrs;
@@ -320,6 +321,29 @@ int SPICC26XXDMA_control(SPI_Handle handle, unsigned int cmd, void *arg)
             ret = SPI_STATUS_SUCCESS;
             break;
 #endif
+        case SPICC26XXDMA_CMD_SET_BIT_RATE:
+            /* Only a master drives the clock */
+            if (object->mode != SPI_MASTER ||
+                *(uint32_t *)arg == 0 ||
+                *(uint32_t *)arg > SPICC26XXDMA_MAX_BIT_RATE) {
+                break;
+            }
+
+            /* The prescaler can not be changed in the middle of a transfer */
+            key = Hwi_disable();
+            if (object->currentTransaction) {
+                Hwi_restore(key);
+                break;
+            }
+
+            /* Reprogram the SSI, it is enabled again by the next transfer */
+            object->bitRate = *(uint32_t *)arg;
+            SPICC26XXDMA_initHw(handle);
+            Hwi_restore(key);
+
+            ret = SPI_STATUS_SUCCESS;
+            break;
+
         default:
             /* This command is not defined */
             ret = SPI_STATUS_UNDEFINEDCMD;
@@ -201,7 +201,7 @@
  * | SPI_init()            | SPICC26XXDMA_init()            | Initialize SPI driver                                       |
  * | SPI_open()            | SPICC26XXDMA_open()            | Initialize SPI HW and set system dependencies               |
  * | SPI_close()           | SPICC26XXDMA_close()           | Disable SPI and UDMA HW and release system dependencies     |
- * | SPI_control()         | SPICC26XXDMA_control()         | Configure an already opened SPI handle                      |
+ * | SPI_control()         | SPICC26XXDMA_control()         | Configure an already opened SPI handle (e.g. its bit rate)  |
  * | SPI_transfer()        | SPICC26XXDMA_transfer()        | Start transfer from SPI                                     |
  * | SPI_transferCancel()  | SPICC26XXDMA_transferCancel()  | Cancel ongoing transfer from SPI                            |
  *
@@ -482,6 +482,24 @@ extern "C" {
 #define SPICC26XXDMA_CMD_SET_CSN_PIN            SPI_CMD_RESERVED + 2
 /*! Enable/disable CSN wakeup on chip select assertion, used as cmd to SPI_control() */
 #define SPICC26XXDMA_CMD_SET_CSN_WAKEUP         SPI_CMD_RESERVED + 3
+/*!
+ *  @brief  Change the bit rate of an open master, used as cmd to SPI_control()
+ *
+ *  The arg pointer selects the new bit rate in Hz (uint32_t). Only the SSI
+ *  clock prescaler is reprogrammed; the DMA channels, pins and power
+ *  dependencies remain as set up by SPI_open(). Returns SPI_STATUS_ERROR in
+ *  slave mode, if a transfer is in progress or if the bit rate is above
+ *  ::SPICC26XXDMA_MAX_BIT_RATE.
+ *  @code
+ *  uint32_t bitRate = 12000000;
+ *
+ *  SPI_control(handle, SPICC26XXDMA_CMD_SET_BIT_RATE, &bitRate);
+ *  @endcode
+ */
+#define SPICC26XXDMA_CMD_SET_BIT_RATE           SPI_CMD_RESERVED + 4
+
+/*! Highest bit rate supported in master mode (Hz) */
+#define SPICC26XXDMA_MAX_BIT_RATE               12000000
 
 /* BACKWARDS COMPATIBILITY */
 #define SPICC26XXDMA_RETURN_PARTIAL_ENABLE      SPICC26XXDMA_CMD_RETURN_PARTIAL_ENABLE
@@ -65,6 +65,8 @@
 #define SENSOR_DATA_UUID        BAROMETER_DATA_UUID
 #define SENSOR_CONFIG_UUID      BAROMETER_CONF_UUID
 #define SENSOR_PERIOD_UUID      BAROMETER_PERI_UUID
+#define SENSOR_ALT_UUID         BAROMETER_ALT_UUID
+#define SENSOR_REF_UUID         BAROMETER_REF_UUID
 
 #define SENSOR_SERVICE          BAROMETER_SERVICE
 #define SENSOR_DATA_LEN         BAROMETER_DATA_LEN
@@ -72,6 +74,8 @@
 #define SENSOR_DATA_DESCR       "Barom. Data"
 #define SENSOR_CONFIG_DESCR     "Barom. Conf."
 #define SENSOR_PERIOD_DESCR     "Barom. Period"
+#define SENSOR_ALT_DESCR        "Barom. Altitude"
+#define SENSOR_REF_DESCR        "Barom. Reference"
 
 /*********************************************************************
  * TYPEDEFS
@@ -105,6 +109,18 @@ static CONST uint8_t sensorPeriodUUID[TI_UUID_SIZE] =
   TI_UUID(SENSOR_PERIOD_UUID),
 };
 
+// Characteristic UUID: altitude
+static CONST uint8_t sensorAltUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_ALT_UUID),
+};
+
+// Characteristic UUID: reference pressure
+static CONST uint8_t sensorRefUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_REF_UUID),
+};
+
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -163,6 +179,31 @@ static uint8_t sensorPeriod = SENSOR_MIN_UPDATE_PERIOD / SENSOR_PERIOD_RESOLUTIO
 static uint8_t sensorPeriodUserDescr[] = SENSOR_PERIOD_DESCR;
 #endif
 
+// Characteristic Properties: altitude
+static uint8_t sensorAltProps = GATT_PROP_READ | GATT_PROP_NOTIFY;
+
+// Characteristic Value: altitude
+static uint8_t sensorAlt[BAROMETER_ALT_LEN];
+
+// Characteristic Configuration: altitude
+static gattCharCfg_t *sensorAltConfig;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: altitude
+static uint8_t sensorAltUserDescr[] = SENSOR_ALT_DESCR;
+#endif
+
+// Characteristic Properties: reference pressure
+static uint8_t sensorRefProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: reference pressure
+static uint8_t sensorRef[BAROMETER_REF_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: reference pressure
+static uint8_t sensorRefUserDescr[] = SENSOR_REF_DESCR;
+#endif
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -255,6 +296,62 @@ static gattAttribute_t sensorAttrTable[] =
         0,
         sensorPeriodUserDescr
       },
+#endif
+     // Characteristic Declaration "Altitude"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorAltProps
+    },
+
+      // Characteristic Value "Altitude"
+      {
+        { TI_UUID_SIZE, sensorAltUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorAlt
+      },
+
+      // Characteristic configuration "Altitude"
+      {
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8_t *)&sensorAltConfig
+      },
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Altitude"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorAltUserDescr
+      },
+#endif
+     // Characteristic Declaration "Reference"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorRefProps
+    },
+
+      // Characteristic Value "Reference"
+      {
+        { TI_UUID_SIZE, sensorRefUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        sensorRef
+      },
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Reference"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorRefUserDescr
+      },
 #endif
 };
 
@@ -302,9 +399,18 @@ bStatus_t Barometer_addService(void)
   {
     return (bleMemAllocError);
   }
+
+  sensorAltConfig = (gattCharCfg_t *)ICall_malloc(sizeof(gattCharCfg_t) *
+                                                   linkDBNumConns);
+  if (sensorAltConfig == NULL)
+  {
+    ICall_free(sensorDataConfig);
+    return (bleMemAllocError);
+  }
   
   // Register with Link DB to receive link status change callback
   GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorDataConfig);
+  GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorAltConfig);
 
   // Register GATT attribute list and CBs with GATT Server App
   return GATTServApp_RegisterService(sensorAttrTable,
@@ -399,6 +505,33 @@ bStatus_t Barometer_setParameter(uint8_t param, uint8_t len, void *value)
       }
       break;
 
+    case BAROMETER_ALT:
+      if (len == BAROMETER_ALT_LEN)
+      {
+        memcpy(sensorAlt, value, BAROMETER_ALT_LEN);
+
+        // See if Notification has been enabled
+        ret = GATTServApp_ProcessCharCfg(sensorAltConfig, sensorAlt, FALSE,
+                                 sensorAttrTable, GATT_NUM_ATTRS (sensorAttrTable),
+                                 INVALID_TASK_ID, sensor_ReadAttrCB);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case BAROMETER_REF:
+      if (len == BAROMETER_REF_LEN)
+      {
+        memcpy(sensorRef, value, BAROMETER_REF_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -438,6 +571,14 @@ bStatus_t Barometer_getParameter(uint8_t param, void *value)
       *((uint8_t*)value) = sensorPeriod;
       break;
 
+    case BAROMETER_ALT:
+      memcpy(value, sensorAlt, BAROMETER_ALT_LEN);
+      break;
+
+    case BAROMETER_REF:
+      memcpy(value, sensorRef, BAROMETER_REF_LEN);
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -504,6 +645,16 @@ static bStatus_t sensor_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       pValue[0] = *pAttr->pValue;
       break;
 
+    case SENSOR_ALT_UUID:
+      *pLen = BAROMETER_ALT_LEN;
+      memcpy(pValue, pAttr->pValue, BAROMETER_ALT_LEN);
+      break;
+
+    case SENSOR_REF_UUID:
+      *pLen = BAROMETER_REF_LEN;
+      memcpy(pValue, pAttr->pValue, BAROMETER_REF_LEN);
+      break;
+
     default:
       *pLen = 0;
       status = ATT_ERR_ATTR_NOT_FOUND;
@@ -618,6 +769,37 @@ static bStatus_t sensor_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       }
       break;
 
+    case SENSOR_ALT_UUID:
+      // Should not get here
+      break;
+
+    case SENSOR_REF_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != BAROMETER_REF_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value
+      if (status == SUCCESS)
+      {
+        memcpy(pAttr->pValue, pValue, BAROMETER_REF_LEN);
+
+        if (pAttr->pValue == sensorRef)
+        {
+          notifyApp = BAROMETER_REF;
+        }
+      }
+      break;
+
     case GATT_CLIENT_CHAR_CFG_UUID:
       status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
                                               offset, GATT_CLIENT_CFG_NOTIFY);
@@ -60,10 +60,23 @@ extern "C"
 #define BAROMETER_CONF_UUID             0xAA42
 #define BAROMETER_CAL_UUID              0xAA43 // Not used on SensorTag2
 #define BAROMETER_PERI_UUID             0xAA44
+#define BAROMETER_ALT_UUID              0xAA45
+#define BAROMETER_REF_UUID              0xAA46
+
+// Barometer specific parameters (continues from SENSOR_PERI)
+#define BAROMETER_ALT                   3  // RN altitude and pressure trend
+#define BAROMETER_REF                   4  // RW reference pressure
 
 // Length of sensor data in bytes
 #define BAROMETER_DATA_LEN              6
 
+// Altitude: relative altitude (cm, 32 bit), filtered pressure (0.01 Pa,
+// 32 bit), 1 and 3 hour pressure trend (Pa, 16 bit), trend flags (8 bit)
+#define BAROMETER_ALT_LEN               13
+
+// Reference pressure (0.01 Pa, 32 bit), writing 0 takes the current pressure
+#define BAROMETER_REF_LEN               4
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -0,0 +1,418 @@
+/*******************************************************************************
+  Filename:       calservice.c
+
+  Description:    Calibration Service.
+
+  Copyright 2015 Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+#include "linkdb.h"
+#include "att.h"
+#include "gatt.h"
+#include "gatt_uuid.h"
+#include "gattservapp.h"
+#include "string.h"
+
+#include "calservice.h"
+#include "st_util.h"
+
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+// GATT Profile Service UUID
+CONST uint8_t calServUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(CAL_SERV_UUID)
+};
+
+// Data Characteristic UUID
+CONST uint8_t calDataUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(CAL_DATA_UUID)
+};
+
+
+/*********************************************************************
+ * EXTERNAL VARIABLES
+ */
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static sensorCBs_t *cal_AppCBs = NULL;
+
+/*********************************************************************
+ * Profile Attributes - variables
+ */
+
+// Calibration Service attribute
+static CONST gattAttrType_t calService = { TI_UUID_SIZE, calServUUID };
+
+// Calibration Service Data Characteristic Properties
+static uint8_t calDataProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Calibration Service Data Characteristic Value
+static uint8_t calData[CAL_DATA_LEN] = { 0 };
+
+#ifdef USER_DESCRIPTION
+// Calibration Service Data Characteristic User Description
+static uint8_t calDataUserDesp[] = "Cal. Data";
+#endif
+
+/*********************************************************************
+ * Profile Attributes - Table
+ */
+static gattAttribute_t calAttrTbl[] =
+{
+  // Calibration Service Service
+  {
+    { ATT_BT_UUID_SIZE, primaryServiceUUID }, /* type */
+    GATT_PERMIT_READ,                         /* permissions */
+    0,                                        /* handle */
+    (uint8_t *)&calService                    /* pValue */
+  },
+
+    // Data Characteristic Declaration
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &calDataProps
+    },
+
+      // Data Characteristic Value
+      {
+        { TI_UUID_SIZE, calDataUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        calData
+      },
+#ifdef USER_DESCRIPTION
+      // Data Characteristic User Description
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        calDataUserDesp
+      },
+#endif
+};
+
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bStatus_t cal_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                uint8_t *pValue, uint16_t *pLen, uint16_t offset,
+                                uint16_t maxLen, uint8_t method);
+static bStatus_t cal_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                 uint8_t *pValue, uint16_t len, uint16_t offset,
+                                 uint8_t method);
+
+/*********************************************************************
+ * PROFILE CALLBACKS
+ */
+
+// Calibration Service Service Callbacks
+CONST gattServiceCBs_t calCBs =
+{
+  cal_ReadAttrCB,  // Read callback function pointer
+  cal_WriteAttrCB, // Write callback function pointer
+  NULL             // Authorization callback function pointer
+};
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Cal_addService
+ *
+ * @brief   Initializes the Calibration service by registering
+ *          GATT attributes with the GATT server.
+ *
+ * @return  Success or Failure
+ */
+bStatus_t Cal_addService(void)
+{
+  // Register GATT attribute list and CBs with GATT Server App
+  return GATTServApp_RegisterService( calAttrTbl,
+                                      GATT_NUM_ATTRS( calAttrTbl ),
+                                      GATT_MAX_ENCRYPT_KEY_SIZE,
+                                      &calCBs );
+}
+
+/*********************************************************************
+ * @fn      Cal_registerAppCBs
+ *
+ * @brief   Registers the application callback function. Only call
+ *          this function once.
+ *
+ * @param   callbacks - pointer to application callbacks.
+ *
+ * @return  SUCCESS or bleAlreadyInRequestedMode
+ */
+bStatus_t Cal_registerAppCBs(sensorCBs_t *appCallbacks)
+{
+  if (appCallbacks != NULL)
+  {
+    cal_AppCBs = appCallbacks;
+
+    return (SUCCESS);
+  }
+  else
+  {
+    return (bleAlreadyInRequestedMode);
+  }
+}
+
+/*********************************************************************
+ * @fn      Cal_setParameter
+ *
+ * @brief   Set a Calibration service parameter.
+ *
+ * @param   param - Profile parameter ID
+ * @param   len - length of data to write
+ * @param   value - pointer to data to write.  This is dependent on
+ *          the parameter ID and WILL be cast to the appropriate
+ *          data type (example: data type of uint16_t will be cast to
+ *          uint16_t pointer).
+ *
+ * @return  bStatus_t
+ */
+bStatus_t Cal_setParameter(uint8_t param, uint8_t len, void *value)
+{
+  bStatus_t ret = SUCCESS;
+
+  switch (param)
+  {
+    case SENSOR_DATA:
+      if (len == CAL_DATA_LEN)
+      {
+        memcpy(calData, value, CAL_DATA_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    default:
+      ret = INVALIDPARAMETER;
+      break;
+  }
+
+  return (ret);
+}
+
+/*********************************************************************
+ * @fn      Cal_getParameter
+ *
+ * @brief   Get a Calibration service parameter.
+ *
+ * @param   param - Profile parameter ID
+ * @param   value - pointer to data to put.  This is dependent on
+ *          the parameter ID and WILL be cast to the appropriate
+ *          data type (example: data type of uint16_t will be cast to
+ *          uint16_t pointer).
+ *
+ * @return  bStatus_t
+ */
+bStatus_t Cal_getParameter(uint8_t param, void *value)
+{
+  bStatus_t ret = SUCCESS;
+
+  switch (param)
+  {
+    case SENSOR_DATA:
+      memcpy(value, calData, CAL_DATA_LEN);
+      break;
+
+    default:
+      ret = INVALIDPARAMETER;
+      break;
+  }
+
+  return (ret);
+}
+
+/*********************************************************************
+ * @fn          cal_ReadAttrCB
+ *
+ * @brief       Read an attribute.
+ *
+ * @param       connHandle - connection message was received on
+ * @param       pAttr - pointer to attribute
+ * @param       pValue - pointer to data to be read
+ * @param       pLen - length of data to be read
+ * @param       offset - offset of the first octet to be read
+ * @param       maxLen - maximum length of data to be read
+ * @param       method - type of read message
+ *
+ * @return      SUCCESS, blePending or Failure
+ */
+static bStatus_t cal_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                uint8_t *pValue, uint16_t *pLen, uint16_t offset,
+                                uint16_t maxLen, uint8_t method)
+{
+  uint16_t uuid;
+  bStatus_t status = SUCCESS;
+
+  // If attribute permissions require authorization to read, return error
+  if (gattPermitAuthorRead(pAttr->permissions))
+  {
+    // Insufficient authorization
+    return (ATT_ERR_INSUFFICIENT_AUTHOR);
+  }
+
+  // Make sure it's not a blob operation (no attributes in the profile are long)
+  if (offset > 0)
+  {
+    return (ATT_ERR_ATTR_NOT_LONG);
+  }
+
+  if (utilExtractUuid16(pAttr,&uuid) == FAILURE)
+  {
+    // Invalid handle
+    return ATT_ERR_INVALID_HANDLE;
+  }
+
+  if (uuid == CAL_DATA_UUID)
+  {
+    *pLen = CAL_DATA_LEN;
+    memcpy(pValue, pAttr->pValue, CAL_DATA_LEN);
+  }
+  else
+  {
+    // Should never get here!
+    *pLen = 0;
+    status = ATT_ERR_ATTR_NOT_FOUND;
+  }
+
+  return (status);
+}
+
+/*********************************************************************
+ * @fn      cal_WriteAttrCB
+ *
+ * @brief   Validate attribute data prior to a write operation
+ *
+ * @param   connHandle - connection message was received on
+ * @param   pAttr - pointer to attribute
+ * @param   pValue - pointer to data to be written
+ * @param   len - length of data
+ * @param   offset - offset of the first octet to be written
+ * @param   method - type of write message
+ *
+ * @return  SUCCESS, blePending or Failure
+ */
+static bStatus_t cal_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                 uint8_t *pValue, uint16_t len, uint16_t offset,
+                                 uint8_t method)
+{
+  bStatus_t status = SUCCESS;
+  uint8_t notifyApp = 0xFF;
+  uint16_t uuid;
+
+  // If attribute permissions require authorization to write, return error
+  if (gattPermitAuthorWrite(pAttr->permissions))
+  {
+    // Insufficient authorization
+    return (ATT_ERR_INSUFFICIENT_AUTHOR);
+  }
+
+  if (utilExtractUuid16(pAttr,&uuid) == FAILURE)
+  {
+    // Invalid handle
+    return ATT_ERR_INVALID_HANDLE;
+  }
+
+  switch (uuid)
+  {
+    case CAL_DATA_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != CAL_DATA_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value
+      if (status == SUCCESS)
+      {
+        memcpy(pAttr->pValue, pValue, CAL_DATA_LEN);
+        notifyApp = SENSOR_DATA;
+      }
+      break;
+
+    default:
+      // Should never get here!
+      status = ATT_ERR_ATTR_NOT_FOUND;
+      break;
+  }
+
+  // If a characteristic value changed then callback function to
+  // notify application of change
+  if ((notifyApp != 0xFF ) && cal_AppCBs && cal_AppCBs->pfnSensorChange)
+  {
+    cal_AppCBs->pfnSensorChange(notifyApp);
+  }
+
+  return (status);
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,125 @@
+/*******************************************************************************
+  Filename:       calservice.h
+
+  Description:    Calibration Service definitions and prototypes
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+#ifndef CALSERVICE_H
+#define CALSERVICE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "st_util.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Service UUID
+#define CAL_SERV_UUID                 0xAA90
+#define CAL_DATA_UUID                 0xAA91
+
+// Calibration table, little endian int16:
+//   gyroscope bias X/Y/Z (0.01 deg/s)
+//   magnetometer hard-iron offset X/Y/Z (raw)
+//   ambient temperature offset (0.01 degC)
+#define CAL_DATA_LEN                  14
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*********************************************************************
+ * Profile Callbacks
+ */
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/*
+ * Cal_addService- Initializes the Calibration service by registering
+ *          GATT attributes with the GATT server.
+ */
+extern bStatus_t Cal_addService(void);
+
+/*
+ * Cal_registerAppCBs - Registers the application callback function.
+ *                      Only call this function once.
+ *
+ *    appCallbacks - pointer to application callbacks.
+ */
+extern bStatus_t Cal_registerAppCBs(sensorCBs_t *appCallbacks);
+
+/*
+ * Cal_setParameter - Set a Calibration service parameter.
+ *
+ *    param - Profile parameter ID
+ *    len - length of data to write
+ *    pValue - pointer to data to write.  This is dependent on
+ *          the parameter ID and WILL be cast to the appropriate
+ *          data type (example: data type of uint16_t will be cast to
+ *          uint16_t pointer).
+ */
+extern bStatus_t Cal_setParameter(uint8_t param, uint8_t len, void *pValue);
+
+/*
+ * Cal_getParameter - Get a Calibration service parameter.
+ *
+ *    param - Profile parameter ID
+ *    pValue - pointer to data to read.  This is dependent on
+ *          the parameter ID and WILL be cast to the appropriate
+ *          data type (example: data type of uint16_t will be cast to
+ *          uint16_t pointer).
+ */
+extern bStatus_t Cal_getParameter(uint8_t param, void *pValue);
+
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CALSERVICE_H */
@@ -81,6 +81,18 @@ CONST uint8_t ioConfUUID[TI_UUID_SIZE] =
   TI_UUID(IO_CONF_UUID)
 };
 
+// Sampling Characteristic UUID
+CONST uint8_t ioSamplingUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(IO_SAMPLING_UUID)
+};
+
+// I2C Diagnostics Characteristic UUID
+CONST uint8_t ioI2cDiagUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(IO_I2C_DIAG_UUID)
+};
+
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -95,6 +107,7 @@ CONST uint8_t ioConfUUID[TI_UUID_SIZE] =
  */
 
 static sensorCBs_t *io_AppCBs = NULL;
+static ioDiagRead_t io_DiagReadCB = NULL;
 
 /*********************************************************************
  * Profile Attributes - variables
@@ -128,6 +141,28 @@ static uint8_t ioConf = 0x00;
 static uint8_t ioConfUserDesp[] = "IO Config";
 #endif
 
+// IO Service Sampling Characteristic Properties
+static uint8_t ioSamplingProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// IO Service Sampling Characteristic Value
+static uint8_t ioSampling[IO_SAMPLING_LEN] = { 0 };
+
+#ifdef USER_DESCRIPTION
+// IO Service Sampling Characteristic User Description
+static uint8_t ioSamplingUserDesp[] = "IO Sampling";
+#endif
+
+// IO Service I2C Diagnostics Characteristic Properties
+static uint8_t ioI2cDiagProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// IO Service I2C Diagnostics Characteristic Value
+static uint8_t ioI2cDiag[IO_I2C_DIAG_LEN] = { 0 };
+
+#ifdef USER_DESCRIPTION
+// IO Service I2C Diagnostics Characteristic User Description
+static uint8_t ioI2cDiagUserDesp[] = "IO I2C Diag";
+#endif
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -188,6 +223,54 @@ static gattAttribute_t ioAttrTbl[] =
         0,
         ioConfUserDesp
       },
+#endif
+    // Sampling Characteristic Declaration
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &ioSamplingProps
+    },
+
+      // Sampling Characteristic Value
+      {
+        { TI_UUID_SIZE, ioSamplingUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        ioSampling
+      },
+#ifdef USER_DESCRIPTION
+      // Sampling Characteristic User Description
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        ioSamplingUserDesp
+      },
+#endif
+    // I2C Diagnostics Characteristic Declaration
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &ioI2cDiagProps
+    },
+
+      // I2C Diagnostics Characteristic Value
+      {
+        { TI_UUID_SIZE, ioI2cDiagUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        ioI2cDiag
+      },
+#ifdef USER_DESCRIPTION
+      // I2C Diagnostics Characteristic User Description
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        ioI2cDiagUserDesp
+      },
 #endif
 };
 
@@ -270,6 +353,21 @@ bStatus_t Io_registerAppCBs(sensorCBs_t *appCallbacks)
   }
 }
 
+/*********************************************************************
+ * @fn      Io_registerDiagReadCB
+ *
+ * @brief   Registers the callback that refreshes the I2C diagnostics
+ *          before they are read.
+ *
+ * @param   pfnDiagRead - refresh callback, NULL to serve the stored value
+ *
+ * @return  none
+ */
+void Io_registerDiagReadCB(ioDiagRead_t pfnDiagRead)
+{
+  io_DiagReadCB = pfnDiagRead;
+}
+
 /*********************************************************************
  * @fn      Io_setParameter
  *
@@ -316,6 +414,28 @@ bStatus_t Io_setParameter(uint8_t param, uint8_t len, void *value)
       }
       break;
 
+    case IO_SAMPLING:
+      if (len == IO_SAMPLING_LEN)
+      {
+        memcpy(ioSampling, value, IO_SAMPLING_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case IO_I2C_DIAG:
+      if (len == IO_I2C_DIAG_LEN)
+      {
+        memcpy(ioI2cDiag, value, IO_I2C_DIAG_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -351,6 +471,14 @@ bStatus_t Io_getParameter(uint8_t param, void *value)
       *((uint8_t*)value) = ioConf;
       break;
 
+    case IO_SAMPLING:
+      memcpy(value, ioSampling, IO_SAMPLING_LEN);
+      break;
+
+    case IO_I2C_DIAG:
+      memcpy(value, ioI2cDiag, IO_I2C_DIAG_LEN);
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -405,6 +533,21 @@ static bStatus_t io_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
     *pLen = sizeof(uint8_t);
     pValue[0] = pAttr->pValue[0];
   }
+  else if (uuid == IO_SAMPLING_UUID)
+  {
+    *pLen = IO_SAMPLING_LEN;
+    memcpy(pValue, pAttr->pValue, IO_SAMPLING_LEN);
+  }
+  else if (uuid == IO_I2C_DIAG_UUID)
+  {
+    // The metrics keep changing after the entry was selected
+    if (io_DiagReadCB != NULL)
+    {
+      io_DiagReadCB(pAttr->pValue);
+    }
+    *pLen = IO_I2C_DIAG_LEN;
+    memcpy(pValue, pAttr->pValue, IO_I2C_DIAG_LEN);
+  }
   else
   {
     // Should never get here!
@@ -495,6 +638,56 @@ static bStatus_t io_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       }
       break;
 
+    case IO_SAMPLING_UUID:
+      // Only the mode can be written
+      if (offset == 0)
+      {
+        if (len == sizeof(uint8_t))
+        {
+          if (pValue[0] >= IO_SAMPLING_NUM_MODES)
+            status = ATT_ERR_INVALID_VALUE;
+        } else
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value
+      if (status == SUCCESS)
+      {
+        uint8_t *pCurValue = (uint8_t *)pAttr->pValue;
+        pCurValue[0] = pValue[0];
+        notifyApp = IO_SAMPLING;
+      }
+      break;
+
+    case IO_I2C_DIAG_UUID:
+      // Only the entry can be written
+      if (offset == 0)
+      {
+        if (len != sizeof(uint8_t))
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value
+      if (status == SUCCESS)
+      {
+        uint8_t *pCurValue = (uint8_t *)pAttr->pValue;
+        pCurValue[0] = pValue[0];
+        notifyApp = IO_I2C_DIAG;
+      }
+      break;
+
     case GATT_CLIENT_CHAR_CFG_UUID:
       status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
                                               offset, GATT_CLIENT_CFG_NOTIFY);
@@ -58,6 +58,31 @@ extern "C"
 #define IO_SERV_UUID                  0xAA64
 #define IO_DATA_UUID                  0xAA65
 #define IO_CONF_UUID                  0xAA66
+#define IO_SAMPLING_UUID              0xAA67
+#define IO_I2C_DIAG_UUID              0xAA68
+
+// IO specific parameters (continues from SENSOR_PERI)
+#define IO_SAMPLING                   3  // RW sampling mode
+#define IO_I2C_DIAG                   4  // RW I2C bus metrics (write selects)
+
+// Sampling: mode (written), followed by the wake-ups saved per second
+#define IO_SAMPLING_LEN               3
+
+// I2C diagnostics: entry (written), slave address (0 = not in use),
+// transactions (16 bit), bytes (32 bit), total and max transaction time
+// (us, 32 and 16 bit), NACKs, lost arbitrations, bus timeouts and other
+// errors (8 bit). The switch entry reports interface switches as
+// transactions and their total and longest duration as the transaction
+// times.
+//
+// The pin entries report the I/O interrupt statistics of one pin instead:
+// entry, pin id, events serviced (32 bit) and worst-case latency from
+// interrupt entry until the callback returned (CPU cycles, 32 bit); the
+// remaining bytes are zero.
+#define IO_I2C_DIAG_LEN               18
+#define IO_I2C_DIAG_PIN               0x80  // Pin interrupts, entry - pin id
+#define IO_I2C_DIAG_SWITCH            0xFE  // Interface switch cost
+#define IO_I2C_DIAG_RESET             0xFF  // Write to clear all metrics
 
 // Configuration value range
 #define IO_MODE_LOCAL           0
@@ -65,6 +90,11 @@ extern "C"
 #define IO_MODE_SELFTEST        2
 #define IO_MODE_NUM_MODES       3
 
+// Sampling mode range
+#define IO_SAMPLING_FREE        0
+#define IO_SAMPLING_ALIGNED     1
+#define IO_SAMPLING_NUM_MODES   2
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -77,6 +107,10 @@ extern "C"
  * Profile Callbacks
  */
 
+// Callback to refresh the I2C diagnostics before they are read (BLE stack
+// context); pValue holds the characteristic, with the entry in pValue[0]
+typedef void (*ioDiagRead_t)(uint8_t *pValue);
+
 /*********************************************************************
  * API FUNCTIONS
  */
@@ -95,6 +129,13 @@ extern bStatus_t Io_addService(void);
  */
 extern bStatus_t Io_registerAppCBs(sensorCBs_t *appCallbacks);
 
+/*
+ * Io_registerDiagReadCB - Registers the I2C diagnostics refresh callback.
+ *
+ *    pfnDiagRead - refresh callback, NULL to serve the stored value
+ */
+extern void Io_registerDiagReadCB(ioDiagRead_t pfnDiagRead);
+
 /*
  * Io_setParameter - Set a Test Profile parameter.
  *
@@ -63,6 +63,16 @@
 #define SENSOR_DATA_UUID        MOVEMENT_DATA_UUID
 #define SENSOR_CONFIG_UUID      MOVEMENT_CONF_UUID
 #define SENSOR_PERIOD_UUID      MOVEMENT_PERI_UUID
+#define SENSOR_FIFO_UUID        MOVEMENT_FIFO_UUID
+#define SENSOR_BATCH_UUID       MOVEMENT_BATCH_UUID
+#define SENSOR_BATCH_SIZE_UUID  MOVEMENT_BATCH_SIZE_UUID
+#define SENSOR_QUAT_UUID        MOVEMENT_QUAT_UUID
+#define SENSOR_QUAT_PERI_UUID   MOVEMENT_QUAT_PERI_UUID
+#define SENSOR_JITTER_UUID      MOVEMENT_JITTER_UUID
+#define SENSOR_CONF_EXT_UUID    MOVEMENT_CONF_EXT_UUID
+#define SENSOR_DUTY_UUID        MOVEMENT_DUTY_UUID
+#define SENSOR_SPECTRUM_UUID    MOVEMENT_SPECTRUM_UUID
+#define SENSOR_SPECTRUM_CONF_UUID MOVEMENT_SPECTRUM_CONF_UUID
 
 #define SENSOR_SERVICE          MOVEMENT_SERVICE
 #define SENSOR_DATA_LEN         MOVEMENT_DATA_LEN
@@ -70,8 +80,19 @@
 #define SENSOR_DATA_DESCR       "Mov Data"
 #define SENSOR_CONFIG_DESCR     "Mov Conf."
 #define SENSOR_PERIOD_DESCR     "Mov Period"
+#define SENSOR_FIFO_DESCR       "Mov FIFO"
+#define SENSOR_BATCH_DESCR      "Mov Batch"
+#define SENSOR_BATCH_SIZE_DESCR "Mov Batch Size"
+#define SENSOR_QUAT_DESCR       "Mov Quat"
+#define SENSOR_QUAT_PERI_DESCR  "Mov Quat Period"
+#define SENSOR_JITTER_DESCR     "Mov Jitter"
+#define SENSOR_CONF_EXT_DESCR   "Mov Conf Ext"
+#define SENSOR_DUTY_DESCR       "Mov Duty Cycle"
+#define SENSOR_SPECTRUM_DESCR   "Mov Spectrum"
+#define SENSOR_SPECTRUM_CONF_DESCR "Mov Spectrum Conf"
 
 #define SENSOR_CONFIG_LEN       2
+#define SENSOR_FIFO_LEN         MOVEMENT_FIFO_LEN
 
 /*********************************************************************
  * TYPEDEFS
@@ -105,6 +126,66 @@ static CONST uint8_t sensorPeriodUUID[TI_UUID_SIZE] =
   TI_UUID(SENSOR_PERIOD_UUID),
 };
 
+// Characteristic UUID: FIFO
+static CONST uint8_t sensorFifoUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_FIFO_UUID),
+};
+
+// Characteristic UUID: batched data
+static CONST uint8_t sensorBatchUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_BATCH_UUID),
+};
+
+// Characteristic UUID: batch size
+static CONST uint8_t sensorBatchSizeUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_BATCH_SIZE_UUID),
+};
+
+// Characteristic UUID: quaternion
+static CONST uint8_t sensorQuatUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_QUAT_UUID),
+};
+
+// Characteristic UUID: quaternion period
+static CONST uint8_t sensorQuatPeriodUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_QUAT_PERI_UUID),
+};
+
+// Characteristic UUID: sampling jitter
+static CONST uint8_t sensorJitterUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_JITTER_UUID),
+};
+
+// Characteristic UUID: extended configuration
+static CONST uint8_t sensorConfExtUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_CONF_EXT_UUID),
+};
+
+// Characteristic UUID: duty cycle
+static CONST uint8_t sensorDutyUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_DUTY_UUID),
+};
+
+// Characteristic UUID: vibration spectrum
+static CONST uint8_t sensorSpectrumUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_SPECTRUM_UUID),
+};
+
+// Characteristic UUID: spectrum configuration
+static CONST uint8_t sensorSpectrumConfUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_SPECTRUM_CONF_UUID),
+};
+
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -129,7 +210,8 @@ static CONST gattAttrType_t sensorService = { TI_UUID_SIZE, sensorServiceUUID };
 
 // Characteristic Value: data
 static uint8_t sensorData[SENSOR_DATA_LEN] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-                                               0, 0, 0, 0, 0, 0, 0, 0, 0
+                                               0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                               0, 0, 0
                                              };
 
 // Characteristic Properties: data
@@ -165,6 +247,126 @@ static uint8_t sensorPeriod = SENSOR_MIN_UPDATE_PERIOD / SENSOR_PERIOD_RESOLUTIO
 static uint8_t sensorPeriodUserDescr[] = SENSOR_PERIOD_DESCR;
 #endif
 
+// Characteristic Properties: FIFO
+static uint8_t sensorFifoProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: FIFO (rate in Hz, watermark; rate 0 = FIFO off)
+static uint8_t sensorFifo[SENSOR_FIFO_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: FIFO
+static uint8_t sensorFifoUserDescr[] = SENSOR_FIFO_DESCR;
+#endif
+
+// Characteristic Value: batched data
+static uint8_t sensorBatch[MOVEMENT_BATCH_MAX_LEN];
+static uint8_t sensorBatchLen;
+
+// Characteristic Properties: batched data
+static uint8_t sensorBatchProps = GATT_PROP_READ | GATT_PROP_NOTIFY;
+
+// Characteristic Configuration: batched data
+static gattCharCfg_t *sensorBatchConfig;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: batched data
+static uint8_t sensorBatchUserDescr[] = SENSOR_BATCH_DESCR;
+#endif
+
+// Characteristic Properties: batch size
+static uint8_t sensorBatchSizeProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: batch size
+static uint8_t sensorBatchSize;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: batch size
+static uint8_t sensorBatchSizeUserDescr[] = SENSOR_BATCH_SIZE_DESCR;
+#endif
+
+// Characteristic Value: quaternion
+static uint8_t sensorQuat[MOVEMENT_QUAT_LEN];
+
+// Characteristic Properties: quaternion
+static uint8_t sensorQuatProps = GATT_PROP_READ | GATT_PROP_NOTIFY;
+
+// Characteristic Configuration: quaternion
+static gattCharCfg_t *sensorQuatConfig;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: quaternion
+static uint8_t sensorQuatUserDescr[] = SENSOR_QUAT_DESCR;
+#endif
+
+// Characteristic Properties: quaternion period
+static uint8_t sensorQuatPeriodProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: quaternion period
+static uint8_t sensorQuatPeriod;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: quaternion period
+static uint8_t sensorQuatPeriodUserDescr[] = SENSOR_QUAT_PERI_DESCR;
+#endif
+
+// Characteristic Properties: sampling jitter
+static uint8_t sensorJitterProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: sampling jitter
+static uint8_t sensorJitter[MOVEMENT_JITTER_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: sampling jitter
+static uint8_t sensorJitterUserDescr[] = SENSOR_JITTER_DESCR;
+#endif
+
+// Characteristic Properties: extended configuration
+static uint8_t sensorConfExtProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: extended configuration
+static uint8_t sensorConfExt[MOVEMENT_CONF_EXT_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: extended configuration
+static uint8_t sensorConfExtUserDescr[] = SENSOR_CONF_EXT_DESCR;
+#endif
+
+// Characteristic Properties: duty cycle
+static uint8_t sensorDutyProps = GATT_PROP_READ;
+
+// Characteristic Value: duty cycle
+static uint8_t sensorDuty[MOVEMENT_DUTY_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: duty cycle
+static uint8_t sensorDutyUserDescr[] = SENSOR_DUTY_DESCR;
+#endif
+
+// Characteristic Value: vibration spectrum
+static uint8_t sensorSpectrum[MOVEMENT_SPECTRUM_LEN];
+
+// Characteristic Properties: vibration spectrum
+static uint8_t sensorSpectrumProps = GATT_PROP_READ | GATT_PROP_NOTIFY;
+
+// Characteristic Configuration: vibration spectrum
+static gattCharCfg_t *sensorSpectrumConfig;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: vibration spectrum
+static uint8_t sensorSpectrumUserDescr[] = SENSOR_SPECTRUM_DESCR;
+#endif
+
+// Characteristic Properties: spectrum configuration
+static uint8_t sensorSpectrumConfProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: spectrum configuration
+static uint8_t sensorSpectrumConf[MOVEMENT_SPECTRUM_CONF_LEN];
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: spectrum configuration
+static uint8_t sensorSpectrumConfUserDescr[] = SENSOR_SPECTRUM_CONF_DESCR;
+#endif
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -261,6 +463,290 @@ static gattAttribute_t sensorAttrTable[] =
         sensorPeriodUserDescr
       },
 #endif
+
+     // Characteristic Declaration "FIFO"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorFifoProps
+    },
+
+      // Characteristic Value "FIFO"
+      {
+        { TI_UUID_SIZE, sensorFifoUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        sensorFifo
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "FIFO"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorFifoUserDescr
+      },
+#endif
+
+    // Characteristic Declaration "Batch"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorBatchProps
+    },
+
+      // Characteristic Value "Batch"
+      {
+        { TI_UUID_SIZE, sensorBatchUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorBatch
+      },
+
+      // Characteristic configuration
+      {
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8_t *)&sensorBatchConfig
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Batch"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorBatchUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Batch Size"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorBatchSizeProps
+    },
+
+      // Characteristic Value "Batch Size"
+      {
+        { TI_UUID_SIZE, sensorBatchSizeUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        &sensorBatchSize
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Batch Size"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorBatchSizeUserDescr
+      },
+#endif
+
+    // Characteristic Declaration "Quaternion"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorQuatProps
+    },
+
+      // Characteristic Value "Quaternion"
+      {
+        { TI_UUID_SIZE, sensorQuatUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorQuat
+      },
+
+      // Characteristic configuration
+      {
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8_t *)&sensorQuatConfig
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Quaternion"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorQuatUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Quaternion Period"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorQuatPeriodProps
+    },
+
+      // Characteristic Value "Quaternion Period"
+      {
+        { TI_UUID_SIZE, sensorQuatPeriodUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        &sensorQuatPeriod
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Quaternion Period"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorQuatPeriodUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Jitter"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorJitterProps
+    },
+
+      // Characteristic Value "Jitter"
+      {
+        { TI_UUID_SIZE, sensorJitterUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        sensorJitter
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Jitter"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorJitterUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Extended Configuration"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorConfExtProps
+    },
+
+      // Characteristic Value "Extended Configuration"
+      {
+        { TI_UUID_SIZE, sensorConfExtUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        sensorConfExt
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Extended Configuration"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorConfExtUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Duty Cycle"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorDutyProps
+    },
+
+      // Characteristic Value "Duty Cycle"
+      {
+        { TI_UUID_SIZE, sensorDutyUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorDuty
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Duty Cycle"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorDutyUserDescr
+      },
+#endif
+
+    // Characteristic Declaration "Spectrum"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorSpectrumProps
+    },
+
+      // Characteristic Value "Spectrum"
+      {
+        { TI_UUID_SIZE, sensorSpectrumUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorSpectrum
+      },
+
+      // Characteristic configuration
+      {
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8_t *)&sensorSpectrumConfig
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Spectrum"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorSpectrumUserDescr
+      },
+#endif
+
+     // Characteristic Declaration "Spectrum Configuration"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorSpectrumConfProps
+    },
+
+      // Characteristic Value "Spectrum Configuration"
+      {
+        { TI_UUID_SIZE, sensorSpectrumConfUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        sensorSpectrumConf
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Spectrum Configuration"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorSpectrumConfUserDescr
+      },
+#endif
 };
 
 
@@ -307,9 +793,39 @@ bStatus_t Movement_addService(void)
   {
     return (bleMemAllocError);
   }
+
+  sensorBatchConfig = (gattCharCfg_t *)ICall_malloc(sizeof(gattCharCfg_t) *
+                                                     linkDBNumConns);
+  if (sensorBatchConfig == NULL)
+  {
+    ICall_free(sensorDataConfig);
+    return (bleMemAllocError);
+  }
+
+  sensorQuatConfig = (gattCharCfg_t *)ICall_malloc(sizeof(gattCharCfg_t) *
+                                                    linkDBNumConns);
+  if (sensorQuatConfig == NULL)
+  {
+    ICall_free(sensorDataConfig);
+    ICall_free(sensorBatchConfig);
+    return (bleMemAllocError);
+  }
+
+  sensorSpectrumConfig = (gattCharCfg_t *)ICall_malloc(sizeof(gattCharCfg_t) *
+                                                        linkDBNumConns);
+  if (sensorSpectrumConfig == NULL)
+  {
+    ICall_free(sensorDataConfig);
+    ICall_free(sensorBatchConfig);
+    ICall_free(sensorQuatConfig);
+    return (bleMemAllocError);
+  }
   
   // Register with Link DB to receive link status change callback
   GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorDataConfig);
+  GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorBatchConfig);
+  GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorQuatConfig);
+  GATTServApp_InitCharCfg(INVALID_CONNHANDLE, sensorSpectrumConfig);
 
   // Register GATT attribute list and CBs with GATT Server App
   return GATTServApp_RegisterService( sensorAttrTable,
@@ -372,17 +888,92 @@ bStatus_t Movement_setParameter(uint8_t param, uint8_t len, void *value)
       ret = GATTServApp_ProcessCharCfg(sensorDataConfig, sensorData, FALSE,
                                  sensorAttrTable, GATT_NUM_ATTRS(sensorAttrTable),
                                  INVALID_TASK_ID, sensor_ReadAttrCB);
-    }
-    else
-    {
-      ret = bleInvalidRange;
-    }
-    break;
+    }
+    else
+    {
+      ret = bleInvalidRange;
+    }
+    break;
+
+    case SENSOR_CONF:
+      if (len == SENSOR_CONFIG_LEN )
+      {
+        memcpy(sensorCfg, value, SENSOR_CONFIG_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case SENSOR_PERI:
+      if (len == sizeof(uint8_t))
+      {
+        sensorPeriod = *((uint8_t*)value);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_FIFO:
+      if (len == SENSOR_FIFO_LEN)
+      {
+        memcpy(sensorFifo, value, SENSOR_FIFO_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_BATCH:
+      if (len >= MOVEMENT_BATCH_HDR_LEN && len <= MOVEMENT_BATCH_MAX_LEN)
+      {
+        memcpy(sensorBatch, value, len);
+        sensorBatchLen = len;
+        // See if Notification has been enabled
+        ret = GATTServApp_ProcessCharCfg(sensorBatchConfig, sensorBatch, FALSE,
+                                 sensorAttrTable, GATT_NUM_ATTRS(sensorAttrTable),
+                                 INVALID_TASK_ID, sensor_ReadAttrCB);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_BATCH_SIZE:
+      if (len == MOVEMENT_BATCH_SIZE_LEN)
+      {
+        sensorBatchSize = *((uint8_t*)value);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_QUAT:
+      if (len == MOVEMENT_QUAT_LEN)
+      {
+        memcpy(sensorQuat, value, MOVEMENT_QUAT_LEN);
+        // See if Notification has been enabled
+        ret = GATTServApp_ProcessCharCfg(sensorQuatConfig, sensorQuat, FALSE,
+                                 sensorAttrTable, GATT_NUM_ATTRS(sensorAttrTable),
+                                 INVALID_TASK_ID, sensor_ReadAttrCB);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
 
-    case SENSOR_CONF:
-      if (len == SENSOR_CONFIG_LEN )
+    case MOVEMENT_QUAT_PERI:
+      if (len == MOVEMENT_QUAT_PERI_LEN)
       {
-        memcpy(sensorCfg, value, SENSOR_CONFIG_LEN);
+        sensorQuatPeriod = *((uint8_t*)value);
       }
       else
       {
@@ -390,10 +981,59 @@ bStatus_t Movement_setParameter(uint8_t param, uint8_t len, void *value)
       }
       break;
 
-    case SENSOR_PERI:
-      if (len == sizeof(uint8_t))
+    case MOVEMENT_JITTER:
+      if (len == MOVEMENT_JITTER_LEN)
       {
-        sensorPeriod = *((uint8_t*)value);
+        memcpy(sensorJitter, value, MOVEMENT_JITTER_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_CONF_EXT:
+      if (len == MOVEMENT_CONF_EXT_LEN)
+      {
+        memcpy(sensorConfExt, value, MOVEMENT_CONF_EXT_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_DUTY:
+      if (len == MOVEMENT_DUTY_LEN)
+      {
+        memcpy(sensorDuty, value, MOVEMENT_DUTY_LEN);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_SPECTRUM:
+      if (len == MOVEMENT_SPECTRUM_LEN)
+      {
+        memcpy(sensorSpectrum, value, MOVEMENT_SPECTRUM_LEN);
+        // See if Notification has been enabled
+        ret = GATTServApp_ProcessCharCfg(sensorSpectrumConfig, sensorSpectrum,
+                                 FALSE, sensorAttrTable,
+                                 GATT_NUM_ATTRS(sensorAttrTable),
+                                 INVALID_TASK_ID, sensor_ReadAttrCB);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
+    case MOVEMENT_SPECTRUM_CONF:
+      if (len == MOVEMENT_SPECTRUM_CONF_LEN)
+      {
+        memcpy(sensorSpectrumConf, value, MOVEMENT_SPECTRUM_CONF_LEN);
       }
       else
       {
@@ -440,6 +1080,46 @@ bStatus_t Movement_getParameter(uint8_t param, void *value)
       *((uint8_t*)value) = sensorPeriod;
       break;
 
+    case MOVEMENT_FIFO:
+      memcpy(value, sensorFifo, SENSOR_FIFO_LEN);
+      break;
+
+    case MOVEMENT_BATCH:
+      memcpy(value, sensorBatch, sensorBatchLen);
+      break;
+
+    case MOVEMENT_BATCH_SIZE:
+      *((uint8_t*)value) = sensorBatchSize;
+      break;
+
+    case MOVEMENT_QUAT:
+      memcpy(value, sensorQuat, MOVEMENT_QUAT_LEN);
+      break;
+
+    case MOVEMENT_QUAT_PERI:
+      *((uint8_t*)value) = sensorQuatPeriod;
+      break;
+
+    case MOVEMENT_JITTER:
+      memcpy(value, sensorJitter, MOVEMENT_JITTER_LEN);
+      break;
+
+    case MOVEMENT_CONF_EXT:
+      memcpy(value, sensorConfExt, MOVEMENT_CONF_EXT_LEN);
+      break;
+
+    case MOVEMENT_DUTY:
+      memcpy(value, sensorDuty, MOVEMENT_DUTY_LEN);
+      break;
+
+    case MOVEMENT_SPECTRUM:
+      memcpy(value, sensorSpectrum, MOVEMENT_SPECTRUM_LEN);
+      break;
+
+    case MOVEMENT_SPECTRUM_CONF:
+      memcpy(value, sensorSpectrumConf, MOVEMENT_SPECTRUM_CONF_LEN);
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -496,8 +1176,9 @@ static bStatus_t sensor_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
     // No need for "GATT_SERVICE_UUID" or "GATT_CLIENT_CHAR_CFG_UUID" cases;
     // gattserverapp handles those reads
     case SENSOR_DATA_UUID:
-      *pLen = SENSOR_DATA_LEN;
-      memcpy(pValue, pAttr->pValue, SENSOR_DATA_LEN);
+      // The range byte is left out of notifications at the default MTU
+      *pLen = SENSOR_DATA_LEN > maxLen ? maxLen : SENSOR_DATA_LEN;
+      memcpy(pValue, pAttr->pValue, *pLen);
       break;
 
     case SENSOR_CONFIG_UUID:
@@ -510,6 +1191,66 @@ static bStatus_t sensor_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       pValue[0] = *pAttr->pValue;
       break;
 
+    case SENSOR_FIFO_UUID:
+      *pLen = SENSOR_FIFO_LEN;
+      memcpy(pValue, pAttr->pValue, SENSOR_FIFO_LEN);
+      break;
+
+    case SENSOR_BATCH_UUID:
+      // The application limits the batch size to the ATT MTU; never send
+      // part of a batch
+      if (sensorBatchLen > maxLen)
+      {
+        *pLen = 0;
+        status = ATT_ERR_INVALID_VALUE_SIZE;
+      }
+      else
+      {
+        *pLen = sensorBatchLen;
+        memcpy(pValue, pAttr->pValue, *pLen);
+      }
+      break;
+
+    case SENSOR_BATCH_SIZE_UUID:
+      *pLen = MOVEMENT_BATCH_SIZE_LEN;
+      pValue[0] = *pAttr->pValue;
+      break;
+
+    case SENSOR_QUAT_UUID:
+      *pLen = MOVEMENT_QUAT_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_QUAT_LEN);
+      break;
+
+    case SENSOR_QUAT_PERI_UUID:
+      *pLen = MOVEMENT_QUAT_PERI_LEN;
+      pValue[0] = *pAttr->pValue;
+      break;
+
+    case SENSOR_JITTER_UUID:
+      *pLen = MOVEMENT_JITTER_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_JITTER_LEN);
+      break;
+
+    case SENSOR_CONF_EXT_UUID:
+      *pLen = MOVEMENT_CONF_EXT_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_CONF_EXT_LEN);
+      break;
+
+    case SENSOR_DUTY_UUID:
+      *pLen = MOVEMENT_DUTY_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_DUTY_LEN);
+      break;
+
+    case SENSOR_SPECTRUM_UUID:
+      *pLen = MOVEMENT_SPECTRUM_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_SPECTRUM_LEN);
+      break;
+
+    case SENSOR_SPECTRUM_CONF_UUID:
+      *pLen = MOVEMENT_SPECTRUM_CONF_LEN;
+      memcpy(pValue, pAttr->pValue, MOVEMENT_SPECTRUM_CONF_LEN);
+      break;
+
     default:
       *pLen = 0;
       status = ATT_ERR_ATTR_NOT_FOUND;
@@ -621,6 +1362,225 @@ static bStatus_t sensor_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       }
       break;
 
+    case SENSOR_FIFO_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != SENSOR_FIFO_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value (rate 0 turns the FIFO off)
+      if (status == SUCCESS)
+      {
+        if (pValue[0] == 0 ||
+            (pValue[0] >= MOVEMENT_FIFO_MIN_RATE && pValue[1] > 0 &&
+             pValue[1] <= MOVEMENT_FIFO_MAX_WATERMARK))
+        {
+          memcpy(pAttr->pValue, pValue, SENSOR_FIFO_LEN);
+
+          if (pAttr->pValue == sensorFifo)
+          {
+            notifyApp = MOVEMENT_FIFO;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_INVALID_VALUE;
+        }
+      }
+      break;
+
+    case SENSOR_BATCH_UUID:
+      // Should not get here
+      break;
+
+    case SENSOR_BATCH_SIZE_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != MOVEMENT_BATCH_SIZE_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value (0 turns batching off)
+      if (status == SUCCESS)
+      {
+        if (pValue[0] <= MOVEMENT_BATCH_MAX_SAMPLES)
+        {
+          *pAttr->pValue = pValue[0];
+
+          if (pAttr->pValue == &sensorBatchSize)
+          {
+            notifyApp = MOVEMENT_BATCH_SIZE;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_INVALID_VALUE;
+        }
+      }
+      break;
+
+    case SENSOR_QUAT_UUID:
+      // Should not get here
+      break;
+
+    case SENSOR_QUAT_PERI_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != MOVEMENT_QUAT_PERI_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value (0 turns the fusion off)
+      if (status == SUCCESS)
+      {
+        *pAttr->pValue = pValue[0];
+
+        if (pAttr->pValue == &sensorQuatPeriod)
+        {
+          notifyApp = MOVEMENT_QUAT_PERI;
+        }
+      }
+      break;
+
+    case SENSOR_JITTER_UUID:
+      // Any single byte write restarts the statistics
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != 1)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      if (status == SUCCESS)
+      {
+        memset(pAttr->pValue, 0, MOVEMENT_JITTER_LEN);
+
+        if (pAttr->pValue == sensorJitter)
+        {
+          notifyApp = MOVEMENT_JITTER;
+        }
+      }
+      break;
+
+    case SENSOR_CONF_EXT_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != MOVEMENT_CONF_EXT_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value
+      if (status == SUCCESS)
+      {
+        uint16_t accBw;
+        uint16_t gyrBw;
+
+        accBw = BUILD_UINT16(pValue[2], pValue[3]);
+        gyrBw = BUILD_UINT16(pValue[4], pValue[5]);
+
+        if (pValue[0] <= MOVEMENT_MAX_GYR_RANGE &&
+            pValue[1] <= MOVEMENT_MAX_DLPF &&
+            (accBw == 0 ||
+             (accBw >= MOVEMENT_MIN_BW && accBw <= MOVEMENT_MAX_BW)) &&
+            (gyrBw == 0 ||
+             (gyrBw >= MOVEMENT_MIN_BW && gyrBw <= MOVEMENT_MAX_BW)) &&
+            (pValue[6] == 0 || pValue[6] == 8 || pValue[6] == 100) &&
+            pValue[7] <= MOVEMENT_MAX_AUTO_RANGE)
+        {
+          memcpy(pAttr->pValue, pValue, MOVEMENT_CONF_EXT_LEN);
+
+          if (pAttr->pValue == sensorConfExt)
+          {
+            notifyApp = MOVEMENT_CONF_EXT;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_INVALID_VALUE;
+        }
+      }
+      break;
+
+    case SENSOR_SPECTRUM_UUID:
+      // Should not get here
+      break;
+
+    case SENSOR_SPECTRUM_CONF_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != MOVEMENT_SPECTRUM_CONF_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value (window size 0 turns the spectrum off)
+      if (status == SUCCESS)
+      {
+        if ((pValue[0] == 0 ||
+             (pValue[0] >= MOVEMENT_SPECTRUM_MIN_LOG2 &&
+              pValue[0] <= MOVEMENT_SPECTRUM_MAX_LOG2)) &&
+            pValue[1] <= MOVEMENT_SPECTRUM_MAX_AXIS)
+        {
+          memcpy(pAttr->pValue, pValue, MOVEMENT_SPECTRUM_CONF_LEN);
+
+          if (pAttr->pValue == sensorSpectrumConf)
+          {
+            notifyApp = MOVEMENT_SPECTRUM_CONF;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_INVALID_VALUE;
+        }
+      }
+      break;
+
     case GATT_CLIENT_CHAR_CFG_UUID:
       status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
                                               offset, GATT_CLIENT_CFG_NOTIFY);
@@ -59,12 +59,114 @@ extern "C"
 #define MOVEMENT_DATA_UUID             0xAA81
 #define MOVEMENT_CONF_UUID             0xAA82
 #define MOVEMENT_PERI_UUID             0xAA83
+#define MOVEMENT_FIFO_UUID             0xAA84
+#define MOVEMENT_BATCH_UUID            0xAA85
+#define MOVEMENT_BATCH_SIZE_UUID       0xAA86
+#define MOVEMENT_QUAT_UUID             0xAA87
+#define MOVEMENT_QUAT_PERI_UUID        0xAA88
+#define MOVEMENT_JITTER_UUID           0xAA89
+#define MOVEMENT_CONF_EXT_UUID         0xAA8A
+#define MOVEMENT_DUTY_UUID             0xAA8B
+#define MOVEMENT_SPECTRUM_UUID         0xAA8C
+#define MOVEMENT_SPECTRUM_CONF_UUID    0xAA8D
+
+// Movement specific parameters (continues from SENSOR_PERI)
+#define MOVEMENT_FIFO                  3  // RW FIFO rate (Hz) + watermark
+#define MOVEMENT_BATCH                 4  // RN batched samples
+#define MOVEMENT_BATCH_SIZE            5  // RW samples per batch (0 = off)
+#define MOVEMENT_QUAT                  6  // RN orientation quaternion
+#define MOVEMENT_QUAT_PERI             7  // RW quaternion period (0 = off)
+#define MOVEMENT_JITTER                8  // RW sampling jitter (write resets)
+#define MOVEMENT_CONF_EXT              9  // RW extended configuration
+#define MOVEMENT_DUTY                  10 // R  time per state, WOM tuning
+#define MOVEMENT_SPECTRUM              11 // RN vibration spectrum
+#define MOVEMENT_SPECTRUM_CONF         12 // RW spectrum window and axis
 
 // Sensor Profile Services bit fields
 #define MOVEMENT_SERVICE               0x00000020
 
-// Length of sensor data in bytes
-#define MOVEMENT_DATA_LEN              18
+// Length of sensor data in bytes: gyro, accelerometer and magnetometer
+// X/Y/Z followed by the 16 bit sample time stamp and the accelerometer
+// range (0-3: 2-16 G). A notification at the default ATT_MTU of 23 carries
+// the first 20 bytes; the range byte needs an ATT_MTU of at least 24.
+#define MOVEMENT_DATA_LEN              21
+#define MOVEMENT_AXES_LEN              18
+#define MOVEMENT_FIFO_LEN              2
+#define MOVEMENT_BATCH_SIZE_LEN        1
+#define MOVEMENT_QUAT_LEN              8     // w, x, y, z (Q14)
+#define MOVEMENT_QUAT_PERI_LEN         1     // resolution 10 ms
+
+// Sampling jitter: min and max interval (us, 32 bit), mean absolute
+// deviation from the period (us, 16 bit), number of intervals (16 bit)
+#define MOVEMENT_JITTER_LEN            12
+
+// Extended configuration: gyro range (0-3: 250-2000 deg/s), filter
+// (0 = auto, 1-6: 184-5 Hz), accelerometer and gyro bandwidth limit for the
+// auto filter (Hz, 16 bit, 0 = none), magnetometer rate (0 = one
+// measurement per sample, 8 or 100 Hz), accelerometer auto range (0 = off,
+// 1 = on). Accelerometer and gyro are sampled at the period or the FIFO
+// rate; the auto filter is the widest below half that rate.
+#define MOVEMENT_CONF_EXT_LEN          8
+
+// Duty cycle: seconds in the off, idle, active and error states (32 bit
+// each), wake-on-motion threshold (4 mg) and inactivity timeout (s)
+#define MOVEMENT_DUTY_LEN              18
+
+// Vibration spectrum of one window of accelerometer samples: four peaks,
+// largest first, each a bin (8 bit, k * rate / N Hz) and an amplitude
+// (16 bit), then the RMS level (16 bit) of four bands of equal width from
+// 0 to rate / 2. Levels are in accelerometer LSB.
+#define MOVEMENT_SPECTRUM_LEN          20
+#define MOVEMENT_SPECTRUM_PEAK_LEN     3
+
+// Spectrum configuration: log2 of the window size (0 = off, 8 or 9 for
+// 256 or 512 samples) and input (0-2: X/Y/Z, 3: vector length)
+#define MOVEMENT_SPECTRUM_CONF_LEN     2
+
+// Sample time stamps are latched when the MPU signals data ready. Full time
+// stamps are AON RTC values (16.16 seconds). 16 bit time stamps and deltas
+// are in units of 1/4096 s (AON RTC >> MOVEMENT_TS_SHIFT), wrapping after
+// 16 s
+#define MOVEMENT_TS_SHIFT              4
+#define MOVEMENT_TS_MASK               0xFFFF
+
+// Batched data: count, sample length, accelerometer range, base time stamp
+// (AON RTC, 32 bit) followed by the samples; each sample is a time delta
+// (16 bit) and the enabled axes. All samples of a batch share the range.
+// A batch is one notification of at most ATT_MTU - 3 bytes,
+// and the ATT_MTU is at most MAX_PDU_SIZE - 4 (62 bytes with the build
+// setting of 69). At the default ATT_MTU of 23 a batch holds one sample of
+// a single sensor; batching with all axes enabled needs a negotiated MTU
+// and then holds two samples. Without LE data length extension the link
+// layer sends 27 bytes per packet, so a batch of two all-axes samples takes
+// two packets like two data notifications do; the gain is with fewer axes,
+// e.g. six gyro samples in three packets instead of six.
+#ifdef MAX_PDU_SIZE
+#define MOVEMENT_BATCH_MAX_LEN         ( MAX_PDU_SIZE - 7 )
+#else
+#define MOVEMENT_BATCH_MAX_LEN         20
+#endif
+#define MOVEMENT_BATCH_HDR_LEN         7
+#define MOVEMENT_BATCH_DELTA_LEN       2
+#define MOVEMENT_BATCH_MAX_SAMPLES     ( (MOVEMENT_BATCH_MAX_LEN - \
+                                          MOVEMENT_BATCH_HDR_LEN) / \
+                                         (MOVEMENT_BATCH_DELTA_LEN + 6) )
+
+// FIFO configuration limits
+#define MOVEMENT_FIFO_MIN_RATE         4     // Hz
+#define MOVEMENT_FIFO_MAX_WATERMARK    16    // samples per read-out
+
+// Extended configuration limits
+#define MOVEMENT_MAX_GYR_RANGE         3
+#define MOVEMENT_MAX_DLPF              6
+#define MOVEMENT_MIN_BW                5     // Hz
+#define MOVEMENT_MAX_BW                184   // Hz
+#define MOVEMENT_MAX_AUTO_RANGE        1
+
+// Spectrum configuration limits
+#define MOVEMENT_SPECTRUM_MIN_LOG2     8     // 256 samples
+#define MOVEMENT_SPECTRUM_MAX_LOG2     9     // 512 samples
+#define MOVEMENT_SPECTRUM_MAX_AXIS     3
 
 /*********************************************************************
  * TYPEDEFS
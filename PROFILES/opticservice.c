@@ -63,6 +63,7 @@
 #define SENSOR_DATA_UUID        OPTIC_DATA_UUID
 #define SENSOR_CONFIG_UUID      OPTIC_CONF_UUID
 #define SENSOR_PERIOD_UUID      OPTIC_PERI_UUID
+#define SENSOR_WINDOW_UUID      OPTIC_WINDOW_UUID
 
 #define SENSOR_SERVICE          OPTIC_SERVICE
 #define SENSOR_DATA_LEN         OPTIC_DATA_LEN
@@ -70,6 +71,7 @@
 #define SENSOR_DATA_DESCR       "Optic Data"
 #define SENSOR_CONFIG_DESCR     "Optic Conf."
 #define SENSOR_PERIOD_DESCR     "Optic Period"
+#define SENSOR_WINDOW_DESCR     "Optic Window"
 
 /*********************************************************************
  * TYPEDEFS
@@ -103,6 +105,12 @@ static CONST uint8_t sensorPeriodUUID[TI_UUID_SIZE] =
   TI_UUID(SENSOR_PERIOD_UUID),
 };
 
+// Characteristic UUID: send-on-change window
+static CONST uint8_t sensorWindowUUID[TI_UUID_SIZE] =
+{
+  TI_UUID(SENSOR_WINDOW_UUID),
+};
+
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -162,6 +170,17 @@ static uint8_t sensorPeriod = SENSOR_MIN_UPDATE_PERIOD / SENSOR_PERIOD_RESOLUTIO
 static uint8_t sensorPeriodUserDescr[] = SENSOR_PERIOD_DESCR;
 #endif
 
+// Characteristic Properties: send-on-change window
+static uint8_t sensorWindowProps = GATT_PROP_READ | GATT_PROP_WRITE;
+
+// Characteristic Value: send-on-change window
+static uint8_t sensorWindow = 0;
+
+#ifdef USER_DESCRIPTION
+// Characteristic User Description: send-on-change window
+static uint8_t sensorWindowUserDescr[] = SENSOR_WINDOW_DESCR;
+#endif
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -259,6 +278,32 @@ static gattAttribute_t sensorAttrTable[] =
         sensorPeriodUserDescr
       },
 #endif
+
+    // Characteristic Declaration "Window"
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &sensorWindowProps
+    },
+
+      // Characteristic Value "Window"
+      {
+        { TI_UUID_SIZE, sensorWindowUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        &sensorWindow
+      },
+
+#ifdef USER_DESCRIPTION
+      // Characteristic User Description "Window"
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        sensorWindowUserDescr
+      },
+#endif
 };
 
 
@@ -399,6 +444,17 @@ bStatus_t Optic_setParameter(uint8_t param, uint8_t len, void *value)
       }
       break;
 
+    case OPTIC_WINDOW:
+      if (len == OPTIC_WINDOW_LEN)
+      {
+        sensorWindow = *((uint8_t*)value);
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -438,6 +494,10 @@ bStatus_t Optic_getParameter(uint8_t param, void *value)
       *((uint8_t*)value) = sensorPeriod;
       break;
 
+    case OPTIC_WINDOW:
+      *((uint8_t*)value) = sensorWindow;
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -500,6 +560,7 @@ static bStatus_t sensor_ReadAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
 
     case SENSOR_CONFIG_UUID:
     case SENSOR_PERIOD_UUID:
+    case SENSOR_WINDOW_UUID:
       *pLen = 1;
       pValue[0] = *pAttr->pValue;
       break;
@@ -618,6 +679,40 @@ static bStatus_t sensor_WriteAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
       }
       break;
 
+    case SENSOR_WINDOW_UUID:
+      // Validate the value
+      // Make sure it's not a blob oper
+      if (offset == 0)
+      {
+        if (len != OPTIC_WINDOW_LEN)
+        {
+          status = ATT_ERR_INVALID_VALUE_SIZE;
+        }
+      }
+      else
+      {
+        status = ATT_ERR_ATTR_NOT_LONG;
+      }
+
+      // Write the value (0 turns send-on-change off)
+      if (status == SUCCESS)
+      {
+        if (pValue[0] <= OPTIC_WINDOW_MAX)
+        {
+          *pAttr->pValue = pValue[0];
+
+          if (pAttr->pValue == &sensorWindow)
+          {
+            notifyApp = OPTIC_WINDOW;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_INVALID_VALUE;
+        }
+      }
+      break;
+
     case GATT_CLIENT_CHAR_CFG_UUID:
       status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
                                               offset, GATT_CLIENT_CFG_NOTIFY);
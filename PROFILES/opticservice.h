@@ -59,10 +59,19 @@ extern "C"
 #define OPTIC_DATA_UUID         0xAA71
 #define OPTIC_CONF_UUID         0xAA72
 #define OPTIC_PERI_UUID         0xAA73
+#define OPTIC_WINDOW_UUID       0xAA74
+
+// Optic specific parameters (continues from SENSOR_PERI)
+#define OPTIC_WINDOW            3  // RW send-on-change window (0 = off)
 
 // Length of sensor data in bytes
 #define OPTIC_DATA_LEN          2
 
+// Send-on-change window: half width in percent of the last reported value.
+// Data is only notified when the light level leaves the window.
+#define OPTIC_WINDOW_LEN        1
+#define OPTIC_WINDOW_MAX        100
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -38,6 +38,7 @@
 #include <ti/sysbios/family/arm/cc26xx/Power.h>
 #include <ti/sysbios/family/arm/cc26xx/PowerCC2650.h>
 #include <ti/sysbios/BIOS.h>
+#include <ti/drivers/pin/PINCC26XX.h>
 #include <driverlib/vims.h>
 
 // BLE
@@ -45,9 +46,7 @@
 
 // Modules with their own tasks
 #include "SensorTag.h"
-#include "SensorTag_Tmp.h"
-#include "SensorTag_Hum.h"
-#include "SensorTag_Bar.h"
+#include "Board.h"
 
 #ifndef USE_DEFAULT_USER_CFG
 
@@ -58,9 +57,20 @@ bleUserCfg_t user0Cfg = BLE_USER_CFG;
 
 #endif // USE_DEFAULT_USER_CFG
 
+// Pin events serviced first: bursty movement data ready and the reed relay
+static const PIN_Id pinIsrOrder[] =
+{
+  Board_MPU_INT,
+  Board_RELAY,
+  Board_KEY_LEFT,
+  Board_KEY_RIGHT,
+  PIN_TERMINATE
+};
+
 int main()
 {
   PIN_init(BoardGpioInitTable);
+  PINCC26XX_setIsrOrder(pinIsrOrder);
 
 #ifndef POWER_SAVING
   /* Set constraints for Standby and Idle mode */
@@ -79,9 +89,6 @@ int main()
 
   /* Kick off application - Priority 1 */
   SensorTag_createTask();
-  SensorTagTmp_createTask();
-  SensorTagHum_createTask();
-  SensorTagBar_createTask();
 
   BIOS_start();     /* enable interrupts and start SYS/BIOS */
 
@@ -0,0 +1,110 @@
+/*******************************************************************************
+  Filename:       bench.h
+
+  Description:    Host side helpers of the test and benchmark programs: a time
+                  stamp for cycle counts and a check macro.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+// Include before any other header: clock_gettime needs POSIX
+#if !defined(__x86_64__) && !defined(__i386__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE           199309L
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Host time stamp: the time stamp counter on x86, else nanoseconds.
+// Only ratios between two measurements on the same host are meaningful;
+// on the CC2650 the same code runs several times slower per cycle.
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT                "cycles"
+static inline uint64_t benchStamp(void)
+{
+  return __rdtsc();
+}
+#else
+#include <time.h>
+#define BENCH_UNIT                "ns"
+static inline uint64_t benchStamp(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+// Check a condition, count and report failures
+#define CHECK(cond, ...)                                                \
+  do                                                                    \
+  {                                                                     \
+    if (!(cond))                                                        \
+    {                                                                   \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                       \
+      printf(__VA_ARGS__);                                              \
+      printf("\n");                                                     \
+      benchFailures++;                                                  \
+    }                                                                   \
+  } while (0)
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static int benchFailures;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Exit status and summary line of a test program
+ */
+static inline int benchResult(const char *name)
+{
+  printf("%s: %s (%d failure%s)\n", name, benchFailures ? "FAILED" : "passed",
+         benchFailures, benchFailures == 1 ? "" : "s");
+  return benchFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+  Filename:       PIN.h
+
+  Description:    Host stand-in for the TI-RTOS PIN driver interface. The
+                  functions are implemented by each test program.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+#ifndef ti_drivers_PIN__include
+#define ti_drivers_PIN__include
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define PIN_TERMINATE             0xFE
+#define PIN_UNASSIGNED            0xFF
+
+#define PIN_INPUT_EN              0x00000000
+#define PIN_PULLDOWN              0x00010000
+#define PIN_HYSTERESIS            0x00020000
+#define PIN_GPIO_OUTPUT_EN        0x00040000
+#define PIN_GPIO_HIGH             0x00080000
+#define PIN_PUSHPULL              0x00000000
+#define PIN_DRVSTR_MIN            0x00000000
+#define PIN_DRVSTR_MAX            0x00100000
+#define PIN_GPIO_LOW              0x00000000
+#define PIN_IRQ_DIS               0x00000000
+#define PIN_IRQ_POSEDGE           0x00200000
+
+/*********************************************************************
+ * MACROS
+ */
+#define PIN_ID(x)                 ((x) & 0xFF)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef uint32_t PIN_Config;
+typedef uint8_t PIN_Id;
+typedef struct PIN_State_s
+{
+  uint32_t output;
+} PIN_State;
+typedef PIN_State *PIN_Handle;
+typedef void (*PIN_IntCb)(PIN_Handle handle, PIN_Id pinId);
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Provided by the test program
+ */
+extern PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[]);
+extern void PIN_close(PIN_Handle handle);
+extern int PIN_registerIntCb(PIN_Handle handle, PIN_IntCb cb);
+extern int PIN_setInterrupt(PIN_Handle handle, PIN_Config pinCfg);
+extern int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t val);
+extern uint32_t PIN_getOutputValue(PIN_Id pinId);
+
+#endif /* ti_drivers_PIN__include */
@@ -0,0 +1,353 @@
+/*******************************************************************************
+  Filename:       test_bmp280.c
+
+  Description:    Host test of the BMP280 integer compensation
+                  (sensor_bmp280.c): data sheet example, comparison with the
+                  double precision formula and time per conversion.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -Wno-unused-parameter -O2 -ITest/stubs \
+ *       -IBoard/Devices -IBoard/Interfaces -o test_bmp280 Test/test_bmp280.c \
+ *       Board/Devices/sensor_bmp280.c -lm && ./test_bmp280
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <math.h>
+#include <string.h>
+#include "sensor_bmp280.h"
+#include "sensor.h"
+#include "bsp_i2c.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Calibration register block
+#define ADDR_CALIB                0x88
+#define CALIB_DATA_SIZE           24
+
+// Data sheet example (BST-BMP280-DS001, section 3.12): raw values and
+// results of the integer compensation
+#define DS_ADC_T                  519888
+#define DS_ADC_P                  415148
+#define DS_TEMP                   2508        // 0.01 degrees C
+#define DS_PRESS_Q24_8            25767236    // 100653.27 Pa
+
+// Accepted difference from the double precision formula
+#define MAX_TEMP_ERR              1           // 0.01 degrees C
+#define MAX_PRESS_ERR             1           // Pa
+
+// Timed conversions
+#define BENCH_CONVERSIONS         100000
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint16_t T1;
+  int16_t T2, T3;
+  uint16_t P1;
+  int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+} cal_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Calibration of the data sheet example
+static const cal_t dsCal =
+{
+  27504, 26435, -1000,
+  36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000
+};
+
+// Calibration presented by the simulated sensor
+static uint8_t calRegs[CALIB_DATA_SIZE];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Calibration registers: little endian words T1-T3, P1-P9
+ */
+static void setCalibration(const cal_t *c)
+{
+  const uint16_t w[12] =
+  {
+    c->T1, (uint16_t)c->T2, (uint16_t)c->T3, c->P1, (uint16_t)c->P2,
+    (uint16_t)c->P3, (uint16_t)c->P4, (uint16_t)c->P5, (uint16_t)c->P6,
+    (uint16_t)c->P7, (uint16_t)c->P8, (uint16_t)c->P9
+  };
+  uint8_t i;
+
+  for (i = 0; i < 12; i++)
+  {
+    calRegs[2 * i] = w[i] & 0xFF;
+    calRegs[2 * i + 1] = w[i] >> 8;
+  }
+}
+
+/*
+ * Raw data as read from the sensor: pressure then temperature, 20 bits
+ * each, MSB first
+ */
+static void rawData(int32_t adcT, int32_t adcP, uint8_t *data)
+{
+  data[0] = adcP >> 12;
+  data[1] = (adcP >> 4) & 0xFF;
+  data[2] = (adcP & 0x0F) << 4;
+  data[3] = adcT >> 12;
+  data[4] = (adcT >> 4) & 0xFF;
+  data[5] = (adcT & 0x0F) << 4;
+}
+
+/*
+ * Double precision compensation of the data sheet (section 8.1)
+ */
+static void floatCompensate(const cal_t *c, int32_t adcT, int32_t adcP,
+                            double *temp, double *press)
+{
+  double v1, v2, tFine, p;
+
+  v1 = (adcT / 16384.0 - c->T1 / 1024.0) * c->T2;
+  v2 = (adcT / 131072.0 - c->T1 / 8192.0) *
+       (adcT / 131072.0 - c->T1 / 8192.0) * c->T3;
+  tFine = v1 + v2;
+  *temp = tFine / 5120.0;
+
+  v1 = tFine / 2.0 - 64000.0;
+  v2 = v1 * v1 * c->P6 / 32768.0;
+  v2 = v2 + v1 * c->P5 * 2.0;
+  v2 = v2 / 4.0 + c->P4 * 65536.0;
+  v1 = (c->P3 * v1 * v1 / 524288.0 + c->P2 * v1) / 524288.0;
+  v1 = (1.0 + v1 / 32768.0) * c->P1;
+  if (v1 == 0)
+  {
+    *press = 0;
+    return;
+  }
+  p = 1048576.0 - adcP;
+  p = (p - v2 / 4096.0) * 6250.0 / v1;
+  v1 = c->P9 * p * p / 2147483648.0;
+  v2 = p * c->P8 / 32768.0;
+  *press = p + (v1 + v2 + c->P7) / 16.0;
+}
+
+/*********************************************************************
+ * SIMULATED INTERFACES
+ */
+
+bool bspI2cSelect(uint8_t interface, uint8_t slaveAddress)
+{
+  return interface == BSP_I2C_INTERFACE_0 && slaveAddress == 0x77;
+}
+
+void bspI2cDeselect(void)
+{
+}
+
+void bspI2cBatchRead(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                     uint8_t *data, uint8_t len)
+{
+}
+
+bool sensorReadReg(uint8_t addr, uint8_t *pBuf, uint8_t nBytes)
+{
+  if (addr == ADDR_CALIB && nBytes == CALIB_DATA_SIZE)
+  {
+    memcpy(pBuf, calRegs, nBytes);
+  }
+  else
+  {
+    memset(pBuf, 0, nBytes);
+  }
+  return true;
+}
+
+bool sensorWriteReg(uint8_t addr, uint8_t *pBuf, uint8_t nBytes)
+{
+  return true;
+}
+
+void sensorSetErrorData(uint8_t *pBuf, uint8_t nBytes)
+{
+  memset(pBuf, ST_ERROR_DATA, nBytes);
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+/*
+ * Data sheet example
+ */
+static void testDataSheet(void)
+{
+  uint8_t data[BMP_DATA_SIZE];
+  uint32_t press;
+  int32_t temp;
+
+  rawData(DS_ADC_T, DS_ADC_P, data);
+  sensorBmp280Convert(data, &temp, &press);
+
+  CHECK(temp == DS_TEMP, "data sheet temperature %d, expected %d",
+        temp, DS_TEMP);
+  CHECK(press == (DS_PRESS_Q24_8 + 128) / 256,
+        "data sheet pressure %u Pa, expected %u", press,
+        (DS_PRESS_Q24_8 + 128) / 256);
+  printf("Data sheet example: %d.%02d C, %u Pa (data sheet 25.08 C, "
+         "100653.27 Pa)\n", temp / 100, temp % 100, press);
+}
+
+/*
+ * Integer against double precision over the sensor range
+ */
+static void testRange(void)
+{
+  uint8_t data[BMP_DATA_SIZE];
+  double maxTempErr = 0;
+  double maxPressErr = 0;
+  double minTemp = 1000, maxTemp = -1000;
+  int32_t adcT, adcP;
+
+  for (adcT = 300000; adcT <= 720000; adcT += 6000)
+  {
+    for (adcP = 200000; adcP <= 700000; adcP += 5000)
+    {
+      double fTemp, fPress;
+      uint32_t press;
+      int32_t temp;
+
+      rawData(adcT, adcP, data);
+      sensorBmp280Convert(data, &temp, &press);
+      floatCompensate(&dsCal, adcT, adcP, &fTemp, &fPress);
+
+      // Outside 300 - 1100 hPa the sensor is not specified
+      if (fPress < 30000 || fPress > 110000)
+      {
+        continue;
+      }
+      minTemp = fTemp < minTemp ? fTemp : minTemp;
+      maxTemp = fTemp > maxTemp ? fTemp : maxTemp;
+      if (fabs(temp - fTemp * 100) > maxTempErr)
+      {
+        maxTempErr = fabs(temp - fTemp * 100);
+      }
+      if (fabs(press - fPress) > maxPressErr)
+      {
+        maxPressErr = fabs(press - fPress);
+      }
+    }
+  }
+
+  CHECK(maxTempErr <= MAX_TEMP_ERR, "temperature off by %.2f (0.01 C)",
+        maxTempErr);
+  CHECK(maxPressErr <= MAX_PRESS_ERR, "pressure off by %.2f Pa",
+        maxPressErr);
+  printf("%.0f..%.0f C, 300..1100 hPa: largest difference from double "
+         "precision %.2f (0.01 C), %.2f Pa\n", minTemp, maxTemp, maxTempErr,
+         maxPressErr);
+}
+
+/*
+ * Time per conversion, integer and double precision
+ */
+static void bench(void)
+{
+  uint8_t data[BMP_DATA_SIZE];
+  volatile uint32_t sink = 0;
+  uint64_t tInt, tFloat;
+  uint32_t press;
+  int32_t temp;
+  uint32_t i;
+
+  tInt = benchStamp();
+  for (i = 0; i < BENCH_CONVERSIONS; i++)
+  {
+    rawData(500000 + (i & 0xFFFF), 300000 + (i & 0x3FFFF), data);
+    sensorBmp280Convert(data, &temp, &press);
+    sink += press + temp;
+  }
+  tInt = benchStamp() - tInt;
+
+  tFloat = benchStamp();
+  for (i = 0; i < BENCH_CONVERSIONS; i++)
+  {
+    double fTemp, fPress;
+
+    rawData(500000 + (i & 0xFFFF), 300000 + (i & 0x3FFFF), data);
+    floatCompensate(&dsCal, 500000 + (i & 0xFFFF), 300000 + (i & 0x3FFFF),
+                    &fTemp, &fPress);
+    sink += (uint32_t)fPress + (int32_t)fTemp;
+  }
+  tFloat = benchStamp() - tFloat;
+
+  printf("Per conversion: integer %llu %s, double precision %llu %s "
+         "(host FPU; the CC2650 has none)\n",
+         (unsigned long long)(tInt / BENCH_CONVERSIONS), BENCH_UNIT,
+         (unsigned long long)(tFloat / BENCH_CONVERSIONS), BENCH_UNIT);
+  (void)sink;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  uint8_t data[BMP_DATA_SIZE];
+  uint32_t press;
+  int32_t temp;
+
+  // Not calibrated yet
+  rawData(DS_ADC_T, DS_ADC_P, data);
+  sensorBmp280Convert(data, &temp, &press);
+  CHECK(press == 0, "pressure %u without calibration", press);
+
+  setCalibration(&dsCal);
+  CHECK(sensorBmp280Init(), "init failed");
+
+  testDataSheet();
+  testRange();
+  bench();
+
+  return benchResult("test_bmp280");
+}
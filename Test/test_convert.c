@@ -0,0 +1,518 @@
+/*******************************************************************************
+  Filename:       test_convert.c
+
+  Description:    Host test and benchmark of the fixed point sensor converters
+                  against the exact formulas and the float converters they
+                  replaced.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -Wno-unused-parameter -O2 -DCC2650ST_0120 \
+ *       -ITest/stubs -IBoard/Devices -IBoard/Interfaces -o test_convert \
+ *       Test/test_convert.c Board/Interfaces/sensor.c \
+ *       Board/Devices/sensor_hdc1000.c Board/Devices/sensor_tmp007.c \
+ *       Board/Devices/sensor_opt3001.c Board/Devices/sensor_mpu9250.c \
+ *       -lm && ./test_convert
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <math.h>
+#include "Board.h"
+#include "sensor.h"
+#include "bsp_i2c.h"
+#include "sensor_hdc1000.h"
+#include "sensor_tmp007.h"
+#include "sensor_opt3001.h"
+#include "sensor_mpu9250.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Largest accepted error of a conversion (hundredths): rounding only
+#define MAX_ERROR                 0.5001
+
+// Calls per timed converter
+#define BENCH_CALLS               65536
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  const char *name;
+  double maxErr;
+  uint64_t tFixed;
+  uint64_t tFloat;
+} result_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Results collected for the summary
+static result_t results[8];
+static uint8_t nResults;
+
+// Keeps timed results alive
+static volatile double sink;
+
+/*********************************************************************
+ * FLOAT CONVERTERS REPLACED BY THE FIXED POINT ONES
+ */
+
+static void oldHdc1000Convert(uint16_t rawTemp, uint16_t rawHum,
+                              float *temp, float *hum)
+{
+  *temp = ((double)(int16_t)rawTemp / 65536)*165 - 40;
+  *hum = ((double)rawHum / 65536)*100;
+}
+
+static void oldTmp007Convert(uint16_t rawTemp, uint16_t rawObjTemp,
+                             float *tObj, float *tTgt)
+{
+  const float SCALE_LSB = 0.03125;
+  float t;
+  int it;
+
+  it = (int)((rawObjTemp) >> 2);
+  t = ((float)(it)) * SCALE_LSB;
+  *tObj = t;
+
+  it = (int)((rawTemp) >> 2);
+  t = (float)it;
+  *tTgt = t * SCALE_LSB;
+}
+
+static float oldOpt3001Convert(uint16_t rawData)
+{
+  uint16_t e, m;
+
+  m = rawData & 0x0FFF;
+  e = (rawData & 0xF000) >> 12;
+
+  return m * (0.01 * exp2(e));
+}
+
+static float oldMpu9250AccConvert(int16_t rawData, uint8_t range)
+{
+  return (rawData * 1.0) / (32768 >> (range + 1));
+}
+
+static float oldMpu9250GyroConvert(int16_t data)
+{
+  return (data * 1.0) / (65536 / 500);
+}
+
+static uint16_t oldFloatToSfloat(float data)
+{
+  double sgn = data > 0 ? +1 : -1;
+  double mantissa = fabs(data) * 100.0;
+  int exponent = 0;
+
+  while (mantissa > (float)0xFFF)
+  {
+    exponent++;
+    mantissa /= 2.0;
+  }
+
+  return ((exponent & 0xF) << 12) | ((uint16_t)(int)round(sgn * mantissa) & 0xFFF);
+}
+
+/*********************************************************************
+ * SIMULATED INTERFACES
+ */
+
+bool bspI2cSelect(uint8_t interface, uint8_t slaveAddress)
+{
+  return true;
+}
+
+void bspI2cDeselect(void)
+{
+}
+
+bool bspI2cRead(uint8_t *data, uint8_t len)
+{
+  return true;
+}
+
+bool bspI2cWrite(uint8_t *data, uint8_t len)
+{
+  return true;
+}
+
+bool bspI2cWriteSingle(uint8_t data)
+{
+  return true;
+}
+
+bool bspI2cWriteRead(uint8_t *wdata, uint8_t wlen, uint8_t *rdata,
+                     uint8_t rlen)
+{
+  return true;
+}
+
+void bspI2cBatchRead(bspI2cBatchOp_t *op, uint8_t address, uint8_t reg,
+                     uint8_t *data, uint8_t len)
+{
+}
+
+bool extFlashTest(void)
+{
+  return true;
+}
+
+bool sensorBmp280Test(void)
+{
+  return true;
+}
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[])
+{
+  return state;
+}
+
+int PIN_registerIntCb(PIN_Handle handle, PIN_IntCb cb)
+{
+  return 0;
+}
+
+int PIN_setInterrupt(PIN_Handle handle, PIN_Config pinCfg)
+{
+  return 0;
+}
+
+int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t val)
+{
+  return 0;
+}
+
+uint32_t PIN_getOutputValue(PIN_Id pinId)
+{
+  return pinId == Board_MPU_POWER ? Board_MPU_POWER_ON : 0;
+}
+
+void CPUdelay(uint32_t count)
+{
+}
+
+uint32_t AONRTCCurrentCompareValueGet(void)
+{
+  return 0;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Record the largest error of a converter and check it
+ */
+static result_t *report(const char *name, double maxErr, double limit)
+{
+  result_t *r = &results[nResults++];
+
+  CHECK(maxErr <= limit, "%s: error %.4f hundredths", name, maxErr);
+  r->name = name;
+  r->maxErr = maxErr;
+  return r;
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+/*
+ * Humidity sensor, all raw values against the data sheet formula
+ */
+static void testHdc1000(void)
+{
+  double errT = 0, errH = 0;
+  result_t *r;
+  uint32_t raw;
+  uint64_t t;
+
+  for (raw = 0; raw <= 0xFFFF; raw++)
+  {
+    int16_t temp;
+    uint16_t hum;
+
+    sensorHdc1000Convert(raw, raw, &temp, &hum);
+    errT = fmax(errT, fabs(temp - (raw / 65536.0 * 165 - 40) * 100));
+    errH = fmax(errH, fabs(hum - raw / 65536.0 * 100 * 100));
+  }
+  report("HDC1000 temperature", errT, MAX_ERROR);
+  r = report("HDC1000 humidity", errH, MAX_ERROR);
+
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    int16_t temp;
+    uint16_t hum;
+
+    sensorHdc1000Convert(raw, raw, &temp, &hum);
+    sink += temp + hum;
+  }
+  r->tFixed = benchStamp() - t;
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    float temp, hum;
+
+    oldHdc1000Convert(raw, raw, &temp, &hum);
+    sink += temp + hum;
+  }
+  r->tFloat = benchStamp() - t;
+}
+
+/*
+ * IR temperature sensor, all raw values (14 bit two's complement)
+ */
+static void testTmp007(void)
+{
+  double err = 0;
+  result_t *r;
+  uint32_t raw;
+  uint64_t t;
+
+  for (raw = 0; raw <= 0xFFFF; raw++)
+  {
+    int16_t tObj, tTgt;
+    double exact = ((int16_t)raw >> 2) * 0.03125 * 100;
+
+    sensorTmp007Convert(raw, raw, &tObj, &tTgt);
+    err = fmax(err, fmax(fabs(tObj - exact), fabs(tTgt - exact)));
+  }
+  r = report("TMP007 temperatures", err, MAX_ERROR);
+
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    int16_t tObj, tTgt;
+
+    sensorTmp007Convert(raw, raw, &tObj, &tTgt);
+    sink += tObj + tTgt;
+  }
+  r->tFixed = benchStamp() - t;
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    float tObj, tTgt;
+
+    oldTmp007Convert(raw, raw, &tObj, &tTgt);
+    sink += tObj + tTgt;
+  }
+  r->tFloat = benchStamp() - t;
+}
+
+/*
+ * Light sensor, all raw values; the result is exact
+ */
+static void testOpt3001(void)
+{
+  double err = 0;
+  result_t *r;
+  uint32_t raw;
+  uint64_t t;
+
+  for (raw = 0; raw <= 0xFFFF; raw++)
+  {
+    double exact = (raw & 0x0FFF) * ldexp(0.01, raw >> 12) * 100;
+
+    err = fmax(err, fabs(sensorOpt3001Convert(raw) - exact));
+  }
+  r = report("OPT3001 light", err, 1e-6);
+
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    sink += sensorOpt3001Convert(raw);
+  }
+  r->tFixed = benchStamp() - t;
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    sink += oldOpt3001Convert(raw);
+  }
+  r->tFloat = benchStamp() - t;
+}
+
+/*
+ * Movement sensor, all raw values at every range
+ */
+static void testMpu9250(void)
+{
+  double errA = 0, errG = 0;
+  result_t *r;
+  uint8_t range;
+  int32_t raw;
+  uint64_t t;
+
+  for (range = ACC_RANGE_2G; range <= ACC_RANGE_16G; range++)
+  {
+    CHECK(sensorMpu9250AccSetRange(range), "accelerometer range %u", range);
+    for (raw = -32768; raw <= 32767; raw++)
+    {
+      double exact = raw * (2 << range) * 100.0 / 32768;
+
+      errA = fmax(errA, fabs(sensorMpu9250AccConvert(raw) - exact));
+    }
+  }
+  for (range = GYR_RANGE_250DPS; range <= GYR_RANGE_2000DPS; range++)
+  {
+    CHECK(sensorMpu9250GyroSetRange(range), "gyroscope range %u", range);
+    for (raw = -32768; raw <= 32767; raw++)
+    {
+      double exact = raw * (250 << range) * 100.0 / 32768;
+
+      errG = fmax(errG, fabs(sensorMpu9250GyroConvert(raw) - exact));
+    }
+  }
+  report("MPU9250 acceleration", errA, MAX_ERROR);
+  r = report("MPU9250 rotation", errG, MAX_ERROR);
+
+  sensorMpu9250AccSetRange(ACC_RANGE_4G);
+  sensorMpu9250GyroSetRange(GYR_RANGE_250DPS);
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    sink += sensorMpu9250AccConvert(raw) + sensorMpu9250GyroConvert(raw);
+  }
+  r->tFixed = benchStamp() - t;
+  t = benchStamp();
+  for (raw = 0; raw < BENCH_CALLS; raw++)
+  {
+    sink += oldMpu9250AccConvert(raw, ACC_RANGE_4G) +
+            oldMpu9250GyroConvert(raw);
+  }
+  r->tFloat = benchStamp() - t;
+}
+
+/*
+ * Short float encoding and decoding of hundredths
+ */
+static void testSfloat(void)
+{
+  uint32_t nDiff = 0;
+  double err = 0;
+  result_t *r;
+  int32_t v;
+  uint64_t t;
+
+  for (v = -0x7FFFFF; v <= 0x7FFFFF; v += 7)
+  {
+    uint16_t s = fixedToSfloat(v);
+    double exact = labs(v) / ldexp(1, s >> 12);
+
+    // Round to nearest: mantissa within half a step. The 12 bit mantissa
+    // is unsigned when decoded, so only positive values round trip.
+    if (v >= 0)
+    {
+      err = fmax(err, fabs((double)sfloatToFixed(s) - v) /
+                      ldexp(1, s >> 12));
+    }
+    if (s != oldFloatToSfloat(v / 100.0f))
+    {
+      // The float encoder rounds in single precision; only ties differ
+      nDiff++;
+      CHECK(fabs(exact - floor(exact) - 0.5) < 1e-3 ||
+            labs(v) > (1L << 24) / 100,
+            "sfloat of %d: 0x%04X, float version 0x%04X", v, s,
+            oldFloatToSfloat(v / 100.0f));
+    }
+  }
+  r = report("Short float (mantissa)", err, 0.5);
+  printf("Short float: %u of %u values encode differently from the float "
+         "version (ties and single precision rounding)\n", nDiff,
+         (2 * 0x7FFFFF) / 7 + 1);
+
+  CHECK(sfloatToFixed(0x07D0) == 2000, "sfloat 0x07D0 decodes to %u",
+        sfloatToFixed(0x07D0));
+  CHECK(sfloatToFixed(0xB123) == (0x123UL << 11), "sfloat 0xB123 decodes "
+        "to %u", sfloatToFixed(0xB123));
+
+  t = benchStamp();
+  for (v = 0; v < BENCH_CALLS; v++)
+  {
+    sink += fixedToSfloat(v * 37);
+  }
+  r->tFixed = benchStamp() - t;
+  t = benchStamp();
+  for (v = 0; v < BENCH_CALLS; v++)
+  {
+    sink += oldFloatToSfloat(v * 0.37f);
+  }
+  r->tFloat = benchStamp() - t;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  uint8_t i;
+
+  testHdc1000();
+  testTmp007();
+  testOpt3001();
+  testMpu9250();
+  testSfloat();
+
+  printf("%-22s %10s %12s %12s\n", "Converter", "max error",
+         "fixed/call", "float/call");
+  for (i = 0; i < nResults; i++)
+  {
+    result_t *r = &results[i];
+
+    printf("%-22s %10.4f", r->name, r->maxErr);
+    if (r->tFixed > 0)
+    {
+      printf(" %8llu %s %8llu %s",
+             (unsigned long long)(r->tFixed / BENCH_CALLS), BENCH_UNIT,
+             (unsigned long long)(r->tFloat / BENCH_CALLS), BENCH_UNIT);
+    }
+    printf("\n");
+  }
+  printf("Errors in hundredths of the unit (short float: in mantissa "
+         "steps).\nHost times; the host has an FPU, the CC2650 runs the "
+         "float versions in software.\n");
+
+  return benchResult("test_convert");
+}
@@ -0,0 +1,479 @@
+/*******************************************************************************
+  Filename:       test_ext_flash.c
+
+  Description:    Host test and benchmark of the external flash driver
+                  (ext_flash.c) on a simulated W25X20CL: access, protocol
+                  checks and extFlashBenchmark throughput per SPI bit rate.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -Wno-unused-parameter -O2 -ITest/stubs \
+ *       -IBoard/Devices -IBoard/Interfaces -o test_ext_flash \
+ *       Test/test_ext_flash.c Board/Devices/ext_flash.c && ./test_ext_flash
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <string.h>
+#include "Board.h"
+#include "bsp_spi.h"
+#include "ext_flash.h"
+#include <ti/sysbios/knl/Clock.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Simulated part: W25X20CL, 256 KB
+#define FLASH_SIZE                (256 * 1024UL)
+#define FLASH_PAGE                256
+#define FLASH_SECTOR              4096
+
+// Typical timing of the data sheet (ns)
+#define T_PAGE_PROGRAM            800000UL
+#define T_SECTOR_ERASE            30000000UL
+
+// Read Data (0x03) clock limit of the part (Hz)
+#define F_READ_MAX                33000000UL
+
+// Host side cost per SPI driver call and per chip select change (ns),
+// an estimate of the TI-RTOS SPI driver with DMA
+#define T_SPI_CALL                15000UL
+#define T_CS_TOGGLE               1000UL
+
+// Benchmark range and work buffer sizes
+#define BENCH_OFFSET              0x10000UL
+#define BENCH_LENGTH              (64 * 1024UL)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Flash array and state
+static uint8_t flash[FLASH_SIZE];
+static uint64_t busyUntil;
+static bool wel;
+static bool poweredDown;
+
+// Instruction in progress (chip select active)
+static bool csActive;
+static uint8_t cmd;
+static uint16_t nIn;
+static uint32_t addr;
+static uint8_t pageBuf[FLASH_PAGE];
+static bool pageUsed[FLASH_PAGE];
+static uint32_t nOut;
+
+// Simulated time (ns) and bus
+static uint64_t now;
+static uint32_t bitRate = BSP_SPI_BIT_RATE_DEFAULT;
+static bool spiOpen;
+
+// Protocol violations seen
+static uint32_t nViolations;
+
+// Tick period of the RTOS clock (us)
+uint32_t Clock_tickPeriod = 10;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Report a protocol violation by the driver
+ */
+static void violation(const char *what)
+{
+  if (nViolations++ < 5)
+  {
+    printf("Protocol violation: %s (instruction 0x%02X)\n", what, cmd);
+  }
+}
+
+/*
+ * Bus time of a transfer
+ */
+static void spiTime(size_t length)
+{
+  now += T_SPI_CALL + (uint64_t)length * 8 * 1000000000ULL / bitRate;
+}
+
+/*
+ * End of an instruction (chip select released)
+ */
+static void instructionEnd(void)
+{
+  uint16_t i;
+
+  if (nIn == 0)
+  {
+    return;
+  }
+
+  switch (cmd)
+  {
+  case 0x02:
+    if (nIn < 4)
+    {
+      violation("program without address");
+      break;
+    }
+    // Bits can only be cleared
+    for (i = 0; i < FLASH_PAGE; i++)
+    {
+      if (pageUsed[i])
+      {
+        flash[(addr & ~(FLASH_PAGE - 1UL)) + i] &= pageBuf[i];
+      }
+    }
+    busyUntil = now + T_PAGE_PROGRAM;
+    wel = false;
+    break;
+
+  case 0x20:
+    if (nIn != 4)
+    {
+      violation("sector erase length");
+      break;
+    }
+    memset(&flash[addr & ~(FLASH_SECTOR - 1UL)], 0xFF, FLASH_SECTOR);
+    busyUntil = now + T_SECTOR_ERASE;
+    wel = false;
+    break;
+
+  case 0xB9:
+    poweredDown = true;
+    break;
+
+  default:
+    break;
+  }
+}
+
+/*
+ * One byte from the master
+ */
+static void byteIn(uint8_t b)
+{
+  if (nIn == 0)
+  {
+    cmd = b;
+    addr = 0;
+    nOut = 0;
+    memset(pageUsed, 0, sizeof(pageUsed));
+
+    if (poweredDown && cmd != 0xAB)
+    {
+      // Ignored until released from power down
+      cmd = 0;
+    }
+    else if (now < busyUntil && cmd != 0x05)
+    {
+      violation("instruction while busy");
+    }
+    else if ((cmd == 0x02 || cmd == 0x20) && !wel)
+    {
+      violation("program or erase without write enable");
+    }
+    else if (cmd == 0x06)
+    {
+      wel = true;
+    }
+    else if (cmd == 0xAB)
+    {
+      poweredDown = false;
+    }
+    else if (cmd == 0x03 && bitRate > F_READ_MAX)
+    {
+      violation("Read Data above its clock limit");
+    }
+  }
+  else if (nIn <= 3)
+  {
+    addr = (addr << 8) | b;
+  }
+  else if (cmd == 0x02)
+  {
+    // Data wraps within the page
+    uint16_t i = (addr + nIn - 4) % FLASH_PAGE;
+
+    pageBuf[i] = b;
+    pageUsed[i] = true;
+  }
+  nIn++;
+}
+
+/*
+ * One byte to the master
+ */
+static uint8_t byteOut(void)
+{
+  uint8_t b = 0xFF;
+
+  switch (cmd)
+  {
+  case 0x05:
+    b = (now < busyUntil ? 0x01 : 0x00) | (wel ? 0x02 : 0x00);
+    break;
+
+  case 0x03:
+  case 0x0B:
+    if (nIn < (cmd == 0x03 ? 4 : 5))
+    {
+      violation("read without address or dummy byte");
+    }
+    b = flash[(addr + nOut) % FLASH_SIZE];
+    break;
+
+  case 0x90:
+    b = nOut == 0 ? EXT_FLASH_MAN_ID : EXT_FLASH_DEV_ID;
+    break;
+
+  default:
+    break;
+  }
+  nOut++;
+
+  return b;
+}
+
+/*********************************************************************
+ * SIMULATED INTERFACES
+ */
+
+void bspSpiOpen(void)
+{
+  spiOpen = true;
+}
+
+void bspSpiClose(void)
+{
+  spiOpen = false;
+}
+
+void bspSpiFlush(void)
+{
+}
+
+int bspSpiRead(uint8_t *buf, size_t length)
+{
+  size_t i;
+
+  if (!spiOpen || !csActive)
+  {
+    violation("read with the bus closed or the part not selected");
+    return -1;
+  }
+  for (i = 0; i < length; i++)
+  {
+    buf[i] = byteOut();
+  }
+  spiTime(length);
+
+  return 0;
+}
+
+int bspSpiWrite(const uint8_t *buf, size_t length)
+{
+  size_t i;
+
+  if (!spiOpen || !csActive)
+  {
+    violation("write with the bus closed or the part not selected");
+    return -1;
+  }
+  for (i = 0; i < length; i++)
+  {
+    byteIn(buf[i]);
+  }
+  spiTime(length);
+
+  return 0;
+}
+
+bool bspSpiSetBitRate(uint32_t rate)
+{
+  if (rate == 0 || rate > BSP_SPI_BIT_RATE_MAX)
+  {
+    return false;
+  }
+  bitRate = rate;
+  return true;
+}
+
+uint32_t bspSpiGetBitRate(void)
+{
+  return bitRate;
+}
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[])
+{
+  return state;
+}
+
+void PIN_close(PIN_Handle handle)
+{
+}
+
+int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t val)
+{
+  bool active = val == Board_FLASH_CS_ON;
+
+  if (pinId == Board_SPI_FLASH_CS && active != csActive)
+  {
+    if (active)
+    {
+      nIn = 0;
+    }
+    else
+    {
+      instructionEnd();
+    }
+    csActive = active;
+    now += T_CS_TOGGLE;
+  }
+  return 0;
+}
+
+uint32_t Clock_getTicks(void)
+{
+  return (uint32_t)(now / 1000 / Clock_tickPeriod);
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+/*
+ * Read, program across pages and erase across sectors
+ */
+static void testAccess(void)
+{
+  static uint8_t wbuf[3000], rbuf[3000];
+  uint16_t i;
+
+  memset(flash, 0x00, sizeof(flash));
+  CHECK(extFlashOpen(), "open failed");
+
+  // Unaligned range over two sectors
+  CHECK(extFlashErase(0x0F80, 0x100), "erase failed");
+  for (i = 0; i < 0x100; i++)
+  {
+    CHECK(flash[0x0F80 + i] == 0xFF, "0x%04X not erased", 0x0F80 + i);
+  }
+  CHECK(flash[0] == 0xFF && flash[0x1FFF] == 0xFF && flash[0x2000] == 0x00,
+        "erase does not cover whole sectors");
+
+  // Unaligned write over several pages, short and long reads
+  for (i = 0; i < sizeof(wbuf); i++)
+  {
+    wbuf[i] = (uint8_t)(i * 7 + 3);
+  }
+  CHECK(extFlashErase(0x1000, 0x2000), "erase failed");
+  CHECK(extFlashWrite(0x1010, sizeof(wbuf), wbuf), "write failed");
+  CHECK(extFlashRead(0x1010, sizeof(rbuf), rbuf), "read failed");
+  CHECK(memcmp(wbuf, rbuf, sizeof(rbuf)) == 0, "data differs");
+  CHECK(extFlashRead(0x1011, 5, rbuf), "short read failed");
+  CHECK(memcmp(&wbuf[1], rbuf, 5) == 0, "short read differs");
+  CHECK(flash[0x100F] == 0xFF, "write outside its range");
+
+  extFlashClose();
+  CHECK(poweredDown, "not powered down after close");
+}
+
+/*
+ * Throughput at the supported bit rates and work buffer sizes
+ */
+static void bench(void)
+{
+  static const uint32_t rates[] = { 1000000, 4000000, 8000000, 12000000 };
+  static const uint16_t bufLens[] = { 256, 4096 };
+  static uint8_t buf[4096];
+  extFlashBenchmark_t result;
+  uint8_t r;
+  uint8_t b;
+
+  printf("%10s %8s %14s %14s %14s\n", "SPI", "buffer", "read MB/s",
+         "program MB/s", "erase MB/s");
+  for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+  {
+    for (b = 0; b < sizeof(bufLens) / sizeof(bufLens[0]); b++)
+    {
+      bool ok;
+      uint32_t i;
+
+      CHECK(extFlashOpen(), "open failed");
+      bspSpiSetBitRate(rates[r]);
+      ok = extFlashBenchmark(BENCH_OFFSET, BENCH_LENGTH, buf, bufLens[b],
+                             &result);
+      extFlashClose();
+
+      CHECK(ok, "benchmark failed at %u Hz", rates[r]);
+      for (i = 0; i < BENCH_LENGTH; i++)
+      {
+        if (flash[BENCH_OFFSET + i] != (uint8_t)(i % bufLens[b]))
+        {
+          CHECK(false, "pattern wrong at 0x%05lX", BENCH_OFFSET + i);
+          break;
+        }
+      }
+      CHECK(result.readRate <= rates[r] / 8,
+            "read rate %u above the bus rate", result.readRate);
+
+      printf("%7.1f MHz %8u %14.3f %14.3f %14.3f\n", rates[r] / 1e6,
+             bufLens[b], result.readRate / 1e6, result.programRate / 1e6,
+             result.eraseRate / 1e6);
+    }
+  }
+  printf("Simulated time: SPI driver call %lu us, page program %lu us, "
+         "sector erase %lu ms\n", T_SPI_CALL / 1000, T_PAGE_PROGRAM / 1000,
+         T_SECTOR_ERASE / 1000000);
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  testAccess();
+  bench();
+
+  CHECK(nViolations == 0, "%u protocol violations", nViolations);
+
+  return benchResult("test_ext_flash");
+}
@@ -0,0 +1,390 @@
+/*******************************************************************************
+  Filename:       test_fusion.c
+
+  Description:    Host test and benchmark of the fixed point orientation filter
+                  (fusion.c) against the same filter in double precision.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -O2 -IApplication -o test_fusion \
+ *       Test/test_fusion.c Application/fusion.c -lm && ./test_fusion
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <math.h>
+#include <string.h>
+#include "fusion.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Same gain as fusion.c
+#define REF_TWO_KP                1.0
+
+// Same time step limit as fusion.c (ms)
+#define REF_MAX_DT                200
+
+// Simulated sensors: accelerometer 1 g, magnetometer field, inclination
+#define ACC_ONE_G                 4096
+#define MAG_FIELD                 3000
+#define MAG_INCLINATION           1.0   // rad
+
+// Accepted difference between fixed point and reference (degrees)
+#define MAX_ERROR_DEG             0.2
+
+// Gyroscope scale shift for +/-2000 deg/s (FUSION_GYRO_250DPS << 3)
+#define GYR_SHIFT_2000            3
+
+#define PI_VALUE                  3.14159265358979
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  double w, x, y, z;
+} quat_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Floating point reference filter state
+static quat_t ref;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Mahony filter in double precision, the algorithm of fusion.c
+ */
+static void refUpdate(const double *g, const double *a, const double *m,
+                      uint16_t dtMs)
+{
+  double q0 = ref.w, q1 = ref.x, q2 = ref.y, q3 = ref.z;
+  double gx = g[0], gy = g[1], gz = g[2];
+  double n = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+  double dt;
+
+  if (dtMs > REF_MAX_DT)
+  {
+    dtMs = REF_MAX_DT;
+  }
+  dt = dtMs / 1000.0;
+
+  if (n > 0)
+  {
+    double ax = a[0] / n, ay = a[1] / n, az = a[2] / n;
+    double vx = q1 * q3 - q0 * q2;
+    double vy = q0 * q1 + q2 * q3;
+    double vz = q0 * q0 - 0.5 + q3 * q3;
+    double ex = ay * vz - az * vy;
+    double ey = az * vx - ax * vz;
+    double ez = ax * vy - ay * vx;
+
+    if (m != NULL)
+    {
+      double mn = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+      double mx = m[0] / mn, my = m[1] / mn, mz = m[2] / mn;
+      double hx = 2 * (mx * (0.5 - q2 * q2 - q3 * q3) +
+                       my * (q1 * q2 - q0 * q3) + mz * (q1 * q3 + q0 * q2));
+      double hy = 2 * (mx * (q1 * q2 + q0 * q3) +
+                       my * (0.5 - q1 * q1 - q3 * q3) + mz * (q2 * q3 - q0 * q1));
+      double bx = sqrt(hx * hx + hy * hy);
+      double bz = 2 * (mx * (q1 * q3 - q0 * q2) + my * (q2 * q3 + q0 * q1) +
+                       mz * (0.5 - q1 * q1 - q2 * q2));
+      double wx = bx * (0.5 - q2 * q2 - q3 * q3) + bz * (q1 * q3 - q0 * q2);
+      double wy = bx * (q1 * q2 - q0 * q3) + bz * (q0 * q1 + q2 * q3);
+      double wz = bx * (q0 * q2 + q1 * q3) + bz * (0.5 - q1 * q1 - q2 * q2);
+
+      ex += my * wz - mz * wy;
+      ey += mz * wx - mx * wz;
+      ez += mx * wy - my * wx;
+    }
+
+    gx += REF_TWO_KP * ex;
+    gy += REF_TWO_KP * ey;
+    gz += REF_TWO_KP * ez;
+  }
+
+  gx *= 0.5 * dt;
+  gy *= 0.5 * dt;
+  gz *= 0.5 * dt;
+  ref.w = q0 - q1 * gx - q2 * gy - q3 * gz;
+  ref.x = q1 + q0 * gx + q2 * gz - q3 * gy;
+  ref.y = q2 + q0 * gy - q1 * gz + q3 * gx;
+  ref.z = q3 + q0 * gz + q1 * gy - q2 * gx;
+
+  n = sqrt(ref.w * ref.w + ref.x * ref.x + ref.y * ref.y + ref.z * ref.z);
+  ref.w /= n;
+  ref.x /= n;
+  ref.y /= n;
+  ref.z /= n;
+}
+
+/*
+ * Exact rotation of the true orientation by a body rate over dt
+ */
+static void truthRotate(quat_t *q, const double *w, double dt)
+{
+  double rate = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+  double c, s;
+  quat_t d, r;
+
+  if (rate == 0)
+  {
+    return;
+  }
+  c = cos(rate * dt / 2);
+  s = sin(rate * dt / 2) / rate;
+  d.w = c;
+  d.x = w[0] * s;
+  d.y = w[1] * s;
+  d.z = w[2] * s;
+
+  r.w = q->w * d.w - q->x * d.x - q->y * d.y - q->z * d.z;
+  r.x = q->w * d.x + q->x * d.w + q->y * d.z - q->z * d.y;
+  r.y = q->w * d.y - q->x * d.z + q->y * d.w + q->z * d.x;
+  r.z = q->w * d.z + q->x * d.y - q->y * d.x + q->z * d.w;
+  *q = r;
+}
+
+/*
+ * Earth frame vector in the body frame of orientation q
+ */
+static void toBody(const quat_t *q, const double *e, double *b)
+{
+  double q0 = q->w, q1 = q->x, q2 = q->y, q3 = q->z;
+
+  b[0] = (1 - 2 * (q2 * q2 + q3 * q3)) * e[0] +
+         2 * (q1 * q2 + q0 * q3) * e[1] + 2 * (q1 * q3 - q0 * q2) * e[2];
+  b[1] = 2 * (q1 * q2 - q0 * q3) * e[0] +
+         (1 - 2 * (q1 * q1 + q3 * q3)) * e[1] + 2 * (q2 * q3 + q0 * q1) * e[2];
+  b[2] = 2 * (q1 * q3 + q0 * q2) * e[0] + 2 * (q2 * q3 - q0 * q1) * e[1] +
+         (1 - 2 * (q1 * q1 + q2 * q2)) * e[2];
+}
+
+/*
+ * Angle between two orientations (degrees); the Q14 output is not
+ * exactly of unit length
+ */
+static double angleDeg(const quat_t *a, const quat_t *b)
+{
+  double na = sqrt(a->w * a->w + a->x * a->x + a->y * a->y + a->z * a->z);
+  double nb = sqrt(b->w * b->w + b->x * b->x + b->y * b->y + b->z * b->z);
+  double d = fabs(a->w * b->w + a->x * b->x + a->y * b->y + a->z * b->z) /
+             (na * nb);
+
+  return d >= 1 ? 0 : 2 * acos(d) * 180 / PI_VALUE;
+}
+
+/*
+ * Fixed point estimate as a quaternion
+ */
+static quat_t fusionQuat(void)
+{
+  int16_t q[4];
+  quat_t r;
+
+  Fusion_getQuaternion(q);
+  r.w = (double)q[0] / FUSION_QUAT_ONE;
+  r.x = (double)q[1] / FUSION_QUAT_ONE;
+  r.y = (double)q[2] / FUSION_QUAT_ONE;
+  r.z = (double)q[3] / FUSION_QUAT_ONE;
+
+  return r;
+}
+
+/*
+ * Sample in raw units; the reference gets the values after rounding
+ */
+static void sample(const quat_t *truth, const double *rate, uint8_t range,
+                   int16_t *gRaw, int16_t *aRaw, int16_t *mRaw,
+                   double *g, double *a, double *m)
+{
+  static const double gravity[3] = { 0, 0, ACC_ONE_G };
+  const double field[3] = { MAG_FIELD * cos(MAG_INCLINATION), 0,
+                            -MAG_FIELD * sin(MAG_INCLINATION) };
+  double lsb = (double)(FUSION_GYRO_250DPS << range) / (1L << 24);
+  uint8_t i;
+
+  toBody(truth, gravity, a);
+  toBody(truth, field, m);
+  for (i = 0; i < 3; i++)
+  {
+    double v = rate[i] / lsb;
+
+    gRaw[i] = (int16_t)lround(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+    aRaw[i] = (int16_t)lround(a[i]);
+    mRaw[i] = (int16_t)lround(m[i]);
+    g[i] = gRaw[i] * lsb;
+    a[i] = aRaw[i];
+    m[i] = mRaw[i];
+  }
+}
+
+/*
+ * Track a moving sensor; compare with the reference and the true
+ * orientation (after settling, with the magnetometer only: without it
+ * the heading drifts freely)
+ */
+static void testTrack(const char *name, bool useMag, uint16_t dtMs,
+                      uint8_t range, double rateScale)
+{
+  quat_t truth = { 1, 0, 0, 0 };
+  double maxErr = 0;
+  double maxTruth = 0;
+  double maxRefTruth = 0;
+  uint64_t cycles = 0;
+  uint32_t nSteps = 60000 / dtMs;
+  uint32_t i;
+
+  Fusion_init();
+  Fusion_setGyroScale(FUSION_GYRO_250DPS << range);
+  ref = truth;
+
+  for (i = 0; i < nSteps; i++)
+  {
+    double t = i * dtMs / 1000.0;
+    double rate[3] = { rateScale * 0.9 * sin(0.31 * t),
+                       rateScale * 0.7 * cos(0.23 * t),
+                       rateScale * 0.5 };
+    int16_t gRaw[3], aRaw[3], mRaw[3];
+    double g[3], a[3], m[3];
+    quat_t q;
+    uint64_t c;
+    double err;
+
+    truthRotate(&truth, rate, dtMs / 1000.0);
+    sample(&truth, rate, range, gRaw, aRaw, mRaw, g, a, m);
+
+    c = benchStamp();
+    Fusion_update(gRaw, aRaw, useMag ? mRaw : NULL, dtMs);
+    cycles += benchStamp() - c;
+    refUpdate(g, a, useMag ? m : NULL, dtMs);
+
+    q = fusionQuat();
+    err = angleDeg(&q, &ref);
+    if (err > maxErr)
+    {
+      maxErr = err;
+    }
+    if (useMag && i >= nSteps / 2)
+    {
+      err = angleDeg(&q, &truth);
+      if (err > maxTruth)
+      {
+        maxTruth = err;
+      }
+      err = angleDeg(&ref, &truth);
+      if (err > maxRefTruth)
+      {
+        maxRefTruth = err;
+      }
+    }
+  }
+
+  CHECK(maxErr <= MAX_ERROR_DEG, "%s: %.3f deg from the reference",
+        name, maxErr);
+  CHECK(maxTruth <= maxRefTruth + MAX_ERROR_DEG,
+        "%s: %.3f deg from the true orientation, reference %.3f deg",
+        name, maxTruth, maxRefTruth);
+  printf("%-26s %.4f deg from float reference; ", name, maxErr);
+  if (useMag)
+  {
+    printf("from truth %.3f deg (reference %.3f); ", maxTruth, maxRefTruth);
+  }
+  printf("%llu %s per update\n", (unsigned long long)(cycles / nSteps),
+         BENCH_UNIT);
+}
+
+/*
+ * Long time steps at full gyroscope range stay in range
+ */
+static void testLongStep(void)
+{
+  static const uint16_t steps[] = { 100, 200, 300, 1000, 65535 };
+  static const int16_t gyro[3] = { 32767, -32768, 32767 };
+  static const int16_t acc[3] = { 0, ACC_ONE_G, 0 };
+  uint8_t i;
+  uint8_t n;
+
+  for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+  {
+    double g[3], a[3] = { acc[0], acc[1], acc[2] };
+    double lsb = (double)(FUSION_GYRO_250DPS << GYR_SHIFT_2000) / (1L << 24);
+    quat_t q;
+    double err;
+
+    g[0] = gyro[0] * lsb;
+    g[1] = gyro[1] * lsb;
+    g[2] = gyro[2] * lsb;
+
+    Fusion_init();
+    Fusion_setGyroScale(FUSION_GYRO_250DPS << GYR_SHIFT_2000);
+    ref.w = 1;
+    ref.x = ref.y = ref.z = 0;
+    for (n = 0; n < 5; n++)
+    {
+      Fusion_update(gyro, acc, NULL, steps[i]);
+      refUpdate(g, a, NULL, steps[i]);
+    }
+
+    q = fusionQuat();
+    err = angleDeg(&q, &ref);
+    CHECK(err <= MAX_ERROR_DEG, "2000 deg/s, %u ms steps: %.3f deg off",
+          steps[i], err);
+  }
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  testTrack("gyro + acc, 100 Hz", false, 10, 0, 1.0);
+  testTrack("gyro + acc + mag, 100 Hz", true, 10, 0, 1.0);
+  testTrack("gyro + acc + mag, 10 Hz", true, 100, 0, 1.0);
+  testTrack("gyro + acc + mag, 2000 dps", true, 10, GYR_SHIFT_2000, 8.0);
+  testLongStep();
+
+  return benchResult("test_fusion");
+}
@@ -0,0 +1,527 @@
+/*******************************************************************************
+  Filename:       test_mpu9250_fifo.c
+
+  Description:    Host test of the MPU9250 FIFO read-out (sensor_mpu9250.c)
+                  against a simulated register map: set-up, frame order and
+                  conversion, burst sizes, overflow and error recovery, and
+                  the low pass filter chosen for the sample rate.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -Wno-unused-parameter -O2 -ITest/stubs \
+ *       -IBoard/Devices -IBoard/Interfaces -o test_mpu9250_fifo \
+ *       Test/test_mpu9250_fifo.c Board/Devices/sensor_mpu9250.c && \
+ *       ./test_mpu9250_fifo
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <string.h>
+#include "Board.h"
+#include "sensor_mpu9250.h"
+#include "sensor_opt3001.h"
+#include "sensor.h"
+#include "bsp_i2c.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// MPU9250 registers used by the FIFO read-out
+#define SMPLRT_DIV                0x19
+#define CONFIG                    0x1A
+#define ACCEL_CONFIG_2            0x1D
+#define FIFO_EN                   0x23
+#define INT_ENABLE                0x38
+#define USER_CTRL                 0x6A
+#define FIFO_COUNT_H              0x72
+#define FIFO_COUNT_L              0x73
+#define FIFO_R_W                  0x74
+
+#define BIT_FIFO_EN               0x40
+#define BIT_FIFO_RST              0x04
+#define BIT_FIFO_MODE             0x40
+#define FIFO_SELECT               0x78
+#define DLPF_MASK                 0x07
+
+// Largest burst the driver may use (8-bit length, whole frames)
+#define MAX_BURST                 255
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Simulated MPU9250: register map and FIFO
+static uint8_t regs[128];
+static uint8_t fifo[MPU_FIFO_SIZE];
+static uint16_t fifoLen;
+static uint16_t frameSeq;
+
+// Bus activity seen by the driver
+static uint16_t nReads;
+static uint16_t nFifoReads;
+static uint32_t nFifoBytes;
+static uint16_t maxBurst;
+static bool failFifoRead;
+static bool selected;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Sample values of frame 'seq', in driver order: gyro X/Y/Z, acc X/Y/Z
+ */
+static uint16_t frameValue(uint16_t seq, uint8_t axis)
+{
+  return (uint16_t)(seq * 0x0101 + axis * 0x1111 + 0x8001);
+}
+
+/*
+ * The device samples: one frame into the FIFO, accelerometer then gyro,
+ * big endian. Dropped when full (FIFO mode bit set by the driver).
+ */
+static void devicePush(uint16_t nFrames)
+{
+  static const uint8_t order[6] = { 3, 4, 5, 0, 1, 2 };
+  uint8_t i;
+
+  while (nFrames-- > 0)
+  {
+    if ((regs[USER_CTRL] & BIT_FIFO_EN) == 0 ||
+        regs[FIFO_EN] != FIFO_SELECT ||
+        ((regs[CONFIG] & BIT_FIFO_MODE) &&
+         fifoLen + MPU_FIFO_FRAME_SIZE > MPU_FIFO_SIZE))
+    {
+      continue;
+    }
+    for (i = 0; i < 6; i++)
+    {
+      uint16_t v = frameValue(frameSeq, order[i]);
+
+      fifo[fifoLen++] = v >> 8;
+      fifo[fifoLen++] = v & 0xFF;
+    }
+    frameSeq++;
+  }
+}
+
+/*
+ * Empty FIFO and counters
+ */
+static void deviceClear(void)
+{
+  fifoLen = 0;
+  frameSeq = 0;
+  nReads = 0;
+  nFifoReads = 0;
+  nFifoBytes = 0;
+  maxBurst = 0;
+  failFifoRead = false;
+}
+
+/*
+ * Check frames against the values pushed, starting at frame 'seq'
+ */
+static void checkFrames(const uint16_t *data, uint8_t n, uint16_t seq)
+{
+  uint8_t f;
+  uint8_t a;
+
+  for (f = 0; f < n; f++)
+  {
+    for (a = 0; a < 6; a++)
+    {
+      uint16_t v = data[f * 6 + a];
+
+      CHECK(v == frameValue(seq + f, a),
+            "frame %u axis %u: 0x%04X, expected 0x%04X",
+            seq + f, a, v, frameValue(seq + f, a));
+    }
+  }
+}
+
+/*********************************************************************
+ * SIMULATED INTERFACES
+ */
+
+bool bspI2cSelect(uint8_t interface, uint8_t slaveAddress)
+{
+  CHECK(!selected, "bus selected twice");
+  selected = interface == BSP_I2C_INTERFACE_1 && slaveAddress == 0x68;
+  return selected;
+}
+
+void bspI2cDeselect(void)
+{
+  selected = false;
+}
+
+bool sensorReadReg(uint8_t addr, uint8_t *pBuf, uint8_t nBytes)
+{
+  CHECK(selected, "register 0x%02X read without select", addr);
+  nReads++;
+
+  if (addr == FIFO_R_W)
+  {
+    nFifoReads++;
+    nFifoBytes += nBytes;
+    if (nBytes > maxBurst)
+    {
+      maxBurst = nBytes;
+    }
+    if (failFifoRead)
+    {
+      return false;
+    }
+    CHECK(nBytes <= fifoLen, "FIFO read of %u bytes, %u present",
+          nBytes, fifoLen);
+    memcpy(pBuf, fifo, nBytes);
+    fifoLen -= nBytes;
+    memmove(fifo, &fifo[nBytes], fifoLen);
+    return true;
+  }
+
+  if (addr == FIFO_COUNT_H)
+  {
+    regs[FIFO_COUNT_H] = fifoLen >> 8;
+    regs[FIFO_COUNT_L] = fifoLen & 0xFF;
+  }
+  memcpy(pBuf, &regs[addr], nBytes);
+
+  return true;
+}
+
+bool sensorWriteReg(uint8_t addr, uint8_t *pBuf, uint8_t nBytes)
+{
+  CHECK(selected, "register 0x%02X written without select", addr);
+  memcpy(&regs[addr], pBuf, nBytes);
+
+  if (addr == USER_CTRL && (regs[USER_CTRL] & BIT_FIFO_RST))
+  {
+    // Self clearing
+    regs[USER_CTRL] &= ~BIT_FIFO_RST;
+    fifoLen = 0;
+  }
+
+  return true;
+}
+
+void convertToLe(uint8_t *data, uint8_t len)
+{
+  uint8_t i;
+
+  for (i = 0; i < len; i += 2)
+  {
+    uint8_t tmp = data[i];
+
+    data[i] = data[i + 1];
+    data[i + 1] = tmp;
+  }
+}
+
+bool sensorOpt3001Test(void)
+{
+  return true;
+}
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[])
+{
+  (void)pinList;
+  return state;
+}
+
+int PIN_registerIntCb(PIN_Handle handle, PIN_IntCb cb)
+{
+  return 0;
+}
+
+int PIN_setInterrupt(PIN_Handle handle, PIN_Config pinCfg)
+{
+  return 0;
+}
+
+int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t val)
+{
+  return 0;
+}
+
+uint32_t PIN_getOutputValue(PIN_Id pinId)
+{
+  return pinId == Board_MPU_POWER ? Board_MPU_POWER_ON : 0;
+}
+
+void CPUdelay(uint32_t count)
+{
+}
+
+uint32_t AONRTCCurrentCompareValueGet(void)
+{
+  return 0;
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+/*
+ * Register set-up of FIFO collection
+ */
+static void testEnable(void)
+{
+  CHECK(!sensorMpu9250FifoEnable(MPU_FIFO_MIN_RATE - 1, 1), "rate too low");
+  CHECK(!sensorMpu9250FifoEnable(100, 0), "watermark 0");
+  CHECK(!sensorMpu9250FifoEnable(100, MPU_FIFO_MAX_FRAMES + 1),
+        "watermark too large");
+
+  CHECK(sensorMpu9250FifoEnable(100, 10), "enable failed");
+  CHECK(regs[SMPLRT_DIV] == 9, "SMPLRT_DIV %u", regs[SMPLRT_DIV]);
+  CHECK(regs[CONFIG] & BIT_FIFO_MODE, "FIFO mode not set");
+  CHECK(regs[FIFO_EN] == FIFO_SELECT, "FIFO_EN 0x%02X", regs[FIFO_EN]);
+  CHECK(regs[USER_CTRL] & BIT_FIFO_EN, "USER_CTRL 0x%02X", regs[USER_CTRL]);
+  CHECK(regs[INT_ENABLE] == 0x01, "INT_ENABLE 0x%02X", regs[INT_ENABLE]);
+  CHECK(!selected, "bus left selected");
+}
+
+/*
+ * Frame order and conversion, burst count, partial read-out
+ */
+static void testRead(void)
+{
+  uint16_t data[MPU_FIFO_MAX_FRAMES * 6];
+  uint8_t status;
+  uint8_t n;
+
+  // Empty FIFO: only the count is read
+  deviceClear();
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_OK && n == 0, "empty: status %u, %u frames",
+        status, n);
+  CHECK(nFifoReads == 0, "empty: %u FIFO reads", nFifoReads);
+
+  // One watermark of frames in one burst
+  deviceClear();
+  devicePush(10);
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_OK && n == 10, "10 frames: status %u, %u frames",
+        status, n);
+  CHECK(nReads == 2 && nFifoReads == 1, "10 frames: %u reads", nReads);
+  checkFrames(data, n, 0);
+
+  // Forty frames need two bursts
+  deviceClear();
+  devicePush(40);
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_OK && n == 40, "40 frames: status %u, %u frames",
+        status, n);
+  CHECK(nFifoReads == 2 && maxBurst <= MAX_BURST,
+        "40 frames: %u bursts, largest %u bytes", nFifoReads, maxBurst);
+  checkFrames(data, n, 0);
+
+  // Fewer frames requested than present; the rest stays in the FIFO
+  deviceClear();
+  devicePush(20);
+  status = sensorMpu9250FifoRead(data, 5, &n);
+  CHECK(status == MPU_FIFO_OK && n == 5, "5 of 20: status %u, %u frames",
+        status, n);
+  CHECK(fifoLen == 15 * MPU_FIFO_FRAME_SIZE, "5 of 20: %u bytes left",
+        fifoLen);
+  checkFrames(data, n, 0);
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_OK && n == 15, "15 of 20: status %u, %u frames",
+        status, n);
+  checkFrames(data, n, 5);
+  CHECK(!selected, "bus left selected");
+}
+
+/*
+ * Overflow, misalignment and bus errors flush the FIFO
+ */
+static void testErrors(void)
+{
+  uint16_t data[MPU_FIFO_MAX_FRAMES * 6];
+  uint8_t status;
+  uint8_t n;
+
+  // Full FIFO: samples have been dropped
+  deviceClear();
+  devicePush(100);
+  CHECK(fifoLen == MPU_FIFO_MAX_FRAMES * MPU_FIFO_FRAME_SIZE,
+        "full FIFO holds %u bytes", fifoLen);
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_OVERFLOW && n == MPU_FIFO_MAX_FRAMES,
+        "overflow: status %u, %u frames", status, n);
+  CHECK(fifoLen == 0, "overflow: FIFO not flushed");
+  checkFrames(data, n, 0);
+
+  // Partial frame: complete frames are returned, the FIFO restarts
+  deviceClear();
+  devicePush(8);
+  fifoLen += 6;
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_MISALIGNED && n == 8,
+        "misaligned: status %u, %u frames", status, n);
+  CHECK(fifoLen == 0, "misaligned: FIFO not flushed");
+  checkFrames(data, n, 0);
+
+  // Bus error during the burst
+  deviceClear();
+  devicePush(4);
+  failFifoRead = true;
+  status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+  CHECK(status == MPU_FIFO_READ_ERR && n == 0,
+        "bus error: status %u, %u frames", status, n);
+  CHECK(fifoLen == 0, "bus error: FIFO not flushed");
+  CHECK(!selected, "bus left selected");
+
+  // Collection stops when disabled
+  sensorMpu9250FifoDisable();
+  deviceClear();
+  devicePush(4);
+  CHECK(fifoLen == 0, "disabled: FIFO collects");
+  CHECK(sensorMpu9250FifoEnable(100, 10), "re-enable failed");
+}
+
+/*
+ * Automatic filter below half the sample rate, within the bandwidth
+ * limits; a fixed filter is used as is
+ */
+static void testFilter(void)
+{
+  uint8_t gyro;
+  uint8_t acc;
+
+  CHECK(!sensorMpu9250SetBandwidth(MPU_BW_MIN - 1, 0, MPU_DLPF_AUTO),
+        "bandwidth too low");
+  CHECK(!sensorMpu9250SetBandwidth(0, MPU_BW_MAX + 1, MPU_DLPF_AUTO),
+        "bandwidth too high");
+  CHECK(!sensorMpu9250SetBandwidth(0, 0, MPU_DLPF_5HZ + 1), "filter");
+
+  // 100 ms read-out: 10 Hz sampling, narrowest filter
+  CHECK(sensorMpu9250SetBandwidth(0, 0, MPU_DLPF_AUTO), "auto");
+  CHECK(sensorMpu9250DataRdyEnable(100), "data ready 100 ms");
+  gyro = regs[CONFIG] & DLPF_MASK;
+  acc = regs[ACCEL_CONFIG_2] & DLPF_MASK;
+  CHECK(regs[SMPLRT_DIV] == 99, "100 ms: SMPLRT_DIV %u", regs[SMPLRT_DIV]);
+  CHECK(gyro == MPU_DLPF_5HZ && acc == MPU_DLPF_5HZ,
+        "100 ms: filters %u/%u", gyro, acc);
+
+  // A wide limit does not open the filter beyond half the sample rate
+  CHECK(sensorMpu9250SetBandwidth(MPU_BW_MAX, MPU_BW_MAX, MPU_DLPF_AUTO),
+        "wide limit");
+  CHECK(sensorMpu9250DataRdyEnable(20), "data ready 20 ms");
+  gyro = regs[CONFIG] & DLPF_MASK;
+  acc = regs[ACCEL_CONFIG_2] & DLPF_MASK;
+  CHECK(gyro == MPU_DLPF_20HZ && acc == MPU_DLPF_20HZ,
+        "20 ms: filters %u/%u", gyro, acc);
+
+  // Per sensor limits at 200 Hz
+  CHECK(sensorMpu9250SetBandwidth(10, 0, MPU_DLPF_AUTO), "limit");
+  CHECK(sensorMpu9250DataRdyEnable(5), "data ready 5 ms");
+  gyro = regs[CONFIG] & DLPF_MASK;
+  acc = regs[ACCEL_CONFIG_2] & DLPF_MASK;
+  CHECK(gyro == MPU_DLPF_92HZ && acc == MPU_DLPF_10HZ,
+        "5 ms: filters %u/%u", gyro, acc);
+
+  // FIFO sample rate
+  CHECK(sensorMpu9250SetBandwidth(0, 30, MPU_DLPF_AUTO), "limit");
+  CHECK(sensorMpu9250FifoEnable(50, 10), "FIFO 50 Hz");
+  gyro = regs[CONFIG] & DLPF_MASK;
+  acc = regs[ACCEL_CONFIG_2] & DLPF_MASK;
+  CHECK(gyro == MPU_DLPF_20HZ && acc == MPU_DLPF_20HZ,
+        "FIFO 50 Hz: filters %u/%u", gyro, acc);
+
+  // Fixed filter
+  CHECK(sensorMpu9250SetBandwidth(0, 0, MPU_DLPF_184HZ), "fixed");
+  CHECK(sensorMpu9250DataRdyEnable(100), "data ready 100 ms");
+  gyro = regs[CONFIG] & DLPF_MASK;
+  acc = regs[ACCEL_CONFIG_2] & DLPF_MASK;
+  CHECK(gyro == MPU_DLPF_184HZ && acc == MPU_DLPF_184HZ,
+        "fixed: filters %u/%u", gyro, acc);
+
+  CHECK(sensorMpu9250SetBandwidth(0, 0, MPU_DLPF_AUTO), "auto");
+  CHECK(!selected, "bus left selected");
+  CHECK(sensorMpu9250FifoEnable(100, 10), "re-enable failed");
+}
+
+/*
+ * Bus transfers and time per frame for a full read-out (a completely
+ * full FIFO counts as overflow, so the largest batch is one frame less)
+ */
+static void bench(void)
+{
+  static const uint8_t watermarks[] = { 1, 10, MPU_FIFO_MAX_FRAMES - 1 };
+  uint16_t data[MPU_FIFO_MAX_FRAMES * 6];
+  uint8_t status;
+  uint8_t n;
+  uint8_t i;
+
+  for (i = 0; i < sizeof(watermarks); i++)
+  {
+    uint8_t w = watermarks[i];
+    uint64_t t;
+
+    deviceClear();
+    devicePush(w);
+    t = benchStamp();
+    status = sensorMpu9250FifoRead(data, MPU_FIFO_MAX_FRAMES, &n);
+    t = benchStamp() - t;
+
+    CHECK(status == MPU_FIFO_OK && n == w, "bench %u: status %u, %u frames",
+          w, status, n);
+    printf("%2u frames: %u I2C reads, %u bytes (%u per frame incl. count), "
+           "%llu %s on the host\n", w, nReads,
+           (unsigned)(nFifoBytes + 2),
+           (unsigned)((nFifoBytes + 2 + w / 2) / w),
+           (unsigned long long)t, BENCH_UNIT);
+  }
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  testEnable();
+  testRead();
+  testErrors();
+  testFilter();
+  bench();
+
+  return benchResult("test_mpu9250_fifo");
+}
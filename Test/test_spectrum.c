@@ -0,0 +1,259 @@
+/*******************************************************************************
+  Filename:       test_spectrum.c
+
+  Description:    Host test of the vibration spectrum (spectrum.c): tone
+                  position and amplitude for both window sizes, and the time
+                  taken by Spectrum_compute.
+
+  Copyright 2015  Texas Instruments Incorporated. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED 밃S IS�WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact Texas Instruments Incorporated at www.TI.com.
+*******************************************************************************/
+
+/*
+ * Host build and run, from the project root:
+ *
+ *   gcc -std=c99 -Wall -Wextra -O2 -IApplication -o test_spectrum \
+ *       Test/test_spectrum.c Application/spectrum.c -lm && ./test_spectrum
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bench.h"
+#include <math.h>
+#include <string.h>
+#include "spectrum.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define PI                        3.14159265358979
+
+// Test tone, on top of a 1 g offset at 8 g range
+#define TONE_AMPLITUDE            4000
+#define GRAVITY_OFFSET            4096
+
+// Accepted error of the peak amplitude and the band level (%)
+#define MAG_TOLERANCE             1
+#define RMS_TOLERANCE             3
+
+// Timed windows per size
+#define BENCH_WINDOWS             200
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*
+ * Fill a window on the X axis with up to two tones at whole bins
+ */
+static void fillWindow(uint16_t n, uint16_t bin1, int16_t amp1,
+                       uint16_t bin2, int16_t amp2)
+{
+  uint16_t i;
+
+  for (i = 0; i < n; i++)
+  {
+    double v = GRAVITY_OFFSET +
+               amp1 * sin(2 * PI * bin1 * i / n) +
+               amp2 * sin(2 * PI * bin2 * i / n);
+    int16_t acc[3];
+
+    acc[0] = (int16_t)lround(v);
+    acc[1] = 0;
+    acc[2] = GRAVITY_OFFSET;
+    Spectrum_addSample(acc);
+  }
+}
+
+/*
+ * True if the value is within pct percent of the expected value
+ */
+static int near(uint16_t value, double expected, double pct)
+{
+  return fabs(value - expected) <= expected * pct / 100;
+}
+
+/*
+ * One tone at every bin: peak position, amplitude, band level, no
+ * spurious bin 1 peak
+ */
+static void testTone(uint8_t log2n)
+{
+  uint16_t n = 1 << log2n;
+  uint16_t m = n / 2;
+  uint16_t bin;
+  uint16_t minMag = 0xFFFF;
+  uint16_t maxMag = 0;
+  SpectrumResult_t r;
+  uint8_t band;
+  uint8_t i;
+
+  for (bin = 2; bin < m; bin++)
+  {
+    Spectrum_init(log2n, SPECTRUM_AXIS_X);
+    fillWindow(n, bin, TONE_AMPLITUDE, 0, 0);
+    Spectrum_compute(&r);
+
+    CHECK(r.peakBin[0] == bin, "N=%u tone at %u: peak at %u",
+          n, bin, r.peakBin[0]);
+    CHECK(near(r.peakMag[0], TONE_AMPLITUDE, MAG_TOLERANCE),
+          "N=%u tone at %u: magnitude %u", n, bin, r.peakMag[0]);
+    // Band level where the window main lobe (three bins) lies within
+    // one band and below the Nyquist bin
+    band = (uint32_t)bin * SPECTRUM_BANDS / m;
+    if (bin + 1 < m &&
+        (uint32_t)(bin - 1) * SPECTRUM_BANDS / m == band &&
+        (uint32_t)(bin + 1) * SPECTRUM_BANDS / m == band)
+    {
+      CHECK(near(r.bandRms[band], TONE_AMPLITUDE / sqrt(2), RMS_TOLERANCE),
+            "N=%u tone at %u: band level %u", n, bin, r.bandRms[band]);
+    }
+    for (i = 0; i < SPECTRUM_PEAKS; i++)
+    {
+      CHECK(r.peakMag[i] == 0 || r.peakBin[i] != 1,
+            "N=%u tone at %u: peak at bin 1 (%u)", n, bin, r.peakMag[i]);
+    }
+
+    if (r.peakMag[0] < minMag)
+    {
+      minMag = r.peakMag[0];
+    }
+    if (r.peakMag[0] > maxMag)
+    {
+      maxMag = r.peakMag[0];
+    }
+  }
+
+  printf("N=%u: tone %d LSB at bins 2..%u, magnitude %u..%u\n",
+         n, TONE_AMPLITUDE, m - 1, minMag, maxMag);
+}
+
+/*
+ * Two tones: both found, largest first
+ */
+static void testTwoTones(uint8_t log2n)
+{
+  uint16_t n = 1 << log2n;
+  SpectrumResult_t r;
+
+  Spectrum_init(log2n, SPECTRUM_AXIS_X);
+  fillWindow(n, 20, TONE_AMPLITUDE, 60, TONE_AMPLITUDE / 4);
+  Spectrum_compute(&r);
+
+  CHECK(r.peakBin[0] == 20 && r.peakBin[1] == 60,
+        "N=%u two tones: peaks at %u, %u", n, r.peakBin[0], r.peakBin[1]);
+  CHECK(near(r.peakMag[1], TONE_AMPLITUDE / 4, 2 * MAG_TOLERANCE),
+        "N=%u two tones: second magnitude %u", n, r.peakMag[1]);
+}
+
+/*
+ * Incomplete window and the vector length input
+ */
+static void testInput(void)
+{
+  static const int16_t acc[3] = { 3000, -4000, 0 };
+  SpectrumResult_t r;
+  uint16_t i;
+
+  Spectrum_init(SPECTRUM_POINTS_256, SPECTRUM_AXIS_NORM);
+  for (i = 0; i < 255; i++)
+  {
+    CHECK(!Spectrum_addSample(acc), "window complete after %u samples", i + 1);
+  }
+  Spectrum_compute(&r);
+  CHECK(r.peakMag[0] == 0 && r.bandRms[0] == 0, "incomplete window reported");
+
+  CHECK(Spectrum_addSample(acc), "window not complete after 256 samples");
+  Spectrum_compute(&r);
+  CHECK(r.peakMag[0] == 0, "constant input: peak %u at %u",
+        r.peakMag[0], r.peakBin[0]);
+
+  Spectrum_init(SPECTRUM_OFF, SPECTRUM_AXIS_X);
+  CHECK(!Spectrum_addSample(acc), "sample accepted while off");
+}
+
+/*
+ * Time Spectrum_compute and Spectrum_addSample
+ */
+static void bench(uint8_t log2n)
+{
+  uint16_t n = 1 << log2n;
+  uint64_t best = UINT64_MAX;
+  uint64_t total = 0;
+  uint64_t fill = 0;
+  SpectrumResult_t r;
+  uint64_t t;
+  int w;
+
+  for (w = 0; w < BENCH_WINDOWS; w++)
+  {
+    Spectrum_init(log2n, SPECTRUM_AXIS_X);
+    t = benchStamp();
+    fillWindow(n, 1 + w % (n / 2 - 1), TONE_AMPLITUDE, 0, 0);
+    fill += benchStamp() - t;
+
+    t = benchStamp();
+    Spectrum_compute(&r);
+    t = benchStamp() - t;
+    total += t;
+    if (t < best)
+    {
+      best = t;
+    }
+  }
+
+  printf("N=%u: Spectrum_compute %llu %s best, %llu mean; "
+         "window fill incl. sin() %llu %s per sample\n", n,
+         (unsigned long long)best, BENCH_UNIT,
+         (unsigned long long)(total / BENCH_WINDOWS),
+         (unsigned long long)(fill / BENCH_WINDOWS / n), BENCH_UNIT);
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int main(void)
+{
+  testTone(SPECTRUM_POINTS_256);
+  testTone(SPECTRUM_POINTS_512);
+  testTwoTones(SPECTRUM_POINTS_256);
+  testTwoTones(SPECTRUM_POINTS_512);
+  testInput();
+
+  bench(SPECTRUM_POINTS_256);
+  bench(SPECTRUM_POINTS_512);
+  printf("Static RAM: %u bytes window\n",
+         (unsigned)(SPECTRUM_MAX_POINTS * sizeof(int16_t)));
+
+  return benchResult("test_spectrum");
+}